@@ -10,13 +10,38 @@
 #define DEG_TO_RAD 0.01745329251994329576923690768489f
 #define TAU 6.283185307179586476925286766559f
 
+namespace
+{
+    /// SPIR-V files of the graphics pipelines, relative to the executable.
+    const std::string SHADER_DIRECTORY = "../shaders/";
+
+    /// Writes a file requested from the UI, a failure is reported instead
+    /// of leaving the frame loop.
+    template <typename WriteFunction>
+    void saveFile(const std::string &path, WriteFunction write)
+    {
+        try
+        {
+            write(path);
+            std::cout << "Saved " << path << std::endl;
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+}
+
 Application::Application(Framework &framework)
     : m_framework{ framework }
     , m_lightLatitudes{ 0.f, 0.f, 0.f }
     , m_lightLongitudes{ 0.f, 0.f, 0.f }
+    , m_framePacer{ framework.getRenderer().getFramesInFlight() }
 {
     m_param.time = 0.f;
     m_param.exposure = 1.f;
+    m_param.patchSize = 1.f;
+    m_param.waveCount = 0;
 
     m_lightLongitudes[0] = 90.f;
     m_lightLongitudes[1] = -90.f;
@@ -33,6 +58,8 @@ Application::Application(Framework &framework)
     m_lights.lights[0].dirOrPos = { 1.f, 1.f, 1.f, 1.f };
     m_lights.lights[1].dirOrPos = { 1.f, 1.f, 1.f, 1.f };
     m_lights.lights[2].dirOrPos = { 1.f, 1.f, 1.f, 1.f };
+
+    m_oceanConstants = getOceanConstants(m_lightCount);
 }
 
 void Application::run()
@@ -52,6 +79,7 @@ void Application::run()
     // Sets and pipelines
 
     createBuffers();
+    createOcean();
     createSetLayouts();
     createPipelineLayouts();
     createPipelines();
@@ -60,17 +88,10 @@ void Application::run()
     //==========================================================================
     // Initialisation
 
-    camera.setPerspectiveProjection(
-        glm::radians(50.f), renderer.getAspectRatio(),
-        0.1f, 100.0f);
-    camera.setViewTarget(
-        glm::vec3(0.f, 1.5f, 3.f),
-        glm::vec3(0.f, 0.f, 0.f),
-        glm::vec3(0.f, 1.f, 0.f));
+    resetCamera();
 
     // Model
     SkyboxModel skyboxModel(m_framework.getVulkanBase());
-    PlaneModel oceanModel(m_framework.getVulkanBase(), 100.f, 4096);
     //==========================================================================
     // Setup ImGui
 
@@ -95,18 +116,37 @@ void Application::run()
     guiInitInfo.DescriptorPool = m_framework.getDescriptorPool();
     guiInitInfo.RenderPass = m_framework.getRenderer().getRenderPass();
     guiInitInfo.Subpass = 0;
-    guiInitInfo.MinImageCount = Renderer::MAX_FRAMES_IN_FLIGHT;
-    guiInitInfo.ImageCount = Renderer::MAX_FRAMES_IN_FLIGHT;
+    // ImGui rotates its own buffers over ImageCount frames, at least 2
+    guiInitInfo.MinImageCount = 2;
+    guiInitInfo.ImageCount = std::max(2u, renderer.getFramesInFlight());
     guiInitInfo.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
     guiInitInfo.Allocator = nullptr;
     guiInitInfo.CheckVkResultFn = nullptr;
     ImGui_ImplVulkan_Init(&guiInitInfo);
 
+    // The ImGui pipeline is created while the workers compile the others
+    finishPipelines();
+
+#ifdef VE_SHADER_HOT_RELOAD
+    m_shaderHotReload = std::make_unique<ShaderHotReload>(
+        device, m_framework.getPipelineCache(), SHADER_DIRECTORY,
+        VE_SHADER_SOURCE_DIR, VE_GLSL_VALIDATOR);
+    for (const HotPipeline &hotPipeline : m_hotPipelines)
+    {
+        m_shaderHotReload->addPipeline(hotPipeline);
+    }
+#endif
+
+    if (m_waveSweepPath.empty() == false)
+    {
+        m_quitAfterSweep = true;
+        startWaveSweep();
+    }
+
     //==========================================================================
     // Boucle de rendu
 
-    Timer *time = new Timer();
-    time->start();
+    m_timer.start();
 
     // Input manager
     m_inputManager = std::make_unique<InputManager>();
@@ -119,42 +159,82 @@ void Application::run()
     ApplicationInput *appInput = dynamic_cast<ApplicationInput *>(
         m_inputManager->getInputGroup(APP_INPUT));
 
-    glm::mat4 modelMatrix = glm::mat4(1.f);
-
     int selectedMaterialID = 0;
 
+    const vk::PresentModeKHR presentModes[] = {
+        vk::PresentModeKHR::eFifo,
+        vk::PresentModeKHR::eMailbox,
+        vk::PresentModeKHR::eImmediate,
+    };
+    for (vk::PresentModeKHR presentMode : presentModes)
+    {
+        if (renderer.isPresentModeSupported(presentMode) == false) continue;
+        if (presentMode == renderer.getPresentMode())
+        {
+            m_presentModeIndex = static_cast<int>(m_presentModes.size());
+        }
+        m_presentModes.push_back(presentMode);
+    }
+
     while (true)
     {
-        time->update();
-        float dt = time->getDelta();
+        VE_TRACE_SCOPE("Frame");
+
+        if (m_presentModes[m_presentModeIndex] != renderer.getPresentMode())
+        {
+            renderer.setPresentMode(m_presentModes[m_presentModeIndex]);
+        }
+
+        // Wait for the GPU, then sleep until just before the recording so
+        // that the input is sampled as late as possible
+        bool isFrameReady = renderer.waitForFrame(Renderer::FRAME_TIMEOUT);
+        if (isFrameReady)
+        {
+            VE_TRACE_SCOPE("Frame pacing");
+            m_framePacer.beginFrame(renderer.getFrameIndex());
+        }
+
+        m_timer.update();
+        float dt = m_timer.getDelta();
 
         // Process events
-        m_inputManager->processEvents();
+        {
+            VE_TRACE_SCOPE("Events");
+            m_inputManager->processEvents();
+        }
 
-        if (appInput->quitPressed) break;
-        if (appInput->hideGuiPressed) m_showUI = !m_showUI;
+        // Rebuilt pipelines are swapped before the recording
+        if (isFrameReady && m_shaderHotReload && m_shaderHotReload->update(renderer))
+        {
+            m_commandRecorder.invalidate();
+        }
 
-        moveCamera(dt);
+        if (isFrameReady)
+        {
+            // The fence of the slot has signalled, its counters are complete
+            if (m_oceanCulling) m_oceanCulling->readStats(renderer.getFrameIndex());
+            updateWaveSweep();
+        }
 
-        modelMatrix = glm::mat4(1.f);
+        if (appInput->quitPressed) break;
+        if (m_quitAfterSweep && m_waveSweep == nullptr) break;
+        if (appInput->hideGuiPressed) m_showUI = !m_showUI;
 
-        for (int i = 0; i < 3; i++)
         {
-            glm::vec3 lightDirection = glm::vec3(0.f, 0.f, 1.f);
-            float latitude = m_lightLatitudes[i] * DEG_TO_RAD;
-            float longitude = m_lightLongitudes[i] * DEG_TO_RAD;
-            lightDirection = glm::rotateX(lightDirection, -latitude);
-            lightDirection = glm::rotateY(lightDirection, longitude);
-            m_lights.lights[i].dirOrPos = { lightDirection.x, lightDirection.y, lightDirection.z, 1.f };
+            VE_TRACE_SCOPE("Update");
+            moveCamera(dt);
+            updateLights();
         }
 
-        m_param.time = time->getElapsed();
+        m_param.time = m_timer.getElapsed();
 
         // Check swapchain
         m_window.update();
         VkExtent2D extent = m_window.getExtent();
-        if (extent.width < 8 || extent.height < 8 || m_window.isMinimized())
+        if (isFrameReady == false ||
+            extent.width < 8 || extent.height < 8 || m_window.isMinimized())
         {
+            m_framePacer.abortFrame();
             continue;
         }
         else if (m_window.isResized())
@@ -167,147 +247,509 @@ void Application::run()
                 0.1f, 100.0f);
         }
 
-        CameraUniform ubo{};
-        ubo.view = camera.getView();
-        ubo.proj = camera.getProjection();
-        ubo.camPos = camera.getPosition();
-
         // Record command buffer
+        vk::CommandBuffer commandBuffer = renderer.beginFrame();
+        if (commandBuffer == nullptr)
+        {
+            m_framePacer.abortFrame();
+            continue;
+        }
+
+        recordScene(commandBuffer, skyboxModel);
+
+        // UI
+        {
+            VE_TRACE_SCOPE("ImGui");
+            ImGui_ImplVulkan_NewFrame();
+            ImGui_ImplSDL2_NewFrame();
+            ImGui::NewFrame();
+            updateUIFrame();
+            ImGui::Render();
+            renderer.getGpuProfiler().beginScope(commandBuffer, "ImGui");
+            ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), commandBuffer);
+            renderer.getGpuProfiler().endScope(commandBuffer);
+            m_commandRecorder.invalidate();
+        }
+
+        renderer.endRenderPass();
+        {
+            VE_TRACE_SCOPE("End frame");
+            renderer.endFrame();
+        }
+        m_framePacer.endFrame();
+    }
+    device.waitIdle();
+
+    //==========================================================================
+    // Free memory
+
+    cleanUp();
+}
+
+void Application::renderOffline(const OfflineSettings &settings)
+{
+    Renderer &renderer = m_framework.getRenderer();
+    assert(renderer.isHeadless() && "Offline rendering needs a headless framework");
+    assert(settings.frameRate > 0.f);
+
+    createBuffers();
+    createOcean();
+    createSetLayouts();
+    createPipelineLayouts();
+    createPipelines();
+    createDescriptorSets();
+    resetCamera();
+    updateLights();
+
+    SkyboxModel skyboxModel(m_framework.getVulkanBase());
+    finishPipelines();
+
+    // The frames are encoded while the next ones are rendered
+    FrameWriter frameWriter(settings.format, settings.outputPath);
+    renderer.setReadbackCallback(
+        [&frameWriter](const FrameReadback &readback) { frameWriter.write(readback); });
+
+    std::cerr << "Offline rendering: " << settings.frameCount << " frames ("
+        << renderer.getWidth() << " x " << renderer.getHeight() << ") to "
+        << settings.outputPath << std::endl;
+
+    GpuProfiler &profiler = renderer.getGpuProfiler();
+    if (settings.profilePath.empty() == false)
+    {
+        profiler.setEnabled(true);
+        profiler.startCapture();
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    // Wall time of each frame, bounded by the GPU and the frame writer
+    FrameTimeHistogram frameTimes(settings.frameCount > 0 ? settings.frameCount : 1);
+    auto frameStartTime = startTime;
+
+    for (uint32_t frame = 0; frame < settings.frameCount; )
+    {
+        // Fixed time step, independent of the rendering speed
+        m_param.time = static_cast<float>(frame) / settings.frameRate;
+
+        VE_TRACE_SCOPE("Frame");
+
         vk::CommandBuffer commandBuffer = renderer.beginFrame();
         if (commandBuffer == nullptr) continue;
 
-        uint32_t frameIndex = renderer.getFrameIndex();
+        recordScene(commandBuffer, skyboxModel);
 
-        m_cameraBuffer->writeElementToBuffer(&ubo, frameIndex);
-        m_lightsBuffer->writeElementToBuffer(&m_lights, frameIndex);
-        m_paramBuffer->writeElementToBuffer(&m_param, frameIndex);
+        renderer.endRenderPass();
+        renderer.endFrame();
+        frame++;
+
+        auto frameEndTime = std::chrono::steady_clock::now();
+        frameTimes.addSample(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(frameEndTime - frameStartTime).count()));
+        frameStartTime = frameEndTime;
+    }
+    renderer.flushReadbacks();
+    renderer.setReadbackCallback(nullptr);
+    profiler.resolveAll();
+    frameWriter.wait();
+
+    float seconds = std::chrono::duration<float>(
+        std::chrono::steady_clock::now() - startTime).count();
+    std::cerr << "Rendered " << settings.frameCount << " frames in " << seconds << " s ("
+        << settings.frameCount / seconds << " FPS)" << std::endl;
+    if (frameTimes.getSampleCount() > 0)
+    {
+        const FrameTimePercentiles &percentiles = frameTimes.getPercentiles();
+        std::cerr << "Frame times: p50 " << percentiles.p50 << " ms, p95 " << percentiles.p95
+            << " ms, p99 " << percentiles.p99 << " ms, max " << percentiles.max
+            << " ms, " << frameTimes.getHitchCount() << " hitches" << std::endl;
+    }
+
+    // Average GPU times of the last frames
+    for (const GpuScopeTiming &scope : profiler.getLastFrame().scopes)
+    {
+        std::cerr << std::string(2 * scope.depth, ' ') << scope.name << ": "
+            << scope.averageDuration << " ms" << std::endl;
+    }
+    if (settings.profilePath.empty() == false)
+    {
+        profiler.stopCapture();
+        bool isCSV = settings.profilePath.size() >= 4 &&
+            settings.profilePath.compare(settings.profilePath.size() - 4, 4, ".csv") == 0;
+        // The frames are already written, a bad path only loses the profile
+        try
+        {
+            if (isCSV) profiler.writeCSV(settings.profilePath);
+            else profiler.writeJSON(settings.profilePath);
+            std::cerr << "GPU profile written to " << settings.profilePath << std::endl;
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "GPU profile: " << e.what() << std::endl;
+        }
+    }
+
+    cleanUp();
+}
+
+void Application::resetCamera()
+{
+    camera.setPerspectiveProjection(
+        glm::radians(50.f), m_framework.getRenderer().getAspectRatio(),
+        0.1f, 100.0f);
+    camera.setViewTarget(
+        glm::vec3(0.f, 1.5f, 3.f),
+        glm::vec3(0.f, 0.f, 0.f),
+        glm::vec3(0.f, 1.f, 0.f));
+}
+
+void Application::updateLights()
+{
+    for (uint32_t i = 0; i < MAX_LIGHT_COUNT; i++)
+    {
+        glm::vec3 lightDirection = glm::vec3(0.f, 0.f, 1.f);
+        float latitude = m_lightLatitudes[i] * DEG_TO_RAD;
+        float longitude = m_lightLongitudes[i] * DEG_TO_RAD;
+        lightDirection = glm::rotateX(lightDirection, -latitude);
+        lightDirection = glm::rotateY(lightDirection, longitude);
+        m_lights.lights[i].dirOrPos = { lightDirection.x, lightDirection.y, lightDirection.z, 1.f };
+    }
+}
 
-        std::array<vk::DescriptorSet, 1> sets = {
-            m_descriptorSets.mainSets[frameIndex],
+SpecializationConstants Application::getOceanConstants(uint32_t lightCount)
+{
+    assert(lightCount <= MAX_LIGHT_COUNT);
+
+    SpecializationConstants constants;
+    constants.set(OCEAN_CONSTANT_LIGHT_COUNT, lightCount);
+    return constants;
+}
+
+void Application::recordScene(vk::CommandBuffer commandBuffer, SkyboxModel &skyboxModel)
+{
+    VE_TRACE_SCOPE("Record scene");
+
+    Renderer &renderer = m_framework.getRenderer();
+    uint32_t frameIndex = renderer.getFrameIndex();
+
+    CameraUniform ubo{};
+    ubo.view = camera.getView();
+    ubo.proj = camera.getProjection();
+    ubo.camPos = camera.getPosition();
+
+    m_param.waveCount = (m_waveModel == WAVES_GERSTNER) ? m_oceanWaves->getWaveCount() : 0;
+
+    // Dynamic offsets of the main set, in binding order
+    std::array<uint32_t, 4> dynamicOffsets{};
+    {
+        VE_TRACE_SCOPE("Uniforms");
+        m_uniformRing->beginFrame(frameIndex);
+        dynamicOffsets = {
+            m_uniformRing->push(ubo),
+            m_uniformRing->push(m_param),
+            m_uniformRing->push(m_lights),
+            m_oceanWaves->update(frameIndex),
         };
+    }
+    assert(dynamicOffsets.size() == m_setLayouts.mainDynamicOffsetCount
+        && "The dynamic offsets must match the dynamic bindings of the main set");
 
-        // Render pass
-        renderer.beginRenderPass();
+    GpuProfiler &profiler = renderer.getGpuProfiler();
 
-        // ocean model
-        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipelineLayouts.mainLayout, 0, sets, nullptr);
-        commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, m_pipelines.ocean);
+    // Ocean simulation, the Gerstner waves are evaluated by the ocean shaders
+    profiler.beginScope(commandBuffer, "Ocean simulation");
+    if (m_param.waveCount == 0)
+    {
+        m_oceanFFT->record(commandBuffer, m_param.time);
+    }
+    profiler.endScope(commandBuffer);
+
+    profiler.beginScope(commandBuffer, "Ocean preparation");
+    prepareOcean(commandBuffer, dynamicOffsets[0]);
+    profiler.endScope(commandBuffer);
+
+    // Render pass
+    renderer.beginRenderPass();
+    m_commandRecorder.begin(commandBuffer);
+
+    // ocean model
+    profiler.beginScope(commandBuffer, "Ocean");
+    m_commandRecorder.bindDescriptorSets(
+        vk::PipelineBindPoint::eGraphics, m_pipelineLayouts.mainLayout, 0,
+        m_descriptorSets.mainSet, dynamicOffsets);
+    drawOcean(m_commandRecorder);
+    profiler.endScope(commandBuffer);
+
+    // Skybox
+    profiler.beginScope(commandBuffer, "Skybox");
+    glm::mat4 skyboxModelMatrix = glm::mat4(1.f);
+    skyboxModelMatrix[3].x = camera.getPosition().x;
+    skyboxModelMatrix[3].y = camera.getPosition().y;
+    skyboxModelMatrix[3].z = camera.getPosition().z;
+    commandBuffer.pushConstants(
+        m_pipelineLayouts.mainLayout,
+        vk::ShaderStageFlagBits::eVertex |
+        vk::ShaderStageFlagBits::eFragment,
+        0, sizeof(glm::mat4), &skyboxModelMatrix);
+
+    m_commandRecorder.bindDescriptorSets(
+        vk::PipelineBindPoint::eGraphics, m_pipelineLayouts.mainLayout, 0,
+        m_descriptorSets.mainSet, dynamicOffsets);
+    m_commandRecorder.bindPipeline(vk::PipelineBindPoint::eGraphics, m_pipelines.skybox);
+    skyboxModel.bind(commandBuffer);
+    skyboxModel.draw(commandBuffer);
+    profiler.endScope(commandBuffer);
+}
 
-        commandBuffer.pushConstants(
-            m_pipelineLayouts.mainLayout,
-            vk::ShaderStageFlagBits::eVertex |
-            vk::ShaderStageFlagBits::eFragment,
-            0, sizeof(glm::mat4), &modelMatrix);
+void Application::createBuffers()
+{
+    m_uniformRing = std::make_unique<UniformRing>(
+        m_framework.getVulkanBase(), m_framework.getRenderer().getFramesInFlight());
+}
+
+void Application::createOcean()
+{
+    OceanSpectrumParams spectrumParams{};
+    m_oceanFFT = std::make_unique<OceanFFT>(m_framework, spectrumParams);
+
+    m_param.patchSize = m_oceanFFT->getPatchSize();
+
+    m_oceanWaves = std::make_unique<OceanWaves>(
+        m_framework.getVulkanBase(), m_framework.getRenderer().getFramesInFlight());
+
+    ClipmapParams clipmapParams{};
+    m_oceanClipmap = std::make_unique<OceanClipmap>(
+        m_framework.getVulkanBase(), clipmapParams);
+
+    TessellationParams tessellationParams{};
+    m_oceanTessellation = std::make_unique<OceanTessellation>(
+        m_framework.getVulkanBase(), tessellationParams);
+
+    m_oceanGrid = std::make_unique<ProceduralGridModel>(100.f, 4096);
+}
 
-        oceanModel.bind(commandBuffer);
-        oceanModel.draw(commandBuffer);
+void Application::prepareOcean(vk::CommandBuffer commandBuffer, uint32_t cameraOffset)
+{
+    VulkanBase &base = m_framework.getVulkanBase();
+
+    // Largest wave displacement, x = horizontal, y = vertical
+    glm::vec2 maxDisplacement{};
+    if (m_param.waveCount > 0)
+    {
+        maxDisplacement = m_oceanWaves->getMaxDisplacement();
+    }
+    else
+    {
+        glm::vec2 fftDisplacement = m_oceanFFT->getMaxDisplacement();
+        maxDisplacement = { m_oceanFFT->choppiness * fftDisplacement.x, fftDisplacement.y };
+    }
+
+    m_oceanClipmap->update(camera.getPosition());
+    m_oceanTessellation->update(camera.getPosition());
+    m_oceanTessellation->params.maxDisplacement = glm::max(maxDisplacement.x, maxDisplacement.y);
 
-        // Skybox
-        glm::mat4 skyboxModelMatrix = glm::mat4(1.f);
-        skyboxModelMatrix[3].x = camera.getPosition().x;
-        skyboxModelMatrix[3].y = camera.getPosition().y;
-        skyboxModelMatrix[3].z = camera.getPosition().z;
+    // The brute force grids are only built when selected
+    if (m_oceanSurface == SURFACE_TILES && m_oceanTiles == nullptr)
+    {
+        m_oceanTiles = std::make_unique<TiledGridModel>(base, 100.f, 4096);
+        m_oceanCulling = std::make_unique<OceanCulling>(
+            m_framework, *m_oceanTiles,
+            m_uniformRing->getDescriptorInfo(sizeof(CameraUniform)),
+            m_framework.getEnabledFeatures().multiDrawIndirect == vk::True);
+    }
+    if (m_oceanSurface == SURFACE_PLANE && m_oceanPlane == nullptr)
+    {
+        m_oceanPlane = std::make_unique<PlaneModel>(base, 100.f, 4096);
+    }
+
+    if (m_oceanSurface == SURFACE_TILES && m_gpuCulling)
+    {
+        // Bounds grown by the largest wave displacement
+        m_oceanCulling->margin = maxDisplacement;
+        m_oceanCulling->record(
+            commandBuffer, cameraOffset, m_framework.getRenderer().getFrameIndex());
+    }
+}
+
+void Application::drawOcean(CommandRecorder &recorder)
+{
+    vk::CommandBuffer commandBuffer = recorder.getCommandBuffer();
+
+    if (m_oceanSurface == SURFACE_CLIPMAP)
+    {
+        recorder.bindPipeline(
+            vk::PipelineBindPoint::eGraphics, m_pipelines.ocean.find(m_oceanConstants));
+        m_oceanClipmap->draw(commandBuffer, m_pipelineLayouts.mainLayout);
+        return;
+    }
+    if (m_oceanSurface == SURFACE_TESSELLATION)
+    {
+        recorder.bindPipeline(
+            vk::PipelineBindPoint::eGraphics, m_pipelines.oceanTessellation.find(m_oceanConstants));
+        m_oceanTessellation->draw(
+            commandBuffer, m_pipelineLayouts.mainLayout,
+            m_framework.getRenderer().getExtent());
+        return;
+    }
+    if (m_oceanSurface == SURFACE_GRID)
+    {
+        OceanPushConstants constants{};
+        constants.model = m_oceanGrid->getGridMatrix();
+        constants.grid = glm::vec4(0.f);
+
+        recorder.bindPipeline(
+            vk::PipelineBindPoint::eGraphics, m_pipelines.oceanGrid.find(m_oceanConstants));
         commandBuffer.pushConstants(
             m_pipelineLayouts.mainLayout,
             vk::ShaderStageFlagBits::eVertex |
             vk::ShaderStageFlagBits::eFragment,
-            0, sizeof(glm::mat4), &skyboxModelMatrix);
+            0, sizeof(OceanPushConstants), &constants);
 
-        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipelineLayouts.mainLayout, 0, sets, nullptr);
-        commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, m_pipelines.skybox);
-        skyboxModel.bind(commandBuffer);
-        skyboxModel.draw(commandBuffer);
+        m_oceanGrid->draw(commandBuffer);
+        return;
+    }
 
-        // UI
-        ImGui_ImplVulkan_NewFrame();
-        ImGui_ImplSDL2_NewFrame();
-        ImGui::NewFrame();
-        updateUIFrame();
-        ImGui::Render();
-        ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), commandBuffer);
+    recorder.bindPipeline(
+        vk::PipelineBindPoint::eGraphics, m_pipelines.ocean.find(m_oceanConstants));
 
-        renderer.endRenderPass();
-        renderer.endFrame();
+    // A null grid size disables the clipmap morphing
+    OceanPushConstants constants{};
+    constants.model = glm::mat4(1.f);
+    constants.grid = glm::vec4(0.f);
+    commandBuffer.pushConstants(
+        m_pipelineLayouts.mainLayout,
+        vk::ShaderStageFlagBits::eVertex |
+        vk::ShaderStageFlagBits::eFragment,
+        0, sizeof(OceanPushConstants), &constants);
+
+    if (m_oceanSurface == SURFACE_TILES)
+    {
+        if (m_gpuCulling)
+        {
+            m_oceanCulling->draw(commandBuffer);
+        }
+        else
+        {
+            m_oceanTiles->bind(commandBuffer);
+            m_oceanTiles->drawTiles(commandBuffer);
+        }
+        return;
     }
-    device.waitIdle();
 
-    //==========================================================================
-    // Free memory
+    m_oceanPlane->bind(commandBuffer);
+    m_oceanPlane->draw(commandBuffer);
+}
 
-    cleanUp();
+void Application::startWaveSweep()
+{
+    GpuProfiler &profiler = m_framework.getRenderer().getGpuProfiler();
+    if (profiler.isSupported() == false)
+    {
+        std::cerr << "Wave sweep: the GPU timestamps are not supported" << std::endl;
+        return;
+    }
+    profiler.setEnabled(true);
+
+    m_sweepSavedModel = m_waveModel;
+    m_sweepSavedWaves = m_oceanWaves->getWaves();
+    m_sweepResults.clear();
+    m_sweepCrossover = 0;
+    m_waveSweep = std::make_unique<WaveSweep>(4, OceanWaves::MAX_WAVE_COUNT);
 }
 
-void Application::createBuffers()
+void Application::updateWaveSweep()
 {
-    vk::Device device = m_framework.getDevice();
-    vk::PhysicalDeviceProperties physicalProperties = m_framework.getProperties();
-    vk::PhysicalDeviceMemoryProperties memoryProperties = m_framework.getMemoryProperties();
-    VkDeviceSize minUniformBufferOffsetAlignment =
-        physicalProperties.limits.minUniformBufferOffsetAlignment;
-
-    m_cameraBuffer = std::make_unique<Buffer>(
-        device,
-        memoryProperties,
-        2,
-        sizeof(CameraUniform),
-        vk::BufferUsageFlagBits::eUniformBuffer,
-        vk::MemoryPropertyFlagBits::eHostVisible |
-        vk::MemoryPropertyFlagBits::eHostCoherent,
-        minUniformBufferOffsetAlignment
-        );
-    m_cameraBuffer->map();
-
-    m_lightsBuffer = std::make_unique<Buffer>(
-        device,
-        memoryProperties,
-        2,
-        sizeof(LightsUniform),
-        vk::BufferUsageFlagBits::eUniformBuffer,
-        vk::MemoryPropertyFlagBits::eHostVisible |
-        vk::MemoryPropertyFlagBits::eHostCoherent,
-        minUniformBufferOffsetAlignment
-        );
-    m_lightsBuffer->map();
-
-    m_paramBuffer = std::make_unique<Buffer>(
-        device,
-        memoryProperties,
-        2,
-        sizeof(ParametersUniform),
-        vk::BufferUsageFlagBits::eUniformBuffer,
-        vk::MemoryPropertyFlagBits::eHostVisible |
-        vk::MemoryPropertyFlagBits::eHostCoherent,
-        minUniformBufferOffsetAlignment
-        );
-    m_paramBuffer->map();
+    if (m_waveSweep == nullptr) return;
 
+    Renderer &renderer = m_framework.getRenderer();
+    m_waveSweep->update(
+        renderer.getFrameNumber(), renderer.getGpuProfiler().getLastFrame(),
+        1000.0 * m_timer.getDelta());
+
+    if (m_waveSweep->isRunning())
+    {
+        uint32_t waveCount = m_waveSweep->getWaveCount();
+        m_waveModel = (waveCount > 0) ? WAVES_GERSTNER : WAVES_FFT;
+        if (waveCount > 0 && m_oceanWaves->getWaveCount() != waveCount)
+        {
+            m_oceanWaves->generate(waveCount);
+        }
+        return;
+    }
+
+    m_sweepResults = m_waveSweep->getResults();
+    m_sweepCrossover = m_waveSweep->getCrossover();
+    if (m_sweepCrossover > 0)
+    {
+        std::cout << "Wave sweep: the FFT is cheaper from " << m_sweepCrossover << " waves" << std::endl;
+    }
+    else
+    {
+        std::cout << "Wave sweep: the Gerstner waves stay cheaper than the FFT" << std::endl;
+    }
+
+    const std::string path = m_waveSweepPath.empty() ? "wave_sweep.csv" : m_waveSweepPath;
+    try
+    {
+        m_waveSweep->writeCSV(path);
+        std::cout << "Wave sweep written to " << path << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Wave sweep: " << e.what() << std::endl;
+    }
+
+    m_waveModel = m_sweepSavedModel;
+    m_oceanWaves->setWaves(m_sweepSavedWaves);
+    m_waveSweep.reset(nullptr);
 }
 
 void Application::createSetLayouts()
 {
     vk::Device device = m_framework.getDevice();
 
-    m_setLayouts.mainLayout =
-        DescriptorSetLayoutBuilder()
+    DescriptorSetLayoutBuilder mainLayoutBuilder;
+    mainLayoutBuilder
         // [Binding 0] Camera
         .addBinding(
-            0, vk::DescriptorType::eUniformBuffer,
+            0, vk::DescriptorType::eUniformBufferDynamic,
             vk::ShaderStageFlagBits::eVertex |
+            vk::ShaderStageFlagBits::eTessellationControl |
+            vk::ShaderStageFlagBits::eTessellationEvaluation |
             vk::ShaderStageFlagBits::eFragment
         )
         // [Binding 1] Parameters
         .addBinding(
-            1, vk::DescriptorType::eUniformBuffer,
+            1, vk::DescriptorType::eUniformBufferDynamic,
             vk::ShaderStageFlagBits::eVertex |
+            vk::ShaderStageFlagBits::eTessellationEvaluation |
             vk::ShaderStageFlagBits::eFragment
         )
         // [Binding 2] Lights
         .addBinding(
-            2, vk::DescriptorType::eUniformBuffer,
+            2, vk::DescriptorType::eUniformBufferDynamic,
             vk::ShaderStageFlagBits::eFragment
         )
-        .build(device);
+        // [Binding 3] Ocean displacement map
+        .addBinding(
+            3, vk::DescriptorType::eCombinedImageSampler,
+            vk::ShaderStageFlagBits::eVertex |
+            vk::ShaderStageFlagBits::eTessellationEvaluation
+        )
+        // [Binding 4] Ocean normal map
+        .addBinding(
+            4, vk::DescriptorType::eCombinedImageSampler,
+            vk::ShaderStageFlagBits::eFragment
+        )
+        // [Binding 5] Gerstner waves
+        .addBinding(
+            5, vk::DescriptorType::eStorageBufferDynamic,
+            vk::ShaderStageFlagBits::eVertex |
+            vk::ShaderStageFlagBits::eTessellationEvaluation |
+            vk::ShaderStageFlagBits::eFragment
+        );
 
+    m_setLayouts.mainLayout = mainLayoutBuilder.build(device);
+    m_setLayouts.mainDynamicOffsetCount = mainLayoutBuilder.getDynamicOffsetCount();
 }
 
 void Application::createPipelineLayouts()
@@ -318,10 +760,14 @@ void Application::createPipelineLayouts()
         PipelineLayoutBuilder()
         // [Set 0] Camera, Parameters, Lights
         .addDescriptorSetLayout(m_setLayouts.mainLayout)
-        // [Push constant] Model matrix
+        // [Push constant] Model matrix, clipmap grid
         .addPushConstantRange(
             vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment,
-            0, sizeof(glm::mat4))
+            0, sizeof(OceanPushConstants))
+        // [Push constant] Tessellation levels
+        .addPushConstantRange(
+            vk::ShaderStageFlagBits::eTessellationControl,
+            sizeof(OceanPushConstants), sizeof(OceanTessellationPushConstants))
         .build(device);
 }
 
@@ -329,107 +775,204 @@ void Application::createPipelines()
 {
     vk::Device device = m_framework.getDevice();
     vk::PipelineCache pipelineCache = m_framework.getPipelineCache();
+    vk::PipelineLayout mainLayout = m_pipelineLayouts.mainLayout;
+
     Renderer &renderer = m_framework.getRenderer();
     vk::RenderPass renderPass = renderer.getRenderPass();
 
-    // Ocean pipeline
+    // The pipelines are described once, to be built here and rebuilt by the
+    // shader hot reload
+    m_hotPipelines.clear();
+
+    // Ocean pipelines, one variant per light count
+    for (uint32_t lightCount = 0; lightCount <= MAX_LIGHT_COUNT; lightCount++)
     {
-        vk::PipelineShaderStageCreateInfo vertStage = tools::loadShader(
-            device, "../shaders/ocean.vert.spv",
-            vk::ShaderStageFlagBits::eVertex);
-        vk::PipelineShaderStageCreateInfo fragStage = tools::loadShader(
-            device, "../shaders/ocean.frag.spv",
-            vk::ShaderStageFlagBits::eFragment);
+        SpecializationConstants constants = getOceanConstants(lightCount);
+
+        HotPipeline hotPipeline{};
+        hotPipeline.name = "Ocean, " + std::to_string(lightCount) + " lights";
+        hotPipeline.pipeline = &m_pipelines.ocean.get(constants);
+        hotPipeline.stages = {
+            { "ocean.vert.spv", vk::ShaderStageFlagBits::eVertex },
+            { "ocean.frag.spv", vk::ShaderStageFlagBits::eFragment },
+        };
+        hotPipeline.createBuilder = [mainLayout, renderPass, constants](
+            std::vector<vk::PipelineShaderStageCreateInfo> &stages)
+        {
+            PipelineBuilder builder(mainLayout, renderPass);
+            builder
+                .addVertexBindingDescription(
+                    0, sizeof(VertexUV),
+                    vk::VertexInputRate::eVertex
+                )
+                .addVertexAttributeDescription(
+                    0, 0, vk::Format::eR32G32B32Sfloat,
+                    offsetof(VertexUV, pos)
+                )
+                .addVertexAttributeDescription(
+                    1, 0, vk::Format::eR32G32Sfloat,
+                    offsetof(VertexUV, texCoord)
+                )
+                .setSpecializationConstants(constants)
+                .addShaderStage(stages[0])
+                .addShaderStage(stages[1]);
+            return builder;
+        };
+        m_hotPipelines.push_back(hotPipeline);
+    }
 
-        m_pipelines.ocean = PipelineBuilder(
-            m_pipelineLayouts.mainLayout,
-            renderPass, pipelineCache
-        )
-            .addVertexBindingDescription(
-                0, sizeof(VertexUV),
-                vk::VertexInputRate::eVertex
-            )
-            .addVertexAttributeDescription(
-                0, 0, vk::Format::eR32G32B32Sfloat,
-                offsetof(VertexUV, pos)
-            )
-            .addVertexAttributeDescription(
-                1, 0, vk::Format::eR32G32Sfloat,
-                offsetof(VertexUV, texCoord)
-            )
-            .addShaderStage(vertStage)
-            .addShaderStage(fragStage)
-            .build(device);
-
-        device.destroyShaderModule(vertStage.module);
-        device.destroyShaderModule(fragStage.module);
+    // Ocean tessellation pipelines, one variant per light count
+    for (uint32_t lightCount = 0; lightCount <= MAX_LIGHT_COUNT; lightCount++)
+    {
+        SpecializationConstants constants = getOceanConstants(lightCount);
+
+        HotPipeline hotPipeline{};
+        hotPipeline.name = "Ocean tessellation, " + std::to_string(lightCount) + " lights";
+        hotPipeline.pipeline = &m_pipelines.oceanTessellation.get(constants);
+        hotPipeline.stages = {
+            { "ocean_tess.vert.spv", vk::ShaderStageFlagBits::eVertex },
+            { "ocean.tesc.spv", vk::ShaderStageFlagBits::eTessellationControl },
+            { "ocean.tese.spv", vk::ShaderStageFlagBits::eTessellationEvaluation },
+            { "ocean.frag.spv", vk::ShaderStageFlagBits::eFragment },
+        };
+        hotPipeline.createBuilder = [mainLayout, renderPass, constants](
+            std::vector<vk::PipelineShaderStageCreateInfo> &stages)
+        {
+            PipelineBuilder builder(mainLayout, renderPass);
+            builder
+                .addVertexBindingDescription(
+                    0, sizeof(VertexUV),
+                    vk::VertexInputRate::eVertex
+                )
+                .addVertexAttributeDescription(
+                    0, 0, vk::Format::eR32G32B32Sfloat,
+                    offsetof(VertexUV, pos)
+                )
+                .addVertexAttributeDescription(
+                    1, 0, vk::Format::eR32G32Sfloat,
+                    offsetof(VertexUV, texCoord)
+                )
+                .setSpecializationConstants(constants)
+                .addShaderStage(stages[0])
+                .addShaderStage(stages[1])
+                .addShaderStage(stages[2])
+                .addShaderStage(stages[3])
+                .setTessellationPatchControlPoints(4);
+            return builder;
+        };
+        m_hotPipelines.push_back(hotPipeline);
+    }
+
+    // Ocean procedural grid pipelines without vertex input, one variant per light count
+    for (uint32_t lightCount = 0; lightCount <= MAX_LIGHT_COUNT; lightCount++)
+    {
+        SpecializationConstants constants = getOceanConstants(lightCount);
+
+        HotPipeline hotPipeline{};
+        hotPipeline.name = "Ocean grid, " + std::to_string(lightCount) + " lights";
+        hotPipeline.pipeline = &m_pipelines.oceanGrid.get(constants);
+        hotPipeline.stages = {
+            { "ocean_grid.vert.spv", vk::ShaderStageFlagBits::eVertex },
+            { "ocean.frag.spv", vk::ShaderStageFlagBits::eFragment },
+        };
+        hotPipeline.createBuilder = [mainLayout, renderPass, constants](
+            std::vector<vk::PipelineShaderStageCreateInfo> &stages)
+        {
+            PipelineBuilder builder(mainLayout, renderPass);
+            builder
+                .setPrimitiveTopology(vk::PrimitiveTopology::eTriangleStrip)
+                .setSpecializationConstants(constants)
+                .addShaderStage(stages[0])
+                .addShaderStage(stages[1]);
+            return builder;
+        };
+        m_hotPipelines.push_back(hotPipeline);
     }
 
     // Skybox pipeline
     {
-        vk::PipelineShaderStageCreateInfo vertStage = tools::loadShader(
-            device, "../shaders/skybox.vert.spv",
-            vk::ShaderStageFlagBits::eVertex);
-        vk::PipelineShaderStageCreateInfo fragStage = tools::loadShader(
-            device, "../shaders/skybox.frag.spv",
-            vk::ShaderStageFlagBits::eFragment);
+        HotPipeline hotPipeline{};
+        hotPipeline.name = "Skybox";
+        hotPipeline.pipeline = &m_pipelines.skybox;
+        hotPipeline.stages = {
+            { "skybox.vert.spv", vk::ShaderStageFlagBits::eVertex },
+            { "skybox.frag.spv", vk::ShaderStageFlagBits::eFragment },
+        };
+        hotPipeline.createBuilder = [mainLayout, renderPass](
+            std::vector<vk::PipelineShaderStageCreateInfo> &stages)
+        {
+            PipelineBuilder builder(mainLayout, renderPass);
+            builder
+                .addVertexBindingDescription(
+                    0, sizeof(glm::vec3),
+                    vk::VertexInputRate::eVertex
+                )
+                .addVertexAttributeDescription(
+                    0, 0, vk::Format::eR32G32B32Sfloat,
+                    0
+                )
+                .addShaderStage(stages[0])
+                .addShaderStage(stages[1]);
+            return builder;
+        };
+        m_hotPipelines.push_back(hotPipeline);
+    }
 
-        m_pipelines.skybox = PipelineBuilder(
-            m_pipelineLayouts.mainLayout,
-            renderPass, pipelineCache
-        )
-            .addVertexBindingDescription(
-                0, sizeof(glm::vec3),
-                vk::VertexInputRate::eVertex
-            )
-            .addVertexAttributeDescription(
-                0, 0, vk::Format::eR32G32B32Sfloat,
-                0
-            )
-            .addShaderStage(vertStage)
-            .addShaderStage(fragStage)
-            .build(device);
-
-        device.destroyShaderModule(vertStage.module);
-        device.destroyShaderModule(fragStage.module);
+    // Compiled on the workers by finishPipelines()
+    m_pipelineQueue = std::make_unique<PipelineBuildQueue>(device, pipelineCache);
+    for (const HotPipeline &hotPipeline : m_hotPipelines)
+    {
+        hotPipeline.queue(*m_pipelineQueue, device, SHADER_DIRECTORY, hotPipeline.pipeline);
     }
+    m_pipelineQueue->start();
+}
+
+void Application::finishPipelines()
+{
+    uint32_t pipelineCount = m_pipelineQueue->getPipelineCount();
+    m_pipelineQueue->wait();
+
+    // Warm when the pipeline cache was loaded from a previous run
+    m_pipelineCreationTime = m_pipelineQueue->getBuildTime();
+    std::cerr << pipelineCount << " graphics pipelines created in " << m_pipelineCreationTime
+        << " ms on " << std::max(1u, m_pipelineQueue->getWorkerCacheCount()) << " workers ("
+        << (m_framework.getVulkanBase().getPipelineCacheStats().loaded ? "warm" : "cold")
+        << " pipeline cache)" << std::endl;
+
+    m_pipelineQueue.reset();
 }
 
 void Application::createDescriptorSets()
 {
-    assert(
-        m_cameraBuffer && m_paramBuffer && m_lightsBuffer &&
-        "The buffers must be loaded first"
-    );
+    assert(m_uniformRing && m_oceanFFT && m_oceanWaves && "The buffers must be loaded first");
 
     vk::Device device = m_framework.getDevice();
     vk::DescriptorPool descriptorPool = m_framework.getDescriptorPool();
 
-    // Main Sets
+    // Main Set
 
-    m_descriptorSets.mainSets =
+    m_descriptorSets.mainSet =
         DescriptorSetBuilder()
         .addLayout(m_setLayouts.mainLayout)
-        .addLayout(m_setLayouts.mainLayout)
-        .build(device, descriptorPool);
-
-    for (int i = 0; i < m_descriptorSets.mainSets.size(); i++)
-    {
-        vk::DescriptorBufferInfo cameraInfo = m_cameraBuffer->getDescriptorInfo();
-        vk::DescriptorBufferInfo paramInfo = m_paramBuffer->getDescriptorInfo();
-        vk::DescriptorBufferInfo lightsInfo = m_lightsBuffer->getDescriptorInfo();
-
-        cameraInfo.offset = m_cameraBuffer->getAlignmentSize() * i;
-        paramInfo.offset = m_paramBuffer->getAlignmentSize() * i;
-        lightsInfo.offset = m_lightsBuffer->getAlignmentSize() * i;
-
-        DescriptorSetUpdater()
-            .beginDescriptorSet(m_descriptorSets.mainSets[i])
-            .addBuffer(0, vk::DescriptorType::eUniformBuffer, &cameraInfo)
-            .addBuffer(1, vk::DescriptorType::eUniformBuffer, &paramInfo)
-            .addBuffer(2, vk::DescriptorType::eUniformBuffer, &lightsInfo)
-            .update(device);
-    }
+        .build(device, descriptorPool)[0];
+
+    vk::DescriptorBufferInfo cameraInfo = m_uniformRing->getDescriptorInfo(sizeof(CameraUniform));
+    vk::DescriptorBufferInfo paramInfo = m_uniformRing->getDescriptorInfo(sizeof(ParametersUniform));
+    vk::DescriptorBufferInfo lightsInfo = m_uniformRing->getDescriptorInfo(sizeof(LightsUniform));
+
+    vk::DescriptorImageInfo displacementInfo = m_oceanFFT->getDisplacementInfo();
+    vk::DescriptorImageInfo normalInfo = m_oceanFFT->getNormalInfo();
+    vk::DescriptorBufferInfo wavesInfo = m_oceanWaves->getDescriptorInfo();
+
+    DescriptorSetUpdater()
+        .beginDescriptorSet(m_descriptorSets.mainSet)
+        .addBuffer(0, vk::DescriptorType::eUniformBufferDynamic, &cameraInfo)
+        .addBuffer(1, vk::DescriptorType::eUniformBufferDynamic, &paramInfo)
+        .addBuffer(2, vk::DescriptorType::eUniformBufferDynamic, &lightsInfo)
+        .addImage(3, vk::DescriptorType::eCombinedImageSampler, &displacementInfo)
+        .addImage(4, vk::DescriptorType::eCombinedImageSampler, &normalInfo)
+        .addBuffer(5, vk::DescriptorType::eStorageBufferDynamic, &wavesInfo)
+        .update(device);
 }
 
 void Application::moveCamera(float dt)
@@ -478,14 +1021,187 @@ void Application::updateUIFrame()
     {
         ImGui::MenuItem("Param panel", NULL, &m_showPanelParam);
         ImGui::MenuItem("Lights panel", NULL, &m_showPanelLights);
+        ImGui::MenuItem("GPU profiler", NULL, &m_showPanelProfiler);
+        ImGui::MenuItem("Frame times", NULL, &m_showFrameTimes);
         ImGui::EndMenu();
     }
     ImGui::EndMainMenuBar();
 
+    if (m_showFrameTimes)
+    {
+        updateFrameTimeOverlay();
+    }
+
     if (m_showPanelParam)
     {
         ImGui::Begin("Param Panel", &m_showPanelParam, ImGuiWindowFlags_AlwaysAutoResize);
         ImGui::SliderFloat("Exposure", &m_param.exposure, 1.f, 15.f, "%.1f");
+        ImGui::SliderFloat("Choppiness", &m_oceanFFT->choppiness, 0.f, 2.f, "%.2f");
+
+        ImGui::SeparatorText("Waves");
+        ImGui::BeginDisabled(m_waveSweep != nullptr);
+        const char *waveModelNames[] = { "FFT", "Gerstner" };
+        ImGui::Combo("Model", &m_waveModel, waveModelNames, IM_ARRAYSIZE(waveModelNames));
+        if (m_waveModel == WAVES_GERSTNER)
+        {
+            int waveCount = static_cast<int>(m_oceanWaves->getWaveCount());
+            if (ImGui::SliderInt("Wave count", &waveCount, 1, OceanWaves::MAX_WAVE_COUNT))
+            {
+                m_oceanWaves->generate(static_cast<uint32_t>(waveCount));
+            }
+            glm::vec2 maxDisplacement = m_oceanWaves->getMaxDisplacement();
+            ImGui::Text("Max displacement: %.2f m", maxDisplacement.y);
+            if (ImGui::TreeNode("Edit waves"))
+            {
+                for (uint32_t i = 0; i < m_oceanWaves->getWaveCount(); i++)
+                {
+                    GerstnerWave wave = m_oceanWaves->getWaves()[i];
+                    float angle = atan2f(wave.direction.y, wave.direction.x) / DEG_TO_RAD;
+                    bool changed = false;
+
+                    ImGui::PushID(static_cast<int>(i));
+                    ImGui::Text("Wave %u", i);
+                    changed |= ImGui::SliderFloat("Angle", &angle, -180.f, 180.f, "%.0f deg");
+                    changed |= ImGui::SliderFloat("Steepness", &wave.steepness, 0.f, 1.f, "%.3f");
+                    changed |= ImGui::SliderFloat("Wavelength", &wave.wavelength, 0.1f, 64.f, "%.2f m");
+                    changed |= ImGui::SliderFloat("Phase", &wave.phase, 0.f, TAU, "%.2f");
+                    ImGui::PopID();
+
+                    if (changed)
+                    {
+                        wave.direction = glm::vec2(cosf(angle * DEG_TO_RAD), sinf(angle * DEG_TO_RAD));
+                        m_oceanWaves->setWave(i, wave);
+                    }
+                }
+                ImGui::TreePop();
+            }
+        }
+        ImGui::EndDisabled();
+
+        if (m_waveSweep)
+        {
+            if (m_waveSweep->getWaveCount() > 0) ImGui::Text("Sweep: %u waves", m_waveSweep->getWaveCount());
+            else ImGui::TextUnformatted("Sweep: FFT");
+        }
+        else if (ImGui::Button("Run sweep"))
+        {
+            startWaveSweep();
+        }
+        if (m_sweepResults.empty() == false &&
+            ImGui::BeginTable("Wave sweep", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+        {
+            ImGui::TableSetupColumn("Model");
+            ImGui::TableSetupColumn("Ocean (ms)");
+            ImGui::TableSetupColumn("Frame (ms)");
+            ImGui::TableHeadersRow();
+            for (const WaveSweep::Step &step : m_sweepResults)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                if (step.waveCount > 0) ImGui::Text("%u waves", step.waveCount);
+                else ImGui::TextUnformatted("FFT");
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", step.gpuOceanTime);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", step.gpuFrameTime);
+            }
+            ImGui::EndTable();
+            if (m_sweepCrossover > 0) ImGui::Text("FFT cheaper from %u waves", m_sweepCrossover);
+            else ImGui::TextUnformatted("Gerstner cheaper over the sweep");
+        }
+
+        ImGui::SeparatorText("Ocean surface");
+        const char *surfaceNames[] = {
+            "Clipmap", "Tessellation", "Procedural grid (4096 x 4096)",
+            "Tiles 16-bit (4096 x 4096)", "Plane (4096 x 4096)"
+        };
+        ImGui::Combo("Surface", &m_oceanSurface, surfaceNames, IM_ARRAYSIZE(surfaceNames));
+        if (m_oceanSurface == SURFACE_CLIPMAP)
+        {
+            ImGui::Text("Triangles: %u", m_oceanClipmap->getTriangleCount());
+            ImGui::Text("Extent: %.1f m", m_oceanClipmap->getExtent());
+        }
+        else if (m_oceanSurface == SURFACE_TESSELLATION)
+        {
+            TessellationParams &tessParams = m_oceanTessellation->params;
+            ImGui::SliderFloat("Edge length (px)", &tessParams.targetEdgeLength, 2.f, 64.f, "%.0f");
+            ImGui::Text("Patches: %u", m_oceanTessellation->getPatchCount());
+            ImGui::Text("Extent: %.1f m", m_oceanTessellation->getExtent());
+        }
+        else if (m_oceanSurface == SURFACE_GRID)
+        {
+            ImGui::Text("Triangles: %u", m_oceanGrid->getTriangleCount());
+            ImGui::Text("Vertex and index buffers: 0 MB");
+        }
+        else if (m_oceanSurface == SURFACE_TILES && m_oceanTiles)
+        {
+            ImGui::Checkbox("GPU culling", &m_gpuCulling);
+            if (m_gpuCulling)
+            {
+                ImGui::Text("Visible tiles: %u / %u",
+                    m_oceanCulling->getVisibleTileCount(), m_oceanCulling->getTileCount());
+            }
+            ImGui::Text("Tiles: %zu", m_oceanTiles->getTiles().size());
+            ImGui::Text("Vertices per tile: %u", m_oceanTiles->getTileVertexCount());
+            ImGui::Text("Shared index buffer: %.1f kB",
+                m_oceanTiles->getTileIndexCount() * sizeof(uint16_t) / 1024.f);
+        }
+
+        ImGui::SeparatorText("GPU memory");
+        MemoryStats memoryStats = m_framework.getVulkanBase().getMemoryAllocator().getStats();
+        ImGui::Text("Used: %.1f MB", memoryStats.usedBytes / (1024.f * 1024.f));
+        ImGui::Text("Reserved: %.1f MB", memoryStats.reservedBytes / (1024.f * 1024.f));
+        ImGui::Text("Fragmented: %.1f MB", memoryStats.fragmentedBytes / (1024.f * 1024.f));
+        ImGui::Text("Allocations: %u in %u blocks + %u dedicated",
+            memoryStats.allocationCount, memoryStats.blockCount, memoryStats.dedicatedCount);
+
+        ImGui::SeparatorText("Commands");
+        ImGui::Text("Binds: %u recorded, %u redundant skipped",
+            m_commandRecorder.getRecordedCount(), m_commandRecorder.getSkippedCount());
+        const PipelineCacheStats &cacheStats = m_framework.getVulkanBase().getPipelineCacheStats();
+        ImGui::Text("Pipelines: %.1f ms (%s start)",
+            m_pipelineCreationTime, cacheStats.loaded ? "warm" : "cold");
+        if (m_shaderHotReload)
+        {
+            ImGui::Text("Shader reloads: %u%s", m_shaderHotReload->getReloadCount(),
+                m_shaderHotReload->isBusy() ? " (compiling)" : "");
+            if (m_shaderHotReload->getStatus().empty() == false)
+            {
+                ImGui::TextWrapped("%s", m_shaderHotReload->getStatus().c_str());
+            }
+        }
+        ImGui::Text("Frames in flight: %u, swapchain images: %u",
+            m_framework.getRenderer().getFramesInFlight(),
+            m_framework.getRenderer().getImageCount());
+
+        ImGui::SeparatorText("Frame pacing");
+        std::vector<std::string> presentModeNames;
+        std::vector<const char *> presentModeItems;
+        for (vk::PresentModeKHR presentMode : m_presentModes)
+        {
+            presentModeNames.push_back(vk::to_string(presentMode));
+        }
+        for (const std::string &name : presentModeNames)
+        {
+            presentModeItems.push_back(name.c_str());
+        }
+        ImGui::Combo(
+            "Present mode", &m_presentModeIndex,
+            presentModeItems.data(), static_cast<int>(presentModeItems.size()));
+
+        float targetFrameRate = m_framePacer.getTargetFrameRate();
+        if (ImGui::SliderFloat("Target FPS", &targetFrameRate, 0.f, 240.f, targetFrameRate > 0.f ? "%.0f" : "Unlimited"))
+        {
+            m_framePacer.setTargetFrameRate(targetFrameRate);
+        }
+        const FramePacingStats &pacingStats = m_framePacer.getStats();
+        ImGui::Text("Frame: %.2f ms (%.0f FPS)",
+            1000.f * pacingStats.frameTime,
+            pacingStats.frameTime > 0.f ? 1.f / pacingStats.frameTime : 0.f);
+        ImGui::Text("CPU: %.2f ms, sleep: %.2f ms",
+            1000.f * pacingStats.cpuTime, 1000.f * pacingStats.sleepTime);
+        ImGui::Text("Input to GPU latency: %.2f ms", 1000.f * pacingStats.latency);
+        ImGui::Text("Missed deadlines: %u", pacingStats.missedCount);
         ImGui::End();
     }
 
@@ -498,45 +1214,191 @@ void Application::updateUIFrame()
 
         ImGui::SeparatorText("Directionnal lights");
 
-        if (ImGui::CollapsingHeader("Light 0"))
+        // Each count selects a pipeline variant built at startup
+        int lightCount = static_cast<int>(m_lightCount);
+        if (ImGui::SliderInt("Light count", &lightCount, 0, static_cast<int>(MAX_LIGHT_COUNT)))
         {
-            ImGui::ColorEdit3("Color 0", (float *)&(m_lights.lights[0].color));
-            ImGui::SliderFloat("Intensity 0", &(m_lights.lights[0].color[3]), 0.f, 5.f, "%.1f");
-            ImGui::SliderFloat("Longitude 0", &(m_lightLongitudes[0]), -180.f, 180.f);
-            ImGui::SliderFloat("Latitude 0", &(m_lightLatitudes[0]), -90.f, 90.f);
+            m_lightCount = static_cast<uint32_t>(lightCount);
+            m_oceanConstants = getOceanConstants(m_lightCount);
         }
-        if (ImGui::CollapsingHeader("Light 1"))
+
+        for (uint32_t i = 0; i < m_lightCount; i++)
+        {
+            std::string header = "Light " + std::to_string(i);
+            if (ImGui::CollapsingHeader(header.c_str()) == false) continue;
+
+            ImGui::PushID(static_cast<int>(i));
+            ImGui::ColorEdit3("Color", (float *)&(m_lights.lights[i].color));
+            ImGui::SliderFloat("Intensity", &(m_lights.lights[i].color[3]), 0.f, 5.f, "%.1f");
+            ImGui::SliderFloat("Longitude", &(m_lightLongitudes[i]), -180.f, 180.f);
+            ImGui::SliderFloat("Latitude", &(m_lightLatitudes[i]), -90.f, 90.f);
+            ImGui::PopID();
+        }
+
+        ImGui::End();
+    }
+
+    if (m_showPanelProfiler)
+    {
+        ImGui::Begin("GPU Profiler", &m_showPanelProfiler, ImGuiWindowFlags_AlwaysAutoResize);
+
+        GpuProfiler &profiler = m_framework.getRenderer().getGpuProfiler();
+        if (profiler.isSupported() == false)
         {
-            ImGui::ColorEdit3("Color 1", (float *)&(m_lights.lights[1].color));
-            ImGui::SliderFloat("Intensity 1", &(m_lights.lights[1].color[3]), 0.f, 5.f, "%.1f");
-            ImGui::SliderFloat("Longitude 1", &(m_lightLongitudes[1]), -180.f, 180.f);
-            ImGui::SliderFloat("Latitude 1", &(m_lightLatitudes[1]), -90.f, 90.f);
+            ImGui::Text("No timestamp queries on the graphics queue");
         }
-        if (ImGui::CollapsingHeader("Light 2"))
+        else
         {
-            ImGui::ColorEdit3("Color 2", (float *)&(m_lights.lights[2].color));
-            ImGui::SliderFloat("Intensity 2", &(m_lights.lights[2].color[3]), 0.f, 5.f, "%.1f");
-            ImGui::SliderFloat("Longitude 2", &(m_lightLongitudes[2]), -180.f, 180.f);
-            ImGui::SliderFloat("Latitude 2", &(m_lightLatitudes[2]), -90.f, 90.f);
+            bool enabled = profiler.isEnabled();
+            if (ImGui::Checkbox("Enabled", &enabled))
+            {
+                profiler.setEnabled(enabled);
+            }
+
+            const GpuFrameTimings &frame = profiler.getLastFrame();
+            ImGui::Text("Frame %llu: %.3f ms",
+                static_cast<unsigned long long>(frame.frameNumber), frame.duration);
+
+            if (ImGui::BeginTable("Scopes", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+            {
+                ImGui::TableSetupColumn("Scope");
+                ImGui::TableSetupColumn("Last (ms)");
+                ImGui::TableSetupColumn("Average (ms)");
+                ImGui::TableHeadersRow();
+                for (const GpuScopeTiming &scope : frame.scopes)
+                {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%*s%s", static_cast<int>(2 * scope.depth), "", scope.name.c_str());
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", scope.duration);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", scope.averageDuration);
+                }
+                ImGui::EndTable();
+            }
+
+            ImGui::SeparatorText("Trace");
+            if (profiler.isCapturing())
+            {
+                if (ImGui::Button("Stop capture")) profiler.stopCapture();
+            }
+            else if (ImGui::Button("Start capture"))
+            {
+                profiler.startCapture();
+            }
+            ImGui::SameLine();
+            ImGui::Text("%zu frames", profiler.getCapturedFrameCount());
+
+            if (ImGui::Button("Save CSV"))
+            {
+                saveFile("gpu_profile.csv", [&profiler](const std::string &path) { profiler.writeCSV(path); });
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Save JSON"))
+            {
+                saveFile("gpu_profile.json", [&profiler](const std::string &path) { profiler.writeJSON(path); });
+            }
         }
 
+#ifdef VE_ENABLE_TRACE
+        ImGui::SeparatorText("CPU trace");
+        CpuTracer &tracer = CpuTracer::getShared();
+        bool tracing = tracer.isEnabled();
+        if (ImGui::Checkbox("Record zones", &tracing))
+        {
+            tracer.setEnabled(tracing);
+        }
+        if (ImGui::Button("Clear")) tracer.clear();
+        ImGui::SameLine();
+        if (ImGui::Button("Save trace"))
+        {
+            saveFile("cpu_trace.json", [&tracer](const std::string &path) { tracer.writeJSON(path); });
+        }
+#endif
         ImGui::End();
     }
 }
 
+void Application::updateFrameTimeOverlay()
+{
+    FrameTimeHistogram &histogram = m_timer.getHistogram();
+    if (histogram.getSampleCount() == 0) return;
+
+    // Top right corner, below the menu bar
+    const ImGuiViewport *viewport = ImGui::GetMainViewport();
+    ImVec2 position = viewport->WorkPos;
+    position.x += viewport->WorkSize.x - 10.f;
+    position.y += 10.f;
+    ImGui::SetNextWindowPos(position, ImGuiCond_Always, ImVec2(1.f, 0.f));
+    ImGui::SetNextWindowBgAlpha(0.5f);
+
+    ImGuiWindowFlags flags =
+        ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize |
+        ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing |
+        ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoMove;
+    ImGui::Begin("Frame times", nullptr, flags);
+
+    const FrameTimePercentiles &percentiles = histogram.getPercentiles();
+    ImGui::Text("Frame: %.3f ms", histogram.getLastSample());
+    ImGui::Text("p50 %.3f  p95 %.3f  p99 %.3f  max %.3f ms",
+        percentiles.p50, percentiles.p95, percentiles.p99, percentiles.max);
+
+    const std::vector<float> &samples = histogram.getSamples();
+    float plotMax = std::max(2.f * percentiles.p99, 1.f);
+    ImGui::PlotLines(
+        "##FrameTimes", samples.data(), static_cast<int>(samples.size()),
+        static_cast<int>(histogram.getOffset()), nullptr, 0.f, plotMax, ImVec2(300.f, 50.f));
+
+    std::vector<float> buckets = histogram.getBuckets(50, plotMax);
+    ImGui::PlotHistogram(
+        "##Histogram", buckets.data(), static_cast<int>(buckets.size()),
+        0, nullptr, 0.f, FLT_MAX, ImVec2(300.f, 50.f));
+    ImGui::Text("Histogram: 0 to %.1f ms", plotMax);
+
+    ImGui::Text("Hitches (> %.1fx median): %u", histogram.getHitchFactor(), histogram.getHitchCount());
+    if (histogram.getHitchCount() > 0)
+    {
+        ImGui::Text("Last: %.2f ms, %llu frames ago", histogram.getLastHitchTime(),
+            static_cast<unsigned long long>(histogram.getFrameCount() - histogram.getLastHitchFrame() - 1));
+    }
+    if (ImGui::Button("Reset"))
+    {
+        histogram.clear();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Save CSV"))
+    {
+        saveFile("frame_times.csv", [&histogram](const std::string &path) { histogram.writeCSV(path); });
+    }
+    ImGui::End();
+}
+
 void Application::cleanUp()
 {
     vk::Device device = m_framework.getDevice();
     vk::DescriptorPool descriptorPool = m_framework.getDescriptorPool();
 
-    ImGui_ImplVulkan_Shutdown();
+    if (m_framework.isHeadless() == false)
+    {
+        ImGui_ImplVulkan_Shutdown();
+    }
 
+    m_shaderHotReload.reset(nullptr);
     m_descriptorSets.destroy(device, descriptorPool);
     m_pipelines.destroy(device);
     m_pipelineLayouts.destroy(device);
     m_setLayouts.destroy(device);
 
-    m_cameraBuffer.reset(nullptr);
-    m_lightsBuffer.reset(nullptr);
-    m_paramBuffer.reset(nullptr);
+    m_uniformRing.reset(nullptr);
+
+    m_oceanFFT.reset(nullptr);
+    m_oceanWaves.reset(nullptr);
+    m_waveSweep.reset(nullptr);
+    m_oceanClipmap.reset(nullptr);
+    m_oceanTessellation.reset(nullptr);
+    m_oceanGrid.reset(nullptr);
+    m_oceanCulling.reset(nullptr);
+    m_oceanTiles.reset(nullptr);
+    m_oceanPlane.reset(nullptr);
 }
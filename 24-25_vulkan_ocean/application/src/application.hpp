@@ -6,6 +6,26 @@
 #include "input/mouse_input.hpp"
 #include "input/imgui_input.hpp"
 #include "camera.hpp"
+#include "ocean_fft.hpp"
+#include "ocean_waves.hpp"
+#include "wave_sweep.hpp"
+#include "ocean_clipmap.hpp"
+#include "ocean_tessellation.hpp"
+#include "ocean_culling.hpp"
+#include "frame_writer.hpp"
+#include "shader_hot_reload.hpp"
+
+class SkyboxModel;
+
+/// Size of the light array of LightsUniform, the same in ocean.frag.
+constexpr uint32_t MAX_LIGHT_COUNT = 3;
+
+/// IDs of the specialization constants of the ocean shaders.
+enum OceanConstantID : uint32_t
+{
+    /// Lights shaded by ocean.frag, from 0 to MAX_LIGHT_COUNT.
+    OCEAN_CONSTANT_LIGHT_COUNT = 0,
+};
 
 struct Light
 {
@@ -15,7 +35,7 @@ struct Light
 
 struct LightsUniform
 {
-    Light lights[3];
+    Light lights[MAX_LIGHT_COUNT];
     alignas(16) glm::vec4 ambiantColor; // rgb = color, a = intensity
 };
 
@@ -30,12 +50,28 @@ struct ParametersUniform
 {
     float time;
     float exposure;
+    float patchSize;
+    /// 0 = FFT displacement, else number of Gerstner waves.
+    uint32_t waveCount;
+};
+
+struct OfflineSettings
+{
+    uint32_t frameCount = 300;
+    /// Frame rate of the footage, gives the simulation time step.
+    float frameRate = 30.f;
+    FrameFileFormat format = FrameFileFormat::ePNG;
+    std::string outputPath = "ocean_%05d.png";
+    /// GPU timings of every frame, CSV if the path ends with .csv, JSON
+    /// trace otherwise. Empty to disable.
+    std::string profilePath;
 };
 
 struct SetLayouts
 {
     SetLayouts()
         : mainLayout{ VK_NULL_HANDLE }
+        , mainDynamicOffsetCount{ 0 }
     {}
     void destroy(vk::Device &device)
     {
@@ -44,6 +80,8 @@ struct SetLayouts
     }
 
     vk::DescriptorSetLayout mainLayout;
+    /// Dynamic offsets expected when binding the main set.
+    uint32_t mainDynamicOffsetCount;
 };
 
 struct PipelineLayouts
@@ -63,33 +101,37 @@ struct PipelineLayouts
 struct Pipelines
 {
     Pipelines()
-        : ocean{ VK_NULL_HANDLE }
-        , skybox{ VK_NULL_HANDLE }
+        : skybox{ VK_NULL_HANDLE }
     {}
     void destroy(vk::Device &device)
     {
-        device.destroyPipeline(ocean);
+        ocean.destroy(device);
+        oceanTessellation.destroy(device);
+        oceanGrid.destroy(device);
         device.destroyPipeline(skybox);
-        ocean = VK_NULL_HANDLE;
         skybox = VK_NULL_HANDLE;
     }
 
-    vk::Pipeline ocean;
+    // One variant per light count, keyed by Application::getOceanConstants()
+    PipelineVariantCache ocean;
+    PipelineVariantCache oceanTessellation;
+    PipelineVariantCache oceanGrid;
     vk::Pipeline skybox;
 };
 
 struct DescriptorSets
 {
     DescriptorSets()
-        : mainSets{}
+        : mainSet{ VK_NULL_HANDLE }
     {}
     void destroy(vk::Device &device, vk::DescriptorPool &descriptorPool)
     {
-        device.freeDescriptorSets(descriptorPool, mainSets);
-        mainSets.clear();
+        device.freeDescriptorSets(descriptorPool, mainSet);
+        mainSet = VK_NULL_HANDLE;
     }
 
-    std::vector<vk::DescriptorSet> mainSets;
+    /// Shared by all frames, the uniforms are bound with dynamic offsets.
+    vk::DescriptorSet mainSet;
 };
 
 class Application
@@ -99,6 +141,17 @@ public:
 
     void run();
 
+    /// @brief Renders a fixed number of frames with a headless framework and
+    /// writes them to disk, as fast as the GPU and the disk allow.
+    void renderOffline(const OfflineSettings &settings);
+
+    /// @brief Target frame rate of the frame pacer, 0 disables the pacing.
+    void setTargetFrameRate(float frameRate) { m_framePacer.setTargetFrameRate(frameRate); }
+
+    /// @brief Runs the wave sweep at launch, writes its results to the CSV
+    /// file and quits when it is done.
+    void setWaveSweepPath(const std::string &path) { m_waveSweepPath = path; }
+
 private:
     Framework &m_framework;
 
@@ -111,29 +164,106 @@ private:
     Camera camera;
 
     void createBuffers();
+    void createOcean();
     void createSetLayouts();
     void createPipelineLayouts();
+    /// @brief Loads the shaders and starts the compilation of the graphics
+    /// pipelines on the thread pool.
     void createPipelines();
+    /// @brief Waits for the pipelines started by createPipelines().
+    void finishPipelines();
     void createDescriptorSets();
 
+    void resetCamera();
+    void updateLights();
+    /// @brief Specialization constants of the ocean pipeline variants.
+    static SpecializationConstants getOceanConstants(uint32_t lightCount);
+
+    /// @brief Records the simulation and the scene, leaves the render pass
+    /// open for the UI.
+    void recordScene(vk::CommandBuffer commandBuffer, SkyboxModel &skyboxModel);
+    void prepareOcean(vk::CommandBuffer commandBuffer, uint32_t cameraOffset);
+    void drawOcean(CommandRecorder &recorder);
+    /// @brief Selects the wave model and count of the sweep step, writes the
+    /// results when the sweep ends.
+    void updateWaveSweep();
+    void startWaveSweep();
     void moveCamera(float dt);
     void updateUIFrame();
+    void updateFrameTimeOverlay();
     void cleanUp();
 
     bool m_showUI = true;
     bool m_showPanelLights = false;
     bool m_showPanelParam = false;
+    bool m_showPanelProfiler = false;
+    bool m_showFrameTimes = false;
 
-    // Buffers
-    std::unique_ptr<Buffer> m_cameraBuffer;
-    std::unique_ptr<Buffer> m_lightsBuffer;
-    std::unique_ptr<Buffer> m_paramBuffer;
+    Timer m_timer;
+
+    // Per frame camera, parameters and lights
+    std::unique_ptr<UniformRing> m_uniformRing;
+
+    // Compiles the graphics pipelines between createPipelines() and finishPipelines()
+    std::unique_ptr<PipelineBuildQueue> m_pipelineQueue;
+    // Shaders and builders of the graphics pipelines
+    std::vector<HotPipeline> m_hotPipelines;
+    // Rebuilds the pipelines when their shaders change, interactive mode only
+    std::unique_ptr<ShaderHotReload> m_shaderHotReload;
+    // Compilation time of the graphics pipelines, depends on the pipeline cache
+    float m_pipelineCreationTime = 0.f;
+
+    // Skips the redundant binds of the main render pass
+    CommandRecorder m_commandRecorder;
+
+    // Frame pacing, the present modes are the ones supported by the surface
+    FramePacer m_framePacer;
+    std::vector<vk::PresentModeKHR> m_presentModes;
+    int m_presentModeIndex = 0;
+
+    // Ocean simulation
+    std::unique_ptr<OceanFFT> m_oceanFFT;
+    std::unique_ptr<OceanWaves> m_oceanWaves;
+    enum WaveModel : int
+    {
+        WAVES_FFT, WAVES_GERSTNER
+    };
+    int m_waveModel = WAVES_FFT;
+
+    // Gerstner waves against the FFT, the model and the waves are restored
+    // when the sweep ends
+    std::unique_ptr<WaveSweep> m_waveSweep;
+    std::string m_waveSweepPath;
+    bool m_quitAfterSweep = false;
+    int m_sweepSavedModel = WAVES_FFT;
+    std::vector<GerstnerWave> m_sweepSavedWaves;
+    std::vector<WaveSweep::Step> m_sweepResults;
+    uint32_t m_sweepCrossover = 0;
+
+    // Ocean surface
+    enum OceanSurface : int
+    {
+        SURFACE_CLIPMAP, SURFACE_TESSELLATION, SURFACE_GRID, SURFACE_TILES, SURFACE_PLANE
+    };
+    int m_oceanSurface = SURFACE_CLIPMAP;
+    std::unique_ptr<OceanClipmap> m_oceanClipmap;
+    std::unique_ptr<OceanTessellation> m_oceanTessellation;
+    // Same grid as the plane, without vertex or index buffer
+    std::unique_ptr<ProceduralGridModel> m_oceanGrid;
+    // Brute force reference grids, created when first selected
+    std::unique_ptr<TiledGridModel> m_oceanTiles;
+    std::unique_ptr<OceanCulling> m_oceanCulling;
+    bool m_gpuCulling = true;
+    std::unique_ptr<PlaneModel> m_oceanPlane;
 
     // Uniforms
     ParametersUniform m_param;
     LightsUniform m_lights;
-    std::array<float, 3> m_lightLongitudes;
-    std::array<float, 3> m_lightLatitudes;
+    std::array<float, MAX_LIGHT_COUNT> m_lightLongitudes;
+    std::array<float, MAX_LIGHT_COUNT> m_lightLatitudes;
+    // Selects the ocean pipeline variants, the other lights are not shaded
+    uint32_t m_lightCount = MAX_LIGHT_COUNT;
+    SpecializationConstants m_oceanConstants;
 
     // Vulkan sets and pipelines
     SetLayouts m_setLayouts;
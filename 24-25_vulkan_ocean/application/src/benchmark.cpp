@@ -0,0 +1,93 @@
+#include "benchmark.hpp"
+#include "model.hpp"
+
+#include <chrono>
+
+#ifdef _WIN32
+#  define NOMINMAX
+#  include <windows.h>
+#  include <psapi.h>
+#  ifdef _MSC_VER
+#    pragma comment(lib, "psapi.lib")
+#  endif
+#else
+#  include <sys/resource.h>
+#  include <unistd.h>
+#endif
+
+namespace
+{
+    double toMegabytes(size_t bytes)
+    {
+        return static_cast<double>(bytes) / (1024.0 * 1024.0);
+    }
+}
+
+size_t benchmark::getPeakMemory()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PeakWorkingSetSize;
+    return 0;
+#else
+    struct rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#  if defined(__APPLE__)
+    return static_cast<size_t>(usage.ru_maxrss);
+#  else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#  endif
+#endif
+}
+
+size_t benchmark::getCurrentMemory()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.WorkingSetSize;
+    return 0;
+#elif defined(__linux__)
+    size_t pageCount = 0, residentCount = 0;
+    FILE *file = fopen("/proc/self/statm", "r");
+    if (file == nullptr) return 0;
+    if (fscanf(file, "%zu %zu", &pageCount, &residentCount) != 2) residentCount = 0;
+    fclose(file);
+    return residentCount * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+    return 0;
+#endif
+}
+
+void benchmark::planeModel(VulkanBase &base, int divisionCount, bool parallel)
+{
+    using Clock = std::chrono::steady_clock;
+
+    const size_t memoryBefore = getCurrentMemory();
+    const size_t peakBefore = getPeakMemory();
+
+    Clock::time_point start = Clock::now();
+    {
+        PlaneModel plane(base, 100.f, divisionCount, parallel);
+    }
+    Clock::time_point end = Clock::now();
+
+    const double milliseconds =
+        std::chrono::duration<double, std::milli>(end - start).count();
+    const size_t peakAfter = getPeakMemory();
+
+    const uint64_t vertexCount = static_cast<uint64_t>(divisionCount + 1) * (divisionCount + 1);
+    const uint64_t indexCount = 6ull * divisionCount * divisionCount;
+    const size_t meshSize = vertexCount * sizeof(VertexUV) + indexCount * sizeof(uint32_t);
+
+    printf("PlaneModel %d x %d (%s, %u threads)\n",
+        divisionCount, divisionCount,
+        parallel ? "parallel, streamed" : "serial, std::vector",
+        parallel ? ThreadPool::getShared().getThreadCount() : 1u);
+    printf("  mesh size      %10.1f MB\n", toMegabytes(meshSize));
+    printf("  creation time  %10.1f ms\n", milliseconds);
+    printf("  memory before  %10.1f MB\n", toMegabytes(memoryBefore));
+    printf("  peak memory    %10.1f MB (+%.1f MB)\n",
+        toMegabytes(peakAfter), toMegabytes(peakAfter - peakBefore));
+}
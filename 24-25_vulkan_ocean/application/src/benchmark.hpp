@@ -0,0 +1,17 @@
+#pragma once
+
+#include "ve.hpp"
+
+/// @brief Command line benchmarks, run instead of the application.
+namespace benchmark
+{
+    /// @brief Peak resident memory of the process in bytes, 0 if unknown.
+    size_t getPeakMemory();
+
+    /// @brief Current resident memory of the process in bytes, 0 if unknown.
+    size_t getCurrentMemory();
+
+    /// @brief Measures the creation of a PlaneModel, generation and upload.
+    /// Run each variant in its own process, the peak memory never decreases.
+    void planeModel(VulkanBase &base, int divisionCount, bool parallel);
+}
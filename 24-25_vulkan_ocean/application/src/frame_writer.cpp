@@ -0,0 +1,192 @@
+#include "frame_writer.hpp"
+
+FrameWriter::FrameWriter(FrameFileFormat format, const std::string &pathPattern)
+    : m_format{ format }
+    , m_pathPattern{ pathPattern }
+    , m_pathPrefix{}
+    , m_pathSuffix{}
+    , m_numberWidth{ 0 }
+    , m_rawFile{ nullptr }
+    , m_pendingCount{ 0 }
+    , m_error{}
+{
+    if (m_format != FrameFileFormat::eRaw)
+    {
+        parsePathPattern();
+        return;
+    }
+
+    m_rawFile = (m_pathPattern == "-") ? stdout : fopen(m_pathPattern.c_str(), "wb");
+    if (m_rawFile == nullptr)
+    {
+        throw std::runtime_error("failed to open the raw stream " + m_pathPattern);
+    }
+}
+
+FrameWriter::~FrameWriter()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this]() { return m_pendingCount == 0; });
+    }
+    if (m_rawFile && m_rawFile != stdout)
+    {
+        fclose(m_rawFile);
+    }
+}
+
+vk::Format FrameWriter::getColorFormat(FrameFileFormat format)
+{
+    return (format == FrameFileFormat::eEXR)
+        ? vk::Format::eR16G16B16A16Sfloat
+        : vk::Format::eR8G8B8A8Unorm;
+}
+
+void FrameWriter::write(const FrameReadback &readback)
+{
+    if (readback.format != getColorFormat(m_format))
+    {
+        throw std::runtime_error("the frame format does not match the output format");
+    }
+
+    if (m_format == FrameFileFormat::eRaw)
+    {
+        size_t size = static_cast<size_t>(readback.size);
+        if (fwrite(readback.data, 1, size, m_rawFile) != size)
+        {
+            throw std::runtime_error("failed to write the raw stream " + m_pathPattern);
+        }
+        return;
+    }
+
+    {
+        VE_TRACE_SCOPE("Wait for writer");
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this]() { return m_pendingCount < MAX_PENDING_FRAMES; });
+        if (m_error.empty() == false)
+        {
+            throw std::runtime_error(m_error);
+        }
+        m_pendingCount++;
+    }
+
+    // The readback data is only valid during the call
+    const uint8_t *begin = static_cast<const uint8_t *>(readback.data);
+    auto pixels = std::make_shared<std::vector<uint8_t>>(begin, begin + readback.size);
+    std::string path = getFramePath(readback.frameNumber);
+    uint32_t width = readback.width;
+    uint32_t height = readback.height;
+    FrameFileFormat format = m_format;
+
+    ThreadPool::getShared().enqueue([this, pixels, path, width, height, format]() {
+        VE_TRACE_SCOPE("Encode frame");
+        std::string error;
+        try
+        {
+            if (format == FrameFileFormat::ePNG)
+            {
+                imageio::writePNG(path, width, height, pixels->data());
+            }
+            else
+            {
+                imageio::writeEXR(
+                    path, width, height, reinterpret_cast<const uint16_t *>(pixels->data()));
+            }
+        }
+        catch (const std::exception &e)
+        {
+            error = e.what();
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (error.empty() == false && m_error.empty())
+        {
+            m_error = error;
+        }
+        m_pendingCount--;
+        m_condition.notify_all();
+    });
+}
+
+void FrameWriter::wait()
+{
+    if (m_rawFile)
+    {
+        fflush(m_rawFile);
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this]() { return m_pendingCount == 0; });
+    if (m_error.empty() == false)
+    {
+        throw std::runtime_error(m_error);
+    }
+}
+
+void FrameWriter::parsePathPattern()
+{
+    // The pattern comes from the command line, it is never used as a
+    // printf format
+    const std::string invalidPattern = "invalid output pattern \"" + m_pathPattern
+        + "\", expected exactly one %d or %0Nd";
+
+    bool hasNumber = false;
+    for (size_t i = 0; i < m_pathPattern.size(); i++)
+    {
+        std::string &part = hasNumber ? m_pathSuffix : m_pathPrefix;
+        if (m_pathPattern[i] != '%')
+        {
+            part += m_pathPattern[i];
+            continue;
+        }
+        if (i + 1 < m_pathPattern.size() && m_pathPattern[i + 1] == '%')
+        {
+            part += '%';
+            i++;
+            continue;
+        }
+        if (hasNumber)
+        {
+            throw std::runtime_error(invalidPattern);
+        }
+
+        // %d or %0Nd
+        size_t end = i + 1;
+        size_t width = 0;
+        if (end < m_pathPattern.size() && m_pathPattern[end] == '0')
+        {
+            end++;
+            size_t digitsBegin = end;
+            while (end < m_pathPattern.size() && isdigit(static_cast<unsigned char>(m_pathPattern[end])))
+            {
+                width = 10 * width + static_cast<size_t>(m_pathPattern[end] - '0');
+                end++;
+            }
+            if (end == digitsBegin || width > 20)
+            {
+                throw std::runtime_error(invalidPattern);
+            }
+        }
+        if (end >= m_pathPattern.size() || m_pathPattern[end] != 'd')
+        {
+            throw std::runtime_error(invalidPattern);
+        }
+        m_numberWidth = width;
+        hasNumber = true;
+        i = end;
+    }
+    if (hasNumber == false)
+    {
+        throw std::runtime_error(invalidPattern);
+    }
+}
+
+std::string FrameWriter::getFramePath(uint64_t frameNumber) const
+{
+    std::string number = std::to_string(frameNumber);
+    if (number.size() < m_numberWidth)
+    {
+        number.insert(0, m_numberWidth - number.size(), '0');
+    }
+    return m_pathPrefix + number + m_pathSuffix;
+}
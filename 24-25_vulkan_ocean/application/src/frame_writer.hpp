@@ -0,0 +1,64 @@
+#pragma once
+
+#include "ve.hpp"
+
+#include <condition_variable>
+#include <mutex>
+
+enum class FrameFileFormat
+{
+    /// One 8-bit RGBA PNG file per frame.
+    ePNG,
+    /// One half float RGBA OpenEXR file per frame. The values are the
+    /// display encoded output of the shaders, tone mapped then raised to
+    /// 1/2.2 by ocean.frag, not scene linear radiance: the EXR keeps the
+    /// precision of the render target, a 2.2 power gives linear values.
+    eEXR,
+    /// Every frame appended to a single file, or to stdout with "-".
+    eRaw,
+};
+
+/// @brief Writes the frames read back by a headless renderer. PNG and EXR
+/// frames are encoded on the shared thread pool, at most MAX_PENDING_FRAMES
+/// at a time so that a slow disk throttles the rendering instead of filling
+/// the memory. The raw stream is written in order on the calling thread.
+class FrameWriter
+{
+public:
+    static constexpr uint32_t MAX_PENDING_FRAMES = 8;
+
+    /// @param pathPattern path with exactly one frame number conversion,
+    /// %d or %0Nd, such as "frames/ocean_%05d.png" ("%%" is a literal %),
+    /// or the path of the raw stream. Throws if the pattern is invalid.
+    FrameWriter(FrameFileFormat format, const std::string &pathPattern);
+    ~FrameWriter();
+
+    FrameWriter(const FrameWriter &) = delete;
+    FrameWriter &operator=(const FrameWriter &) = delete;
+
+    /// @brief Color format the renderer must use for this file format.
+    static vk::Format getColorFormat(FrameFileFormat format);
+
+    void write(const FrameReadback &readback);
+
+    /// @brief Blocks until every frame is written.
+    void wait();
+
+private:
+    /// @brief Splits the pattern around its frame number conversion.
+    void parsePathPattern();
+    std::string getFramePath(uint64_t frameNumber) const;
+
+    FrameFileFormat m_format;
+    std::string m_pathPattern;
+    std::string m_pathPrefix;
+    std::string m_pathSuffix;
+    /// Minimum digit count of the frame number, padded with zeros.
+    size_t m_numberWidth;
+    FILE *m_rawFile;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    uint32_t m_pendingCount;
+    std::string m_error;
+};
@@ -15,9 +15,186 @@
 #include "input/application_input.hpp"
 #include "application.hpp"
 #include "model.hpp"
+#include "benchmark.hpp"
+
+namespace
+{
+    /// Rejected and rewritten when the device or the driver changes.
+    const char *PIPELINE_CACHE_PATH = "pipeline_cache.bin";
+
+    /// Enabled when the device has them, OceanCulling falls back to one
+    /// indirect draw per tile without multiDrawIndirect.
+    vk::PhysicalDeviceFeatures getOptionalFeatures()
+    {
+        vk::PhysicalDeviceFeatures features{};
+        features.multiDrawIndirect = vk::True;
+        return features;
+    }
+
+    /// Written once the application has quit, a bad path only loses the trace.
+    void writeCpuTrace(const std::string &path)
+    {
+        try
+        {
+            CpuTracer::getShared().writeJSON(path);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "CPU trace: " << e.what() << std::endl;
+        }
+    }
+
+    /// Offline rendering without window, runs on a software driver such as
+    /// lavapipe: --headless [frameCount] --size [width]x[height]
+    /// --format [png|exr|raw] --output [path pattern] --fps [frame rate]
+    /// --gpu-profile [path.csv|path.json]
+    int runHeadless(int argc, char *argv[], uint32_t framesInFlight)
+    {
+        OfflineSettings settings{};
+        vk::Extent2D extent{ 1920, 1080 };
+        bool hasOutputPath = false;
+
+        for (int i = 1; i < argc; i++)
+        {
+            const char *value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+            if (strcmp(argv[i], "--headless") == 0 && value && value[0] != '-')
+            {
+                settings.frameCount = static_cast<uint32_t>(atoi(value));
+            }
+            else if (strcmp(argv[i], "--size") == 0 && value)
+            {
+                sscanf(value, "%ux%u", &extent.width, &extent.height);
+            }
+            else if (strcmp(argv[i], "--format") == 0 && value)
+            {
+                if (strcmp(value, "exr") == 0) settings.format = FrameFileFormat::eEXR;
+                else if (strcmp(value, "raw") == 0) settings.format = FrameFileFormat::eRaw;
+                else settings.format = FrameFileFormat::ePNG;
+            }
+            else if (strcmp(argv[i], "--output") == 0 && value)
+            {
+                settings.outputPath = value;
+                hasOutputPath = true;
+            }
+            else if (strcmp(argv[i], "--fps") == 0 && value)
+            {
+                settings.frameRate = static_cast<float>(atof(value));
+            }
+            else if (strcmp(argv[i], "--gpu-profile") == 0 && value)
+            {
+                settings.profilePath = value;
+            }
+        }
+        if (hasOutputPath == false)
+        {
+            if (settings.format == FrameFileFormat::eEXR) settings.outputPath = "ocean_%05d.exr";
+            if (settings.format == FrameFileFormat::eRaw) settings.outputPath = "ocean.rgba";
+        }
+
+        // The raw frames may go to stdout, the messages of the engine must
+        // not be mixed with them
+        std::streambuf *coutBuffer = std::cout.rdbuf();
+        if (settings.format == FrameFileFormat::eRaw && settings.outputPath == "-")
+        {
+            std::cout.rdbuf(std::cerr.rdbuf());
+        }
+
+        // No surface, hence no SDL nor swapchain extension
+        InstanceBuilder instanceBuilder;
+
+        DeviceBuilder deviceBuilder;
+        deviceBuilder
+            .enableTesselationShader()
+            .enableFillModeNonSolid()
+            .setOptionalFeatures(getOptionalFeatures())
+            .setPipelineCachePath(PIPELINE_CACHE_PATH);
+
+        DescriptorPoolBuilder descriptorPoolBuilder;
+        descriptorPoolBuilder
+            .setPoolFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+            .addPoolSize(vk::DescriptorType::eUniformBufferDynamic, 8)
+            .addPoolSize(vk::DescriptorType::eCombinedImageSampler, 12)
+            .addPoolSize(vk::DescriptorType::eStorageImage, 4)
+            .addPoolSize(vk::DescriptorType::eStorageBuffer, 8)
+            .addPoolSize(vk::DescriptorType::eStorageBufferDynamic, 2);
+
+        int exitCode = EXIT_SUCCESS;
+        try
+        {
+            Framework framework(
+                instanceBuilder, deviceBuilder, descriptorPoolBuilder,
+                extent, framesInFlight, FrameWriter::getColorFormat(settings.format));
+
+            Application app(framework);
+            app.renderOffline(settings);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << e.what() << std::endl;
+            exitCode = EXIT_FAILURE;
+        }
+
+        std::cout.rdbuf(coutBuffer);
+        return exitCode;
+    }
+}
 
 int main(int argc, char *argv[])
 {
+    VE_TRACE_THREAD_NAME("Main");
+
+    // Latency against throughput: --frames-in-flight [1-4]
+    // --present-mode [fifo|mailbox|immediate] --target-fps [fps]
+    // CPU zones written on exit, built with VE_ENABLE_TRACE: --cpu-trace [path.json]
+    // Gerstner waves against the FFT, quits when done: --wave-sweep [path.csv]
+    std::string cpuTracePath;
+    std::string waveSweepPath;
+    uint32_t framesInFlight = Renderer::DEFAULT_FRAMES_IN_FLIGHT;
+    vk::PresentModeKHR presentMode = vk::PresentModeKHR::eFifo;
+    float targetFrameRate = 0.f;
+    bool headless = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--headless") == 0)
+        {
+            headless = true;
+        }
+        if (i + 1 >= argc) continue;
+
+        if (strcmp(argv[i], "--frames-in-flight") == 0)
+        {
+            framesInFlight = static_cast<uint32_t>(atoi(argv[i + 1]));
+        }
+        else if (strcmp(argv[i], "--present-mode") == 0)
+        {
+            if (strcmp(argv[i + 1], "mailbox") == 0) presentMode = vk::PresentModeKHR::eMailbox;
+            else if (strcmp(argv[i + 1], "immediate") == 0) presentMode = vk::PresentModeKHR::eImmediate;
+            else presentMode = vk::PresentModeKHR::eFifo;
+        }
+        else if (strcmp(argv[i], "--target-fps") == 0)
+        {
+            targetFrameRate = static_cast<float>(atof(argv[i + 1]));
+        }
+        else if (strcmp(argv[i], "--cpu-trace") == 0)
+        {
+            cpuTracePath = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--wave-sweep") == 0)
+        {
+            waveSweepPath = argv[i + 1];
+        }
+    }
+
+    if (headless)
+    {
+        int exitCode = runHeadless(argc, argv, framesInFlight);
+        if (cpuTracePath.empty() == false)
+        {
+            writeCpuTrace(cpuTracePath);
+        }
+        return exitCode;
+    }
+
     //--------------------------------------------------------------------------
     // Initialisation
 
@@ -49,20 +226,41 @@ int main(int argc, char *argv[])
     deviceBuilder
         .enableTesselationShader()
         .enableFillModeNonSolid()
-        .addExtension(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        .setOptionalFeatures(getOptionalFeatures())
+        .addExtension(VK_KHR_SWAPCHAIN_EXTENSION_NAME)
+        .setPipelineCachePath(PIPELINE_CACHE_PATH);
 
     DescriptorPoolBuilder descriptorPoolBuilder;
     descriptorPoolBuilder
         .setPoolFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
-        .addPoolSize(vk::DescriptorType::eUniformBuffer, 6 * Renderer::MAX_FRAMES_IN_FLIGHT)
-        .addPoolSize(vk::DescriptorType::eCombinedImageSampler, 6 * Renderer::MAX_FRAMES_IN_FLIGHT);
+        .addPoolSize(vk::DescriptorType::eUniformBufferDynamic, 8)
+        .addPoolSize(vk::DescriptorType::eCombinedImageSampler, 12)
+        .addPoolSize(vk::DescriptorType::eStorageImage, 4)
+        .addPoolSize(vk::DescriptorType::eStorageBuffer, 8)
+        .addPoolSize(vk::DescriptorType::eStorageBufferDynamic, 2);
 
     try
     {
-        Framework framework(instanceBuilder, deviceBuilder, descriptorPoolBuilder, m_window);
-        Application app(framework);
+        Framework framework(
+            instanceBuilder, deviceBuilder, descriptorPoolBuilder,
+            m_window, framesInFlight);
 
-        app.run();
+        // Benchmarks: --bench-plane [serial|parallel] [divisionCount]
+        if (argc >= 2 && strcmp(argv[1], "--bench-plane") == 0)
+        {
+            bool parallel = (argc < 3 || strcmp(argv[2], "serial") != 0);
+            int divisionCount = (argc >= 4) ? atoi(argv[3]) : 4096;
+            benchmark::planeModel(framework.getVulkanBase(), divisionCount, parallel);
+        }
+        else
+        {
+            framework.getRenderer().setPresentMode(presentMode);
+
+            Application app(framework);
+            app.setTargetFrameRate(targetFrameRate);
+            app.setWaveSweepPath(waveSweepPath);
+            app.run();
+        }
     }
     catch (const std::exception &e)
     {
@@ -72,5 +270,10 @@ int main(int argc, char *argv[])
 
     SDL_Quit();
 
+    if (cpuTracePath.empty() == false)
+    {
+        writeCpuTrace(cpuTracePath);
+    }
+
     return EXIT_SUCCESS;
 }
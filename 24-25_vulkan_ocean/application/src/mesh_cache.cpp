@@ -0,0 +1,112 @@
+#include "mesh_cache.hpp"
+
+#include <filesystem>
+
+namespace
+{
+    constexpr char MESH_CACHE_MAGIC[4] = { 'V', 'E', 'M', 'C' };
+}
+
+MeshCache::MeshCache(const std::string &sourcePath, uint32_t vertexSize, uint32_t importFlags)
+    : m_cachePath{ getCachePath(sourcePath) }
+    , m_sourceHash{ 0 }
+    , m_vertexSize{ vertexSize }
+    , m_importFlags{ importFlags }
+    , m_cacheFile{}
+{
+    m_sourceHash = MappedFile(sourcePath).computeHash();
+
+    std::error_code error;
+    if (std::filesystem::exists(m_cachePath, error) == false)
+    {
+        return;
+    }
+
+    auto cacheFile = std::make_unique<MappedFile>(m_cachePath);
+    if (cacheFile->getSize() < sizeof(MeshCacheHeader))
+    {
+        return;
+    }
+
+    MeshCacheHeader header{};
+    memcpy(&header, cacheFile->getData(), sizeof(MeshCacheHeader));
+
+    const uint64_t expectedSize =
+        sizeof(MeshCacheHeader) +
+        static_cast<uint64_t>(header.vertexCount) * header.vertexSize +
+        static_cast<uint64_t>(header.indexCount) * sizeof(uint32_t);
+
+    bool valid =
+        memcmp(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC)) == 0 &&
+        header.version == VERSION &&
+        header.sourceHash == m_sourceHash &&
+        header.vertexSize == m_vertexSize &&
+        header.importFlags == m_importFlags &&
+        cacheFile->getSize() == expectedSize;
+
+    if (valid)
+    {
+        m_cacheFile = std::move(cacheFile);
+    }
+}
+
+const MeshCacheHeader &MeshCache::getHeader() const
+{
+    assert(isValid());
+    return *reinterpret_cast<const MeshCacheHeader *>(m_cacheFile->getData());
+}
+
+uint32_t MeshCache::getVertexCount() const
+{
+    return getHeader().vertexCount;
+}
+
+uint32_t MeshCache::getIndexCount() const
+{
+    return getHeader().indexCount;
+}
+
+const void *MeshCache::getVertices() const
+{
+    assert(isValid());
+    return m_cacheFile->getData() + sizeof(MeshCacheHeader);
+}
+
+const uint32_t *MeshCache::getIndices() const
+{
+    assert(isValid());
+    return reinterpret_cast<const uint32_t *>(
+        m_cacheFile->getData() + sizeof(MeshCacheHeader) +
+        static_cast<size_t>(getHeader().vertexCount) * m_vertexSize);
+}
+
+void MeshCache::write(
+    const void *vertices, uint32_t vertexCount,
+    const uint32_t *indices, uint32_t indexCount) const
+{
+    MeshCacheHeader header{};
+    memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC));
+    header.version = VERSION;
+    header.sourceHash = m_sourceHash;
+    header.vertexSize = m_vertexSize;
+    header.vertexCount = vertexCount;
+    header.indexCount = indexCount;
+    header.importFlags = m_importFlags;
+
+    try
+    {
+        writeFileAtomic(m_cachePath, {
+            { &header, sizeof(header) },
+            { vertices, static_cast<size_t>(vertexCount) * m_vertexSize },
+            { indices, static_cast<size_t>(indexCount) * sizeof(uint32_t) } });
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Failed to write the mesh cache: " << e.what() << std::endl;
+    }
+}
+
+std::string MeshCache::getCachePath(const std::string &sourcePath)
+{
+    return sourcePath + ".vemesh";
+}
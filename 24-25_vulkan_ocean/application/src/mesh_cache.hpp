@@ -0,0 +1,58 @@
+#pragma once
+
+#include "ve.hpp"
+
+struct MeshCacheHeader
+{
+    char magic[4];
+    uint32_t version;
+    /// Hash of the source file contents.
+    uint64_t sourceHash;
+    /// Size of a vertex, detects vertex layout changes.
+    uint32_t vertexSize;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    /// Import options the mesh was processed with.
+    uint32_t importFlags;
+};
+
+/// @brief Binary copy of an imported mesh, stored next to its source file.
+/// The file is a MeshCacheHeader followed by the vertices and the 32-bit
+/// indices, exactly as they are uploaded to the GPU. It is memory mapped,
+/// so loading it only costs the copy into the staging memory.
+class MeshCache
+{
+public:
+    /// Increase when the import or the file layout changes.
+    static constexpr uint32_t VERSION = 2;
+
+    /// @brief Hashes the source file and maps its cache if it is up to date.
+    /// @param importFlags options of the import, a cache written with other
+    /// options is not valid.
+    MeshCache(const std::string &sourcePath, uint32_t vertexSize, uint32_t importFlags = 0);
+
+    /// @brief True if the cache matches the source and can be used.
+    bool isValid() const { return m_cacheFile != nullptr; }
+
+    uint32_t getVertexCount() const;
+    uint32_t getIndexCount() const;
+    const void *getVertices() const;
+    const uint32_t *getIndices() const;
+
+    /// @brief Writes the cache of the source file with writeFileAtomic().
+    /// Failures are reported but not fatal.
+    void write(
+        const void *vertices, uint32_t vertexCount,
+        const uint32_t *indices, uint32_t indexCount) const;
+
+    static std::string getCachePath(const std::string &sourcePath);
+
+private:
+    const MeshCacheHeader &getHeader() const;
+
+    std::string m_cachePath;
+    uint64_t m_sourceHash;
+    uint32_t m_vertexSize;
+    uint32_t m_importFlags;
+    std::unique_ptr<MappedFile> m_cacheFile;
+};
@@ -1,4 +1,5 @@
 #include "model.hpp"
+#include "mesh_cache.hpp"
 #include <tiny_obj_loader.h>
 
 FullscreenModel::FullscreenModel(VulkanBase &base)
@@ -22,12 +23,23 @@ FullscreenModel::FullscreenModel(VulkanBase &base)
     vertex.pos = { +1.f, +1.f, 0.f }; vertex.texCoord = { 1.f, 1.f }; vertices.push_back(vertex);
     vertex.pos = { +1.f, -1.f, 0.f }; vertex.texCoord = { 1.f, 0.f }; vertices.push_back(vertex);
 
-    createVertexBuffer(vertices);
-    createIndexBuffer(indices);
+    createBuffers(vertices, indices);
 }
 
-PlaneModel::PlaneModel(VulkanBase &base, float size, int divisionCount)
+PlaneModel::PlaneModel(VulkanBase &base, float size, int divisionCount, bool parallel)
     : Model{ base }
+{
+    if (parallel)
+    {
+        createParallel(size, divisionCount);
+    }
+    else
+    {
+        createSerial(size, divisionCount);
+    }
+}
+
+void PlaneModel::createSerial(float size, int divisionCount)
 {
     std::vector<VertexUV> vertices{};
     std::vector<uint32_t> indices{};
@@ -61,10 +73,305 @@ PlaneModel::PlaneModel(VulkanBase &base, float size, int divisionCount)
         }
     }
 
-    createVertexBuffer(vertices);
-    createIndexBuffer(indices);
+    createBuffers(vertices, indices);
+}
+
+void PlaneModel::createParallel(float size, int divisionCount)
+{
+    // Same layout as createSerial(), each element is computed from its index
+    const uint32_t vertexPerSide = static_cast<uint32_t>(divisionCount) + 1;
+    const uint32_t vertexCount = vertexPerSide * vertexPerSide;
+    const uint32_t indexCount = 6 * static_cast<uint32_t>(divisionCount * divisionCount);
+    const uint32_t cellPerSide = static_cast<uint32_t>(divisionCount);
+    const float step = 1.0f / (float)divisionCount;
+
+    // Large ranges keep the tasks longer than the scheduling cost
+    const uint32_t minRangeSize = 1 << 14;
+    ThreadPool &threadPool = ThreadPool::getShared();
+
+    auto writeVertices = [&](void *dst, uint32_t first, uint32_t count)
+    {
+        VertexUV *vertices = static_cast<VertexUV *>(dst);
+        threadPool.parallelFor(count, [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t k = begin; k < end; k++)
+            {
+                uint32_t i = (first + k) / vertexPerSide;
+                uint32_t j = (first + k) % vertexPerSide;
+
+                VertexUV &vertex = vertices[k];
+                vertex.pos = {
+                    ((float)i - 0.5f * divisionCount) * size / (float)divisionCount,
+                    0.0f,
+                    ((float)j - 0.5f * divisionCount) * size / (float)divisionCount
+                };
+                vertex.texCoord = { i * step, j * step };
+            }
+        }, minRangeSize);
+    };
+
+    // Corners of the two triangles of a cell, as (di, dj)
+    static const uint32_t cornerI[6] = { 0, 1, 0, 1, 1, 0 };
+    static const uint32_t cornerJ[6] = { 0, 0, 1, 0, 1, 1 };
+
+    auto writeIndices = [&](void *dst, uint32_t first, uint32_t count)
+    {
+        uint32_t *indices = static_cast<uint32_t *>(dst);
+        threadPool.parallelFor(count, [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t k = begin; k < end; k++)
+            {
+                uint32_t cell = (first + k) / 6;
+                uint32_t corner = (first + k) % 6;
+                uint32_t i = cell / cellPerSide + cornerI[corner];
+                uint32_t j = cell % cellPerSide + cornerJ[corner];
+                indices[k] = i * vertexPerSide + j;
+            }
+        }, minRangeSize);
+    };
+
+    createBuffers(vertexCount, writeVertices, indexCount, writeIndices);
 }
 
+TiledGridModel::TiledGridModel(
+    VulkanBase &base, float size, int divisionCount, int tileCellCount)
+    : Model{ base }
+    , m_tiles{}
+    , m_tileIndexCount{ 0 }
+    , m_tileVertexCount{ 0 }
+{
+    assert(tileCellCount >= 1 && tileCellCount <= MAX_TILE_CELL_COUNT);
+    assert(divisionCount % tileCellCount == 0 && "The tiles must divide the grid");
+
+    const uint32_t tileVertexPerSide = static_cast<uint32_t>(tileCellCount) + 1;
+    const uint32_t tilePerSide = static_cast<uint32_t>(divisionCount / tileCellCount);
+    const uint32_t tileCount = tilePerSide * tilePerSide;
+    const float step = 1.0f / (float)divisionCount;
+    const float cellSize = size / (float)divisionCount;
+
+    m_tileVertexCount = tileVertexPerSide * tileVertexPerSide;
+    m_tileIndexCount = 6 * static_cast<uint32_t>(tileCellCount * tileCellCount);
+
+    m_tiles.resize(tileCount);
+    for (uint32_t t = 0; t < tileCount; t++)
+    {
+        float minI = (float)((t / tilePerSide) * tileCellCount);
+        float minJ = (float)((t % tilePerSide) * tileCellCount);
+
+        GridTile &tile = m_tiles[t];
+        tile.vertexOffset = static_cast<int32_t>(t * m_tileVertexCount);
+        tile.boundsMin = { (minI - 0.5f * divisionCount) * cellSize, 0.f, (minJ - 0.5f * divisionCount) * cellSize };
+        tile.boundsMax = tile.boundsMin + glm::vec3(tileCellCount * cellSize, 0.f, tileCellCount * cellSize);
+    }
+
+    // Shared tile topology, same triangles as PlaneModel
+    std::vector<uint16_t> indices{};
+    indices.reserve(m_tileIndexCount);
+    for (uint32_t i = 0; i < (uint32_t)tileCellCount; i++)
+    {
+        for (uint32_t j = 0; j < (uint32_t)tileCellCount; j++)
+        {
+            indices.push_back(static_cast<uint16_t>(i * tileVertexPerSide + j));
+            indices.push_back(static_cast<uint16_t>((i + 1) * tileVertexPerSide + j));
+            indices.push_back(static_cast<uint16_t>(i * tileVertexPerSide + (j + 1)));
+
+            indices.push_back(static_cast<uint16_t>((i + 1) * tileVertexPerSide + j));
+            indices.push_back(static_cast<uint16_t>((i + 1) * tileVertexPerSide + (j + 1)));
+            indices.push_back(static_cast<uint16_t>(i * tileVertexPerSide + (j + 1)));
+        }
+    }
+
+    // Vertices are generated in the staging memory, tile after tile
+    const uint32_t tileVertexCount = m_tileVertexCount;
+    ThreadPool &threadPool = ThreadPool::getShared();
+
+    auto writeVertices = [&](void *dst, uint32_t first, uint32_t count)
+    {
+        VertexUV *vertices = static_cast<VertexUV *>(dst);
+        threadPool.parallelFor(count, [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t k = begin; k < end; k++)
+            {
+                uint32_t tile = (first + k) / tileVertexCount;
+                uint32_t local = (first + k) % tileVertexCount;
+                uint32_t i = (tile / tilePerSide) * tileCellCount + local / tileVertexPerSide;
+                uint32_t j = (tile % tilePerSide) * tileCellCount + local % tileVertexPerSide;
+
+                VertexUV &vertex = vertices[k];
+                vertex.pos = {
+                    ((float)i - 0.5f * divisionCount) * size / (float)divisionCount,
+                    0.0f,
+                    ((float)j - 0.5f * divisionCount) * size / (float)divisionCount
+                };
+                vertex.texCoord = { i * step, j * step };
+            }
+        }, 1 << 14);
+    };
+
+    auto writeIndices = [&indices](void *dst, uint32_t first, uint32_t count)
+    {
+        memcpy(dst, indices.data() + first, count * sizeof(uint16_t));
+    };
+
+    createBuffers(
+        tileCount * m_tileVertexCount, writeVertices,
+        m_tileIndexCount, writeIndices,
+        vk::IndexType::eUint16);
+}
+
+void TiledGridModel::drawTile(vk::CommandBuffer commandBuffer, uint32_t tileIndex)
+{
+    assert(tileIndex < m_tiles.size());
+    draw(commandBuffer, 0, m_tileIndexCount, m_tiles[tileIndex].vertexOffset);
+}
+
+void TiledGridModel::drawTiles(vk::CommandBuffer commandBuffer)
+{
+    for (const GridTile &tile : m_tiles)
+    {
+        draw(commandBuffer, 0, m_tileIndexCount, tile.vertexOffset);
+    }
+}
+
+ClipmapModel::ClipmapModel(VulkanBase &base, int cellCount)
+    : Model{ base }
+    , m_cellCount{ cellCount }
+    , m_gridRange{}
+    , m_ringRanges{}
+{
+    assert(cellCount >= 8 && cellCount % 4 == 0 && "The cell count must be a multiple of 4");
+
+    const int vertexPerSide = cellCount + 1;
+
+    std::vector<VertexUV> vertices{};
+    std::vector<uint32_t> indices{};
+    vertices.reserve(vertexPerSide * vertexPerSide);
+
+    VertexUV vertex{};
+    for (int j = 0; j <= cellCount; j++)
+    {
+        for (int i = 0; i <= cellCount; i++)
+        {
+            vertex.pos = { (float)i, 0.0f, (float)j };
+            vertex.texCoord = { (float)i / cellCount, (float)j / cellCount };
+            vertices.push_back(vertex);
+        }
+    }
+
+    auto addCells = [&](int holeMinX, int holeMinZ, int holeSize)
+    {
+        IndexRange range{};
+        range.firstIndex = static_cast<uint32_t>(indices.size());
+
+        for (int j = 0; j < cellCount; j++)
+        {
+            for (int i = 0; i < cellCount; i++)
+            {
+                if (i >= holeMinX && i < holeMinX + holeSize &&
+                    j >= holeMinZ && j < holeMinZ + holeSize)
+                {
+                    continue;
+                }
+
+                // Same winding as the plane model
+                indices.push_back(j * vertexPerSide + i);
+                indices.push_back(j * vertexPerSide + (i + 1));
+                indices.push_back((j + 1) * vertexPerSide + i);
+
+                indices.push_back(j * vertexPerSide + (i + 1));
+                indices.push_back((j + 1) * vertexPerSide + (i + 1));
+                indices.push_back((j + 1) * vertexPerSide + i);
+            }
+        }
+
+        range.indexCount = static_cast<uint32_t>(indices.size()) - range.firstIndex;
+        return range;
+    };
+
+    m_gridRange = addCells(0, 0, 0);
+    for (int offsetZ = 0; offsetZ < 2; offsetZ++)
+    {
+        for (int offsetX = 0; offsetX < 2; offsetX++)
+        {
+            m_ringRanges[2 * offsetZ + offsetX] = addCells(
+                cellCount / 4 + offsetX, cellCount / 4 + offsetZ, cellCount / 2);
+        }
+    }
+
+    createBuffers(vertices, indices);
+}
+
+IndexRange ClipmapModel::getRingRange(int offsetX, int offsetZ) const
+{
+    assert(offsetX >= 0 && offsetX < 2 && offsetZ >= 0 && offsetZ < 2);
+    return m_ringRanges[2 * offsetZ + offsetX];
+}
+
+PatchGridModel::PatchGridModel(VulkanBase &base, int patchCount)
+    : Model{ base }
+    , m_patchCount{ patchCount }
+{
+    assert(patchCount >= 1);
+
+    const int vertexPerSide = patchCount + 1;
+
+    std::vector<VertexUV> vertices{};
+    std::vector<uint32_t> indices{};
+    vertices.reserve(vertexPerSide * vertexPerSide);
+    indices.reserve(4 * patchCount * patchCount);
+
+    VertexUV vertex{};
+    for (int j = 0; j <= patchCount; j++)
+    {
+        for (int i = 0; i <= patchCount; i++)
+        {
+            vertex.pos = { (float)i, 0.0f, (float)j };
+            vertex.texCoord = { (float)i / patchCount, (float)j / patchCount };
+            vertices.push_back(vertex);
+        }
+    }
+
+    // Control points in the order expected by ocean.tese:
+    // (i, j), (i + 1, j), (i + 1, j + 1), (i, j + 1)
+    for (int j = 0; j < patchCount; j++)
+    {
+        for (int i = 0; i < patchCount; i++)
+        {
+            indices.push_back(j * vertexPerSide + i);
+            indices.push_back(j * vertexPerSide + (i + 1));
+            indices.push_back((j + 1) * vertexPerSide + (i + 1));
+            indices.push_back((j + 1) * vertexPerSide + i);
+        }
+    }
+
+    createBuffers(vertices, indices);
+}
+
+ProceduralGridModel::ProceduralGridModel(float size, int divisionCount)
+    : m_size{ size }
+    , m_divisionCount{ divisionCount }
+{
+    assert(divisionCount >= 1);
+}
+
+glm::mat4 ProceduralGridModel::getGridMatrix() const
+{
+    float cellSize = m_size / (float)m_divisionCount;
+    glm::mat4 gridMatrix = glm::translate(
+        glm::mat4(1.f), glm::vec3(-0.5f * m_size, 0.f, -0.5f * m_size));
+    return glm::scale(gridMatrix, glm::vec3(cellSize, 1.f, cellSize));
+}
+
+uint32_t ProceduralGridModel::getTriangleCount() const
+{
+    return 2 * static_cast<uint32_t>(m_divisionCount) * static_cast<uint32_t>(m_divisionCount);
+}
+
+void ProceduralGridModel::draw(vk::CommandBuffer commandBuffer)
+{
+    const uint32_t vertexPerStrip = 2 * (m_divisionCount + 1);
+    commandBuffer.draw(vertexPerStrip, m_divisionCount, 0, 0);
+}
 
 SkyboxModel::SkyboxModel(VulkanBase &base)
     : Model{ base }
@@ -98,16 +405,51 @@ SkyboxModel::SkyboxModel(VulkanBase &base)
     vertex = { +1.0f, +1.0f, -1.0f }; vertices.push_back(vertex);
     vertex = { -1.0f, +1.0f, -1.0f }; vertices.push_back(vertex);
 
-    createVertexBuffer(vertices);
-    createIndexBuffer(indices);
+    createBuffers(vertices, indices);
 }
 
-SimpleModel::SimpleModel(VulkanBase &base, const std::string &filepath)
+SimpleModel::SimpleModel(VulkanBase &base, const std::string &filepath, bool optimizeOverdraw)
     : Model{ base }
 {
+    MeshCache cache{ filepath, sizeof(SimpleVertex), optimizeOverdraw ? 1u : 0u };
+    if (cache.isValid())
+    {
+        // The mapped cache is copied directly into the staging memory
+        const SimpleVertex *cachedVertices = static_cast<const SimpleVertex *>(cache.getVertices());
+        const uint32_t *cachedIndices = cache.getIndices();
+
+        createBuffers(
+            cache.getVertexCount(),
+            [cachedVertices](void *dst, uint32_t first, uint32_t count) {
+                memcpy(dst, cachedVertices + first, count * sizeof(SimpleVertex));
+            },
+            cache.getIndexCount(),
+            [cachedIndices](void *dst, uint32_t first, uint32_t count) {
+                memcpy(dst, cachedIndices + first, count * sizeof(uint32_t));
+            });
+
+        std::cout << "Vertices = " << cache.getVertexCount() << " (cached)" << std::endl;
+        return;
+    }
+
     std::vector<SimpleVertex> vertices{};
     std::vector<uint32_t> indices{};
 
+    importObj(filepath, vertices, indices);
+    std::cout << "Vertices = " << vertices.size() << std::endl;
+
+    optimize(vertices, indices, optimizeOverdraw);
+    cache.write(
+        vertices.data(), static_cast<uint32_t>(vertices.size()),
+        indices.data(), static_cast<uint32_t>(indices.size()));
+
+    createBuffers(vertices, indices);
+}
+
+void SimpleModel::importObj(
+    const std::string &filepath,
+    std::vector<SimpleVertex> &vertices, std::vector<uint32_t> &indices)
+{
     tinyobj::attrib_t attrib;
     std::vector<tinyobj::shape_t> shapes;
     std::vector<tinyobj::material_t> materials;
@@ -133,10 +475,18 @@ SimpleModel::SimpleModel(VulkanBase &base, const std::string &filepath)
                 attrib.vertices[3 * index.vertex_index + 2]
             };
 
-            vertex.texCoord = {
-                attrib.texcoords[2 * index.texcoord_index + 0],
-                1.0 - attrib.texcoords[2 * index.texcoord_index + 1]
-            };
+            if (index.texcoord_index >= 0)
+            {
+                vertex.texCoord = {
+                    attrib.texcoords[2 * index.texcoord_index + 0],
+                    1.0 - attrib.texcoords[2 * index.texcoord_index + 1]
+                };
+            }
+            else
+            {
+                // Degenerate, the tangents fall back to arbitrary frames
+                vertex.texCoord = { 0.f, 0.f };
+            }
 
             if (index.normal_index >= 0) {
                 vertex.normal = {
@@ -150,7 +500,7 @@ SimpleModel::SimpleModel(VulkanBase &base, const std::string &filepath)
                 vertex.normal = { 0.f, 1.f, 0.f };
             }
 
-            vertex.tangent = { 0.f, 0.f, 0.f };
+            vertex.tangent = { 0.f, 0.f, 0.f, 0.f };
 
             if (uniqueVertices.count(vertex) == 0)
             {
@@ -162,55 +512,53 @@ SimpleModel::SimpleModel(VulkanBase &base, const std::string &filepath)
         }
     }
 
-    std::vector<glm::vec3> bitangents(vertices.size());
-
-    for (int i = 0; i < indices.size(); i += 3)
+    if (vertices.empty())
     {
-        assert(i + 2 < indices.size());
-        uint32_t vertexIndices[3] = {
-            indices[i + 0], indices[i + 1], indices[i + 2]
-        };
-
-        glm::vec3 v0 = vertices[vertexIndices[0]].pos;
-        glm::vec3 v1 = vertices[vertexIndices[1]].pos;
-        glm::vec3 v2 = vertices[vertexIndices[2]].pos;
-
-        glm::vec2 uv0 = vertices[vertexIndices[0]].texCoord;
-        glm::vec2 uv1 = vertices[vertexIndices[1]].texCoord;
-        glm::vec2 uv2 = vertices[vertexIndices[2]].texCoord;
-
-        glm::vec3 e1 = (v1 - v0);
-        glm::vec3 e2 = (v2 - v0);
+        throw std::runtime_error("No triangle in " + filepath);
+    }
 
-        float x1 = uv1.x - uv0.x;
-        float x2 = uv2.x - uv0.x;
-        float y1 = uv1.y - uv0.y;
-        float y2 = uv2.y - uv0.y;
+    meshopt::TangentSpaceInput tangentInput{};
+    tangentInput.positions = &vertices[0].pos.x;
+    tangentInput.normals = &vertices[0].normal.x;
+    tangentInput.texCoords = &vertices[0].texCoord.x;
+    tangentInput.stride = sizeof(SimpleVertex);
+    tangentInput.vertexCount = static_cast<uint32_t>(vertices.size());
 
-        float invDet = 1.0f / (x1 * y2 - x2 * y1);
+    std::vector<uint32_t> splitVertices{};
+    std::vector<glm::vec4> tangents = meshopt::generateTangents(tangentInput, indices, splitVertices);
 
-        glm::vec3 tangent = glm::normalize(invDet * (y2 * e1 - y1 * e2));
-        glm::vec3 bitangent = glm::normalize(invDet * (x1 * e2 - x2 * e1));
+    for (uint32_t source : splitVertices)
+    {
+        vertices.push_back(vertices[source]);
+    }
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        vertices[i].tangent = tangents[i];
+    }
+}
 
-        for (int j = 0; j < 3; ++j)
-        {
-            vertices[vertexIndices[j]].tangent += tangent;
-            bitangents[vertexIndices[j]] += bitangent;
-        }
+void SimpleModel::optimize(
+    std::vector<SimpleVertex> &vertices, std::vector<uint32_t> &indices,
+    bool optimizeOverdraw)
+{
+    if (indices.empty())
+    {
+        return;
     }
 
-    for (int i = 0; i < vertices.size(); i++)
+    const uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+    meshopt::VertexCacheStats before = meshopt::analyzeVertexCache(indices, vertexCount);
+
+    meshopt::optimizeVertexCache(indices, vertexCount);
+    if (optimizeOverdraw)
     {
-        const glm::vec3 &t = vertices[i].tangent;
-        const glm::vec3 &b = bitangents[i];
-        const glm::vec3 &n = vertices[i].normal;
-        float sign = glm::dot(glm::cross(t, b), n) > 0.f ? -1.f : 1.f;
-        sign = 1.0f;
-        vertices[i].tangent = sign * glm::normalize(t);
+        meshopt::optimizeOverdraw(
+            indices, &vertices[0].pos.x, sizeof(SimpleVertex), vertexCount);
     }
+    meshopt::optimizeVertexFetch(vertices, indices);
 
-    std::cout << "Vertices = " << vertices.size() << std::endl;
+    meshopt::VertexCacheStats after = meshopt::analyzeVertexCache(indices, vertexCount);
 
-    createVertexBuffer(vertices);
-    createIndexBuffer(indices);
+    std::cout << "ACMR = " << before.acmr << " -> " << after.acmr
+        << ", ATVR = " << before.atvr << " -> " << after.atvr << std::endl;
 }
\ No newline at end of file
@@ -24,17 +24,41 @@ public:
 
     void bind(vk::CommandBuffer commandBuffer);
     void draw(vk::CommandBuffer commandBuffer);
+    void draw(
+        vk::CommandBuffer commandBuffer,
+        uint32_t firstIndex, uint32_t indexCount,
+        int32_t vertexOffset = 0);
+
+    vk::IndexType getIndexType() const { return m_indexType; }
 
 protected:
     VulkanBase &m_base;
 
     Model(VulkanBase &base);
 
-    void createVertexBuffer(const std::vector<Vtx> &vertices);
-    void createIndexBuffer(const std::vector<uint32_t> &indices);
+    /// @brief Creates the device local buffers and uploads the mesh.
+    /// Both copies are streamed through the same staging ring, in a single
+    /// submission unless the mesh is larger than a ring slot.
+    void createBuffers(
+        const std::vector<Vtx> &vertices,
+        const std::vector<uint32_t> &indices);
+    void createBuffers(
+        const std::vector<Vtx> &vertices,
+        const std::vector<uint16_t> &indices);
+
+    /// @brief Same as above, but the mesh is generated chunk by chunk
+    /// directly in the staging memory, so it never exists as a whole on the
+    /// host.
+    void createBuffers(
+        uint32_t vertexCount,
+        const StagingRing::WriteFunction &writeVertices,
+        uint32_t indexCount,
+        const StagingRing::WriteFunction &writeIndices,
+        vk::IndexType indexType = vk::IndexType::eUint32);
 
     std::unique_ptr<Buffer> m_vertexBuffer;
     std::unique_ptr<Buffer> m_indexBuffer;
+    vk::IndexType m_indexType;
 };
 
 class SkyboxModel : public Model<glm::vec3>
@@ -51,7 +75,111 @@ struct VertexUV {
 class PlaneModel : public Model<VertexUV>
 {
 public:
-    PlaneModel(VulkanBase &base, float size, int divisionCount);
+    /// @param parallel generates the grid directly in the staging memory on
+    /// the shared thread pool, instead of building the arrays on one thread.
+    PlaneModel(VulkanBase &base, float size, int divisionCount, bool parallel = true);
+
+private:
+    void createSerial(float size, int divisionCount);
+    void createParallel(float size, int divisionCount);
+};
+
+struct IndexRange
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+};
+
+/// @brief Grid used by the clipmap levels.
+/// Vertices are in cell units, pos = (i, 0, j) with i, j in [0, cellCount].
+/// The index buffer holds the full grid followed by the four ring variants.
+class ClipmapModel : public Model<VertexUV>
+{
+public:
+    ClipmapModel(VulkanBase &base, int cellCount);
+
+    int getCellCount() const { return m_cellCount; }
+
+    /// @brief Full grid, used by the finest level.
+    IndexRange getGridRange() const { return m_gridRange; }
+
+    /// @brief Grid with a centered hole of half its size, shifted by
+    /// (offsetX, offsetZ) cells with offsets in {0, 1}.
+    IndexRange getRingRange(int offsetX, int offsetZ) const;
+
+private:
+    int m_cellCount;
+    IndexRange m_gridRange;
+    std::array<IndexRange, 4> m_ringRanges;
+};
+
+/// @brief Grid of quad patches for the tessellation pipeline.
+/// Vertices are in patch units, pos = (i, 0, j) with i, j in [0, patchCount],
+/// and each patch uses four indices, to draw with four control points.
+class PatchGridModel : public Model<VertexUV>
+{
+public:
+    PatchGridModel(VulkanBase &base, int patchCount);
+
+    int getPatchCount() const { return m_patchCount; }
+
+private:
+    int m_patchCount;
+};
+
+struct GridTile
+{
+    int32_t vertexOffset;
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+};
+
+/// @brief Same grid as PlaneModel, split into square tiles small enough for
+/// 16-bit indices.
+/// Every tile has the same topology, so they all share one index buffer and
+/// only differ by their vertex offset. Tile vertices are contiguous and the
+/// vertices on the tile borders are duplicated.
+class TiledGridModel : public Model<VertexUV>
+{
+public:
+    /// (254 + 1)^2 vertices is the largest tile addressable with 16 bits.
+    static constexpr int MAX_TILE_CELL_COUNT = 254;
+
+    /// @param tileCellCount cells per tile side, must divide divisionCount.
+    TiledGridModel(VulkanBase &base, float size, int divisionCount, int tileCellCount = 128);
+
+    const std::vector<GridTile> &getTiles() const { return m_tiles; }
+    uint32_t getTileIndexCount() const { return m_tileIndexCount; }
+    uint32_t getTileVertexCount() const { return m_tileVertexCount; }
+
+    void drawTile(vk::CommandBuffer commandBuffer, uint32_t tileIndex);
+    void drawTiles(vk::CommandBuffer commandBuffer);
+
+private:
+    std::vector<GridTile> m_tiles;
+    uint32_t m_tileIndexCount;
+    uint32_t m_tileVertexCount;
+};
+
+/// @brief Regular grid drawn without vertex or index buffer.
+/// Each row of cells is an instance drawn as a triangle strip, the vertex
+/// shader rebuilds the positions from gl_VertexIndex and gl_InstanceIndex
+/// (see ocean_grid.vert). Vertices are in cell units, pos = (i, 0, j).
+class ProceduralGridModel
+{
+public:
+    ProceduralGridModel(float size, int divisionCount);
+
+    /// @brief Cell units to local coordinates, centered like PlaneModel.
+    glm::mat4 getGridMatrix() const;
+    int getDivisionCount() const { return m_divisionCount; }
+    uint32_t getTriangleCount() const;
+
+    void draw(vk::CommandBuffer commandBuffer);
+
+private:
+    float m_size;
+    int m_divisionCount;
 };
 
 class FullscreenModel : public Model<VertexUV>
@@ -63,7 +191,9 @@ public:
 struct SimpleVertex {
     glm::vec3 pos;
     glm::vec3 normal;
-    glm::vec3 tangent;
+    /// xyz = tangent, w = bitangent sign, the bitangent is
+    /// w * cross(normal, tangent.xyz).
+    glm::vec4 tangent;
     glm::vec2 texCoord;
 
     bool operator==(const SimpleVertex &other) const
@@ -79,9 +209,27 @@ struct SimpleVertex {
 class SimpleModel : public Model<SimpleVertex>
 {
 public:
+    /// @brief Loads an OBJ file. The imported mesh is saved in a binary
+    /// cache next to the file and later loads map it instead of parsing.
+    /// @param optimizeOverdraw also sorts the triangles to reduce overdraw,
+    /// at the cost of a slightly worse vertex cache efficiency.
     SimpleModel(
         VulkanBase &base,
-        const std::string &filepath);
+        const std::string &filepath,
+        bool optimizeOverdraw = false);
+
+private:
+    /// @brief Parses the OBJ file, merges the identical vertices and
+    /// computes MikkTSpace tangents, which may add vertices.
+    static void importObj(
+        const std::string &filepath,
+        std::vector<SimpleVertex> &vertices, std::vector<uint32_t> &indices);
+
+    /// @brief Reorders the triangles and the vertices for the vertex cache
+    /// and the vertex fetch, prints the ACMR and ATVR before and after.
+    static void optimize(
+        std::vector<SimpleVertex> &vertices, std::vector<uint32_t> &indices,
+        bool optimizeOverdraw);
 };
 
 namespace std
@@ -93,7 +241,7 @@ namespace std
             seed ^= hash<glm::vec3>()(vertex.pos) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
             seed ^= hash<glm::vec2>()(vertex.texCoord) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
             seed ^= hash<glm::vec3>()(vertex.normal) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-            seed ^= hash<glm::vec3>()(vertex.tangent) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            seed ^= hash<glm::vec4>()(vertex.tangent) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
             return seed;
         }
     };
@@ -102,9 +250,9 @@ namespace std
 template<class Vtx>
 Model<Vtx>::Model(VulkanBase &base, std::vector<Vtx> &vertices, std::vector<uint32_t> &indices)
     : m_base{ base }
+    , m_indexType{ vk::IndexType::eUint32 }
 {
-    createVertexBuffer(vertices);
-    createIndexBuffer(indices);
+    createBuffers(vertices, indices);
 }
 
 template<class Vtx>
@@ -116,7 +264,7 @@ template<class Vtx>
 void Model<Vtx>::bind(vk::CommandBuffer commandBuffer)
 {
     commandBuffer.bindVertexBuffers(0, { m_vertexBuffer->getBuffer() }, { 0 });
-    commandBuffer.bindIndexBuffer(m_indexBuffer->getBuffer(), 0, vk::IndexType::eUint32);
+    commandBuffer.bindIndexBuffer(m_indexBuffer->getBuffer(), 0, m_indexType);
 }
 
 template<class Vtx>
@@ -127,88 +275,114 @@ void Model<Vtx>::draw(vk::CommandBuffer commandBuffer)
         1, 0, 0, 0);
 }
 
+template<class Vtx>
+void Model<Vtx>::draw(
+    vk::CommandBuffer commandBuffer,
+    uint32_t firstIndex, uint32_t indexCount,
+    int32_t vertexOffset)
+{
+    assert(firstIndex + indexCount <= m_indexBuffer->getElementCount() && "Index range out of bounds");
+    commandBuffer.drawIndexed(indexCount, 1, firstIndex, vertexOffset, 0);
+}
+
 template<class Vtx>
 Model<Vtx>::Model(VulkanBase &base)
     : m_base{ base }
+    , m_indexType{ vk::IndexType::eUint32 }
+{
+}
+
+template<class Vtx>
+void Model<Vtx>::createBuffers(
+    const std::vector<Vtx> &vertices,
+    const std::vector<uint32_t> &indices)
 {
+    createBuffers(
+        static_cast<uint32_t>(vertices.size()),
+        [&vertices](void *dst, uint32_t first, uint32_t count) {
+            memcpy(dst, vertices.data() + first, count * sizeof(Vtx));
+        },
+        static_cast<uint32_t>(indices.size()),
+        [&indices](void *dst, uint32_t first, uint32_t count) {
+            memcpy(dst, indices.data() + first, count * sizeof(uint32_t));
+        });
 }
 
 template<class Vtx>
-void Model<Vtx>::createVertexBuffer(const std::vector<Vtx> &vertices)
+void Model<Vtx>::createBuffers(
+    const std::vector<Vtx> &vertices,
+    const std::vector<uint16_t> &indices)
+{
+    assert(vertices.size() <= 0xFFFF && "16-bit indices address at most 65535 vertices");
+
+    createBuffers(
+        static_cast<uint32_t>(vertices.size()),
+        [&vertices](void *dst, uint32_t first, uint32_t count) {
+            memcpy(dst, vertices.data() + first, count * sizeof(Vtx));
+        },
+        static_cast<uint32_t>(indices.size()),
+        [&indices](void *dst, uint32_t first, uint32_t count) {
+            memcpy(dst, indices.data() + first, count * sizeof(uint16_t));
+        },
+        vk::IndexType::eUint16);
+}
+
+template<class Vtx>
+void Model<Vtx>::createBuffers(
+    uint32_t vertexCount,
+    const StagingRing::WriteFunction &writeVertices,
+    uint32_t indexCount,
+    const StagingRing::WriteFunction &writeIndices,
+    vk::IndexType indexType)
 {
-    uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
     assert(vertexCount >= 3 && "Vertex count must be at least 3");
+    assert(
+        (indexType == vk::IndexType::eUint32 || indexType == vk::IndexType::eUint16) &&
+        "Unsupported index type");
 
-    uint32_t vertexSize = sizeof(Vtx);
+    m_indexType = indexType;
+    const vk::DeviceSize indexSize = (indexType == vk::IndexType::eUint16) ? 2 : 4;
 
+    vk::Device device = m_base.getDevice();
     vk::PhysicalDeviceMemoryProperties memoryProperties = m_base.getMemoryProperties();
 
-    Buffer stagingBuffer{
-        m_base.getDevice(),
-        memoryProperties,
-        vertexCount,
-        vertexSize,
-        vk::BufferUsageFlagBits::eTransferSrc,
-        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
-    };
-
-    stagingBuffer.map();
-    stagingBuffer.writeToBuffer((void *)vertices.data());
+    const vk::DeviceSize vertexDataSize = vertexCount * sizeof(Vtx);
+    const vk::DeviceSize indexDataSize = indexCount * indexSize;
 
     m_vertexBuffer = std::make_unique<Buffer>(
-        m_base.getDevice(),
+        device,
         memoryProperties,
         vertexCount,
-        vertexSize,
+        sizeof(Vtx),
         vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst,
         vk::MemoryPropertyFlagBits::eDeviceLocal);
 
-    vk::CommandBuffer commandBuffer = tools::beginSingleTimeCommands(m_base);
-
-    vk::BufferCopy copyRegion{};
-    copyRegion.srcOffset = 0;
-    copyRegion.dstOffset = 0;
-    copyRegion.size = stagingBuffer.getBufferSize();
-    commandBuffer.copyBuffer(stagingBuffer.getBuffer(), m_vertexBuffer->getBuffer(), 1, &copyRegion);
-
-    tools::endSingleTimeCommands(m_base, commandBuffer);
-}
-
-template<class Vtx>
-void Model<Vtx>::createIndexBuffer(const std::vector<uint32_t> &indices)
-{
-    uint32_t indexCount = static_cast<uint32_t>(indices.size());
-    if (indexCount == 0) return;
+    if (indexCount > 0)
+    {
+        m_indexBuffer = std::make_unique<Buffer>(
+            device,
+            memoryProperties,
+            indexCount,
+            indexSize,
+            vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst,
+            vk::MemoryPropertyFlagBits::eDeviceLocal);
+    }
 
-    uint32_t indexSize = sizeof(indices[0]);
+    // Small meshes fit in a single slot, large ones are streamed in chunks
+    // through a bounded amount of staging memory
+    const vk::DeviceSize totalSize = tools::alignedVkSize(vertexDataSize, 16) + indexDataSize;
+    const vk::DeviceSize maxSlotSize = StagingRing::DEFAULT_CAPACITY / 4;
 
-    Buffer stagingBuffer{
-        m_base.getDevice(),
-        m_base.getMemoryProperties(),
-        indexCount,
-        indexSize,
-        vk::BufferUsageFlagBits::eTransferSrc,
-        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+    StagingRing stagingRing{
+        m_base,
+        std::min(totalSize, StagingRing::DEFAULT_CAPACITY),
+        totalSize <= maxSlotSize ? 1u : 4u
     };
 
-    stagingBuffer.map();
-    stagingBuffer.writeToBuffer((void *)indices.data());
-
-    m_indexBuffer = std::make_unique<Buffer>(
-        m_base.getDevice(),
-        m_base.getMemoryProperties(),
-        indexCount,
-        indexSize,
-        vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst,
-        vk::MemoryPropertyFlagBits::eDeviceLocal);
-
-    vk::CommandBuffer commandBuffer = tools::beginSingleTimeCommands(m_base);
-
-    vk::BufferCopy copyRegion{};
-    copyRegion.srcOffset = 0;
-    copyRegion.dstOffset = 0;
-    copyRegion.size = stagingBuffer.getBufferSize();
-    commandBuffer.copyBuffer(stagingBuffer.getBuffer(), m_indexBuffer->getBuffer(), 1, &copyRegion);
-
-    tools::endSingleTimeCommands(m_base, commandBuffer);
-}
\ No newline at end of file
+    stagingRing.upload(m_vertexBuffer->getBuffer(), sizeof(Vtx), vertexCount, writeVertices);
+    if (indexCount > 0)
+    {
+        stagingRing.upload(m_indexBuffer->getBuffer(), indexSize, indexCount, writeIndices);
+    }
+    stagingRing.flush();
+}
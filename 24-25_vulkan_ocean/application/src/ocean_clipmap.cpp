@@ -0,0 +1,94 @@
+#include "ocean_clipmap.hpp"
+
+OceanClipmap::OceanClipmap(VulkanBase &base, const ClipmapParams &params)
+    : m_params{ params }
+    , m_model{ base, params.cellCount }
+    , m_levels{}
+{
+    assert(params.levelCount >= 1 && "The clipmap needs at least one level");
+
+    m_levels.resize(params.levelCount);
+    update(glm::vec3(0.f));
+}
+
+float OceanClipmap::getCellSize(int level) const
+{
+    return m_params.baseCellSize * static_cast<float>(1 << level);
+}
+
+void OceanClipmap::update(const glm::vec3 &cameraPosition)
+{
+    const float halfCount = 0.5f * static_cast<float>(m_params.cellCount);
+
+    // Each level is snapped on a grid twice as large as its cells, so that its
+    // even vertices always match the vertices of the next level.
+    // snapped[l] is the level origin in units of 2 * cellSize(l).
+    std::vector<glm::dvec2> snapped(m_params.levelCount);
+    for (int l = 0; l < m_params.levelCount; l++)
+    {
+        double step = 2.0 * static_cast<double>(getCellSize(l));
+        snapped[l] = glm::floor(glm::dvec2(cameraPosition.x, cameraPosition.z) / step);
+    }
+
+    for (int l = 0; l < m_params.levelCount; l++)
+    {
+        float cellSize = getCellSize(l);
+        glm::vec2 origin = glm::vec2(snapped[l] * (2.0 * cellSize));
+
+        Level &level = m_levels[l];
+        level.model = glm::translate(
+            glm::mat4(1.f),
+            glm::vec3(origin.x - halfCount * cellSize, 0.f, origin.y - halfCount * cellSize));
+        level.model = glm::scale(level.model, glm::vec3(cellSize, 1.f, cellSize));
+
+        if (l == 0)
+        {
+            level.range = m_model.getGridRange();
+        }
+        else
+        {
+            // The finer level is offset by zero or one cell of this level
+            glm::dvec2 offset = snapped[l - 1] - 2.0 * snapped[l];
+            level.range = m_model.getRingRange(
+                static_cast<int>(offset.x), static_cast<int>(offset.y));
+        }
+    }
+}
+
+void OceanClipmap::draw(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout)
+{
+    OceanPushConstants constants{};
+    constants.grid = {
+        static_cast<float>(m_params.cellCount),
+        m_params.morphStart, m_params.morphEnd, 0.f
+    };
+
+    m_model.bind(commandBuffer);
+
+    for (const Level &level : m_levels)
+    {
+        constants.model = level.model;
+        commandBuffer.pushConstants(
+            pipelineLayout,
+            vk::ShaderStageFlagBits::eVertex |
+            vk::ShaderStageFlagBits::eFragment,
+            0, sizeof(OceanPushConstants), &constants);
+
+        m_model.draw(commandBuffer, level.range.firstIndex, level.range.indexCount);
+    }
+}
+
+uint32_t OceanClipmap::getTriangleCount() const
+{
+    uint32_t triangleCount = 0;
+    for (const Level &level : m_levels)
+    {
+        triangleCount += level.range.indexCount / 3;
+    }
+    return triangleCount;
+}
+
+float OceanClipmap::getExtent() const
+{
+    return static_cast<float>(m_params.cellCount) * getCellSize(m_params.levelCount - 1);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "ve.hpp"
+#include "model.hpp"
+
+struct OceanPushConstants
+{
+    /// Grid to world transform.
+    alignas(16) glm::mat4 model;
+    /// x = cells per side (0 disables the morphing),
+    /// y = morph start, z = morph end, as fractions of the level half size.
+    alignas(16) glm::vec4 grid;
+};
+
+struct ClipmapParams
+{
+    /// Cells per side of each level, must be a multiple of 4.
+    int cellCount = 128;
+    int levelCount = 6;
+    /// Cell size of the finest level, doubled at each level.
+    float baseCellSize = 0.05f;
+    float morphStart = 0.75f;
+    float morphEnd = 0.95f;
+};
+
+/// @brief Camera centered ocean surface made of nested square rings.
+/// Each level doubles the cell size of the previous one and fills the area
+/// around it, so the triangle count does not depend on the ocean extent.
+/// Vertices close to the outer edge of a level morph to the resolution of
+/// the next level to avoid cracks.
+class OceanClipmap
+{
+public:
+    OceanClipmap(VulkanBase &base, const ClipmapParams &params);
+
+    /// @brief Places the levels around the camera.
+    void update(const glm::vec3 &cameraPosition);
+
+    void draw(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout);
+
+    uint32_t getTriangleCount() const;
+    float getExtent() const;
+    const ClipmapParams &getParams() const { return m_params; }
+
+private:
+    struct Level
+    {
+        glm::mat4 model;
+        IndexRange range;
+    };
+
+    float getCellSize(int level) const;
+
+    ClipmapParams m_params;
+    ClipmapModel m_model;
+    std::vector<Level> m_levels;
+};
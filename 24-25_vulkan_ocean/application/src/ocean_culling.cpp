@@ -0,0 +1,218 @@
+#include "ocean_culling.hpp"
+
+OceanCulling::OceanCulling(
+    Framework &framework, TiledGridModel &model,
+    const vk::DescriptorBufferInfo &cameraInfo, bool multiDrawIndirect)
+    : margin{ 0.f }
+    , m_framework{ framework }
+    , m_model{ model }
+    , m_multiDrawIndirect{ multiDrawIndirect }
+    , m_frameCount{ framework.getRenderer().getFramesInFlight() }
+    , m_visibleTileCount{ 0 }
+    , m_setLayout{ VK_NULL_HANDLE }
+    , m_pipelineLayout{ VK_NULL_HANDLE }
+    , m_pipeline{ VK_NULL_HANDLE }
+    , m_descriptorSet{ VK_NULL_HANDLE }
+{
+    createBuffers();
+    createPipeline();
+    createDescriptorSet(cameraInfo);
+}
+
+OceanCulling::~OceanCulling()
+{
+    vk::Device device = m_framework.getDevice();
+
+    device.freeDescriptorSets(m_framework.getDescriptorPool(), m_descriptorSet);
+    device.destroyPipeline(m_pipeline);
+    device.destroyPipelineLayout(m_pipelineLayout);
+    device.destroyDescriptorSetLayout(m_setLayout);
+}
+
+void OceanCulling::record(vk::CommandBuffer commandBuffer, uint32_t cameraOffset, uint32_t frameIndex)
+{
+    assert(frameIndex < m_frameCount);
+    const uint32_t tileCount = getTileCount();
+
+    // The previous frame may still read the commands, and its atomic
+    // counter writes must land before the counter is cleared
+    vk::MemoryBarrier memoryBarrier{};
+    memoryBarrier.srcAccessMask = vk::AccessFlagBits::eShaderWrite;
+    memoryBarrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite | vk::AccessFlagBits::eShaderWrite;
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eComputeShader,
+        vk::DependencyFlags{}, memoryBarrier, nullptr, nullptr);
+
+    commandBuffer.fillBuffer(
+        m_statsBuffer->getBuffer(), frameIndex * sizeof(uint32_t), sizeof(uint32_t), 0);
+
+    memoryBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+    memoryBarrier.dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite;
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::DependencyFlags{}, memoryBarrier, nullptr, nullptr);
+
+    OceanCullingPushConstants constants{};
+    constants.margin = glm::vec4(margin, 0.f, 0.f);
+    constants.tileCount = tileCount;
+    constants.indexCount = m_model.getTileIndexCount();
+    constants.statsIndex = frameIndex;
+
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, m_pipeline);
+    commandBuffer.bindDescriptorSets(
+        vk::PipelineBindPoint::eCompute, m_pipelineLayout, 0,
+        m_descriptorSet, cameraOffset);
+    commandBuffer.pushConstants(
+        m_pipelineLayout, vk::ShaderStageFlagBits::eCompute,
+        0, sizeof(OceanCullingPushConstants), &constants);
+    commandBuffer.dispatch((tileCount + 63) / 64, 1, 1);
+
+    memoryBarrier.srcAccessMask = vk::AccessFlagBits::eShaderWrite;
+    memoryBarrier.dstAccessMask = vk::AccessFlagBits::eIndirectCommandRead;
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eDrawIndirect,
+        vk::DependencyFlags{}, memoryBarrier, nullptr, nullptr);
+
+    // The fence wait before readStats() only covers device accesses, the
+    // counter must also be made visible to the host domain
+    memoryBarrier.dstAccessMask = vk::AccessFlagBits::eHostRead;
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eHost,
+        vk::DependencyFlags{}, memoryBarrier, nullptr, nullptr);
+}
+
+void OceanCulling::draw(vk::CommandBuffer commandBuffer)
+{
+    const uint32_t tileCount = getTileCount();
+    const uint32_t stride = sizeof(vk::DrawIndexedIndirectCommand);
+
+    m_model.bind(commandBuffer);
+
+    if (m_multiDrawIndirect)
+    {
+        commandBuffer.drawIndexedIndirect(m_drawBuffer->getBuffer(), 0, tileCount, stride);
+    }
+    else
+    {
+        for (uint32_t i = 0; i < tileCount; i++)
+        {
+            commandBuffer.drawIndexedIndirect(m_drawBuffer->getBuffer(), i * stride, 1, stride);
+        }
+    }
+}
+
+void OceanCulling::readStats(uint32_t frameIndex)
+{
+    assert(frameIndex < m_frameCount);
+    m_visibleTileCount = static_cast<const uint32_t *>(m_statsBuffer->getMappedMemory())[frameIndex];
+}
+
+void OceanCulling::createBuffers()
+{
+    vk::Device device = m_framework.getDevice();
+    vk::PhysicalDeviceMemoryProperties memoryProperties = m_framework.getMemoryProperties();
+
+    const std::vector<GridTile> &tiles = m_model.getTiles();
+    const uint32_t tileCount = static_cast<uint32_t>(tiles.size());
+
+    std::vector<CullTile> cullTiles(tileCount);
+    for (uint32_t i = 0; i < tileCount; i++)
+    {
+        cullTiles[i].boundsMin = glm::vec4(tiles[i].boundsMin, 0.f);
+        cullTiles[i].boundsMax = glm::vec4(tiles[i].boundsMax, 0.f);
+        cullTiles[i].vertexOffset = tiles[i].vertexOffset;
+    }
+
+    m_tileBuffer = std::make_unique<Buffer>(
+        device, memoryProperties,
+        tileCount, sizeof(CullTile),
+        vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+        vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    m_drawBuffer = std::make_unique<Buffer>(
+        device, memoryProperties,
+        tileCount, sizeof(vk::DrawIndexedIndirectCommand),
+        vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer,
+        vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    m_statsBuffer = std::make_unique<Buffer>(
+        device, memoryProperties,
+        m_frameCount, sizeof(uint32_t),
+        vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+    m_statsBuffer->map();
+    memset(m_statsBuffer->getMappedMemory(), 0, m_frameCount * sizeof(uint32_t));
+
+    StagingRing stagingRing{ m_framework.getVulkanBase(), m_tileBuffer->getBufferSize(), 1 };
+    stagingRing.upload(m_tileBuffer->getBuffer(), cullTiles.data(), m_tileBuffer->getBufferSize());
+    stagingRing.flush();
+}
+
+void OceanCulling::createPipeline()
+{
+    vk::Device device = m_framework.getDevice();
+
+    m_setLayout =
+        DescriptorSetLayoutBuilder()
+        // [Binding 0] Camera
+        .addBinding(
+            0, vk::DescriptorType::eUniformBufferDynamic,
+            vk::ShaderStageFlagBits::eCompute)
+        // [Binding 1] Tiles
+        .addBinding(
+            1, vk::DescriptorType::eStorageBuffer,
+            vk::ShaderStageFlagBits::eCompute)
+        // [Binding 2] Indirect commands
+        .addBinding(
+            2, vk::DescriptorType::eStorageBuffer,
+            vk::ShaderStageFlagBits::eCompute)
+        // [Binding 3] Visible tile count of each frame slot
+        .addBinding(
+            3, vk::DescriptorType::eStorageBuffer,
+            vk::ShaderStageFlagBits::eCompute)
+        .build(device);
+
+    m_pipelineLayout =
+        PipelineLayoutBuilder()
+        .addDescriptorSetLayout(m_setLayout)
+        .addPushConstantRange(
+            vk::ShaderStageFlagBits::eCompute,
+            0, sizeof(OceanCullingPushConstants))
+        .build(device);
+
+    vk::PipelineShaderStageCreateInfo compStage = tools::loadShader(
+        device, "../shaders/ocean_cull.comp.spv", vk::ShaderStageFlagBits::eCompute);
+
+    m_pipeline = ComputePipelineBuilder(m_pipelineLayout, m_framework.getPipelineCache())
+        .setShaderStage(compStage)
+        .build(device);
+
+    device.destroyShaderModule(compStage.module);
+}
+
+void OceanCulling::createDescriptorSet(const vk::DescriptorBufferInfo &cameraInfo)
+{
+    vk::Device device = m_framework.getDevice();
+
+    m_descriptorSet =
+        DescriptorSetBuilder()
+        .addLayout(m_setLayout)
+        .build(device, m_framework.getDescriptorPool())[0];
+
+    vk::DescriptorBufferInfo cameraDynamicInfo = cameraInfo;
+    vk::DescriptorBufferInfo tileInfo = m_tileBuffer->getDescriptorInfo();
+    vk::DescriptorBufferInfo drawInfo = m_drawBuffer->getDescriptorInfo();
+    vk::DescriptorBufferInfo statsInfo = m_statsBuffer->getDescriptorInfo();
+
+    DescriptorSetUpdater()
+        .beginDescriptorSet(m_descriptorSet)
+        .addBuffer(0, vk::DescriptorType::eUniformBufferDynamic, &cameraDynamicInfo)
+        .addBuffer(1, vk::DescriptorType::eStorageBuffer, &tileInfo)
+        .addBuffer(2, vk::DescriptorType::eStorageBuffer, &drawInfo)
+        .addBuffer(3, vk::DescriptorType::eStorageBuffer, &statsInfo)
+        .update(device);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "ve.hpp"
+#include "model.hpp"
+
+/// Tile of the culling pass, std430 layout of ocean_cull.comp.
+struct CullTile
+{
+    alignas(16) glm::vec4 boundsMin;
+    alignas(16) glm::vec4 boundsMax;
+    int32_t vertexOffset;
+    int32_t padding[3];
+};
+
+struct OceanCullingPushConstants
+{
+    /// x = horizontal, y = vertical displacement bound.
+    alignas(16) glm::vec4 margin;
+    uint32_t tileCount;
+    uint32_t indexCount;
+    /// Counter of the frame slot in the stats buffer.
+    uint32_t statsIndex;
+};
+
+/// @brief GPU frustum culling of the tiles of a TiledGridModel.
+/// A compute pass tests the tile bounds, grown by the wave displacement,
+/// against the camera frustum and writes one indexed indirect command per
+/// tile, with no instance when the tile is culled.
+/// Each frame slot counts its visible tiles in its own counter, read back
+/// once the fence of the slot has signalled.
+class OceanCulling
+{
+public:
+    /// @param cameraInfo dynamic uniform buffer holding the CameraUniform.
+    /// @param multiDrawIndirect true if the feature is enabled on the
+    /// device, otherwise the tiles are drawn by one indirect draw each.
+    OceanCulling(
+        Framework &framework, TiledGridModel &model,
+        const vk::DescriptorBufferInfo &cameraInfo, bool multiDrawIndirect);
+    ~OceanCulling();
+
+    OceanCulling(const OceanCulling &) = delete;
+    OceanCulling &operator=(const OceanCulling &) = delete;
+
+    /// @brief Records the culling pass, must be called outside of a render pass.
+    /// @param cameraOffset dynamic offset of the camera of this frame.
+    /// @param frameIndex frame slot of the command buffer.
+    void record(vk::CommandBuffer commandBuffer, uint32_t cameraOffset, uint32_t frameIndex);
+
+    /// @brief Draws the visible tiles, with the ocean pipeline bound.
+    void draw(vk::CommandBuffer commandBuffer);
+
+    /// @brief Reads the visible tile count of the frame slot, must be
+    /// called once the fence of that slot has signalled.
+    void readStats(uint32_t frameIndex);
+
+    /// @brief Visible tile count of the last frame read by readStats().
+    uint32_t getVisibleTileCount() const { return m_visibleTileCount; }
+    uint32_t getTileCount() const { return static_cast<uint32_t>(m_model.getTiles().size()); }
+
+    /// Displacement bound, x = horizontal, y = vertical.
+    glm::vec2 margin;
+
+private:
+    void createBuffers();
+    void createPipeline();
+    void createDescriptorSet(const vk::DescriptorBufferInfo &cameraInfo);
+
+    Framework &m_framework;
+    TiledGridModel &m_model;
+    bool m_multiDrawIndirect;
+    uint32_t m_frameCount;
+    uint32_t m_visibleTileCount;
+
+    std::unique_ptr<Buffer> m_tileBuffer;
+    std::unique_ptr<Buffer> m_drawBuffer;
+    std::unique_ptr<Buffer> m_statsBuffer;
+
+    vk::DescriptorSetLayout m_setLayout;
+    vk::PipelineLayout m_pipelineLayout;
+    vk::Pipeline m_pipeline;
+    vk::DescriptorSet m_descriptorSet;
+};
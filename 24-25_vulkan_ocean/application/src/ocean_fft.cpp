@@ -0,0 +1,279 @@
+#include "ocean_fft.hpp"
+
+namespace
+{
+    void computeBarrier(
+        vk::CommandBuffer commandBuffer,
+        vk::PipelineStageFlags srcStageMask,
+        vk::PipelineStageFlags dstStageMask,
+        vk::AccessFlags srcAccessMask,
+        vk::AccessFlags dstAccessMask)
+    {
+        vk::MemoryBarrier memoryBarrier{};
+        memoryBarrier.srcAccessMask = srcAccessMask;
+        memoryBarrier.dstAccessMask = dstAccessMask;
+
+        vk::DependencyFlags dependencyFlags{};
+        auto bufferMemoryBarriers = nullptr;
+        auto imageMemoryBarriers = nullptr;
+
+        commandBuffer.pipelineBarrier(
+            srcStageMask,
+            dstStageMask,
+            dependencyFlags,
+            memoryBarrier,
+            bufferMemoryBarriers,
+            imageMemoryBarriers);
+    }
+}
+
+OceanFFT::OceanFFT(Framework &framework, const OceanSpectrumParams &params)
+    : m_framework{ framework }
+    , m_spectrum{ params }
+    , m_size{ params.size }
+    , m_maxDisplacement{ 0.f }
+    , choppiness{ params.choppiness }
+    , m_setLayout{ VK_NULL_HANDLE }
+    , m_pipelineLayout{ VK_NULL_HANDLE }
+    , m_descriptorSet{ VK_NULL_HANDLE }
+    , m_spectrumPipeline{ VK_NULL_HANDLE }
+    , m_fftPipeline{ VK_NULL_HANDLE }
+    , m_resolvePipeline{ VK_NULL_HANDLE }
+{
+    m_maxDisplacement = m_spectrum.estimateMaxDisplacement();
+
+    createImages();
+    createSetLayout();
+    createPipelines();
+    createDescriptorSet();
+}
+
+OceanFFT::~OceanFFT()
+{
+    vk::Device device = m_framework.getDevice();
+
+    device.freeDescriptorSets(m_framework.getDescriptorPool(), m_descriptorSet);
+    device.destroyPipeline(m_spectrumPipeline);
+    device.destroyPipeline(m_fftPipeline);
+    device.destroyPipeline(m_resolvePipeline);
+    device.destroyPipelineLayout(m_pipelineLayout);
+    device.destroyDescriptorSetLayout(m_setLayout);
+}
+
+void OceanFFT::record(vk::CommandBuffer commandBuffer, float time)
+{
+    const uint32_t groupCount = m_size / 16;
+
+    OceanFFTPushConstants constants{};
+    constants.time = time;
+    constants.patchSize = m_spectrum.getParams().patchSize;
+    constants.choppiness = choppiness;
+    constants.direction = 0;
+
+    // The previous frame may still sample the maps, ocean.tese included
+    computeBarrier(
+        commandBuffer,
+        vk::PipelineStageFlagBits::eVertexShader |
+        vk::PipelineStageFlagBits::eTessellationEvaluationShader |
+        vk::PipelineStageFlagBits::eFragmentShader,
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::AccessFlagBits::eNone,
+        vk::AccessFlagBits::eNone);
+
+    commandBuffer.bindDescriptorSets(
+        vk::PipelineBindPoint::eCompute, m_pipelineLayout, 0, m_descriptorSet, nullptr);
+
+    // h(k, t)
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, m_spectrumPipeline);
+    commandBuffer.pushConstants(
+        m_pipelineLayout, vk::ShaderStageFlagBits::eCompute,
+        0, sizeof(OceanFFTPushConstants), &constants);
+    commandBuffer.dispatch(groupCount, groupCount, 1);
+
+    // Inverse FFT on the rows then on the columns, one workgroup per line
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, m_fftPipeline);
+    for (uint32_t direction = 0; direction < 2; direction++)
+    {
+        computeBarrier(
+            commandBuffer,
+            vk::PipelineStageFlagBits::eComputeShader,
+            vk::PipelineStageFlagBits::eComputeShader,
+            vk::AccessFlagBits::eShaderWrite,
+            vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+
+        constants.direction = direction;
+        commandBuffer.pushConstants(
+            m_pipelineLayout, vk::ShaderStageFlagBits::eCompute,
+            0, sizeof(OceanFFTPushConstants), &constants);
+        commandBuffer.dispatch(1, m_size, 1);
+    }
+
+    computeBarrier(
+        commandBuffer,
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::AccessFlagBits::eShaderWrite,
+        vk::AccessFlagBits::eShaderRead);
+
+    // Displacement and normal maps
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, m_resolvePipeline);
+    commandBuffer.dispatch(groupCount, groupCount, 1);
+
+    computeBarrier(
+        commandBuffer,
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eVertexShader |
+        vk::PipelineStageFlagBits::eTessellationEvaluationShader |
+        vk::PipelineStageFlagBits::eFragmentShader,
+        vk::AccessFlagBits::eShaderWrite,
+        vk::AccessFlagBits::eShaderRead);
+}
+
+void OceanFFT::createImages()
+{
+    vk::Device device = m_framework.getDevice();
+    vk::PhysicalDeviceMemoryProperties memoryProperties = m_framework.getMemoryProperties();
+    vk::CommandPool commandPool = m_framework.getCommandPool();
+    vk::Queue queue = m_framework.getGraphicsQueue();
+
+    // Initial spectrum, read with texelFetch
+    vk::ImageCreateInfo h0CI = Image::defaultCreateInfo2D(
+        m_size, m_size, vk::Format::eR32G32B32A32Sfloat);
+
+    m_h0Image = std::make_unique<Image>(
+        device, memoryProperties, h0CI,
+        vk::ImageViewType::e2D, vk::ImageAspectFlagBits::eColor, false);
+
+    SamplerBuilder nearestSampler;
+    m_h0Image->createTextureSampler(nearestSampler);
+
+    const std::vector<glm::vec4> &h0 = m_spectrum.getInitialSpectrum();
+    m_h0Image->upload(
+        h0.data(), h0.size() * sizeof(glm::vec4),
+        commandPool, memoryProperties, queue,
+        vk::ImageLayout::eShaderReadOnlyOptimal, false);
+
+    // Spectra
+    vk::ImageCreateInfo spectrumCI = Image::defaultCreateInfo2D(
+        m_size, m_size, vk::Format::eR32G32B32A32Sfloat);
+    spectrumCI.usage = vk::ImageUsageFlagBits::eStorage;
+
+    for (auto &spectrumImage : m_spectrumImages)
+    {
+        spectrumImage = std::make_unique<Image>(
+            device, memoryProperties, spectrumCI,
+            vk::ImageViewType::e2D, vk::ImageAspectFlagBits::eColor, false);
+    }
+
+    // Maps, half floats support linear filtering everywhere
+    vk::ImageCreateInfo mapCI = Image::defaultCreateInfo2D(
+        m_size, m_size, vk::Format::eR16G16B16A16Sfloat);
+    mapCI.usage = vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled;
+
+    m_displacementImage = std::make_unique<Image>(
+        device, memoryProperties, mapCI,
+        vk::ImageViewType::e2D, vk::ImageAspectFlagBits::eColor, false);
+    m_normalImage = std::make_unique<Image>(
+        device, memoryProperties, mapCI,
+        vk::ImageViewType::e2D, vk::ImageAspectFlagBits::eColor, false);
+
+    SamplerBuilder repeatSampler;
+    repeatSampler
+        .setLinear()
+        .setAddressMode(vk::SamplerAddressMode::eRepeat);
+    m_displacementImage->createTextureSampler(repeatSampler);
+    m_normalImage->createTextureSampler(repeatSampler);
+
+    // Storage images stay in the general layout
+    vk::CommandBuffer commandBuffer = tools::beginSingleTimeCommands(device, commandPool);
+    m_spectrumImages[0]->transitionLayout(commandBuffer, vk::ImageLayout::eGeneral);
+    m_spectrumImages[1]->transitionLayout(commandBuffer, vk::ImageLayout::eGeneral);
+    m_displacementImage->transitionLayout(commandBuffer, vk::ImageLayout::eGeneral);
+    m_normalImage->transitionLayout(commandBuffer, vk::ImageLayout::eGeneral);
+    tools::endSingleTimeCommands(device, queue, commandPool, commandBuffer);
+}
+
+void OceanFFT::createSetLayout()
+{
+    vk::Device device = m_framework.getDevice();
+
+    m_setLayout =
+        DescriptorSetLayoutBuilder()
+        // [Binding 0] Initial spectrum
+        .addBinding(
+            0, vk::DescriptorType::eCombinedImageSampler,
+            vk::ShaderStageFlagBits::eCompute)
+        // [Binding 1-2] Spectra
+        .addBinding(
+            1, vk::DescriptorType::eStorageImage,
+            vk::ShaderStageFlagBits::eCompute)
+        .addBinding(
+            2, vk::DescriptorType::eStorageImage,
+            vk::ShaderStageFlagBits::eCompute)
+        // [Binding 3] Displacement map
+        .addBinding(
+            3, vk::DescriptorType::eStorageImage,
+            vk::ShaderStageFlagBits::eCompute)
+        // [Binding 4] Normal map
+        .addBinding(
+            4, vk::DescriptorType::eStorageImage,
+            vk::ShaderStageFlagBits::eCompute)
+        .build(device);
+
+    m_pipelineLayout =
+        PipelineLayoutBuilder()
+        .addDescriptorSetLayout(m_setLayout)
+        .addPushConstantRange(
+            vk::ShaderStageFlagBits::eCompute,
+            0, sizeof(OceanFFTPushConstants))
+        .build(device);
+}
+
+void OceanFFT::createPipelines()
+{
+    vk::Device device = m_framework.getDevice();
+    vk::PipelineCache pipelineCache = m_framework.getPipelineCache();
+
+    const std::array<std::pair<const char *, vk::Pipeline *>, 3> pipelines = { {
+        { "../shaders/ocean_spectrum.comp.spv", &m_spectrumPipeline },
+        { "../shaders/ocean_fft.comp.spv", &m_fftPipeline },
+        { "../shaders/ocean_resolve.comp.spv", &m_resolvePipeline },
+    } };
+
+    for (const auto &[filename, pipeline] : pipelines)
+    {
+        vk::PipelineShaderStageCreateInfo compStage = tools::loadShader(
+            device, filename, vk::ShaderStageFlagBits::eCompute);
+
+        *pipeline = ComputePipelineBuilder(m_pipelineLayout, pipelineCache)
+            .setShaderStage(compStage)
+            .build(device);
+
+        device.destroyShaderModule(compStage.module);
+    }
+}
+
+void OceanFFT::createDescriptorSet()
+{
+    vk::Device device = m_framework.getDevice();
+
+    m_descriptorSet =
+        DescriptorSetBuilder()
+        .addLayout(m_setLayout)
+        .build(device, m_framework.getDescriptorPool())[0];
+
+    vk::DescriptorImageInfo h0Info = m_h0Image->getDescriptorInfo();
+    vk::DescriptorImageInfo spectrumInfo0 = m_spectrumImages[0]->getDescriptorInfo();
+    vk::DescriptorImageInfo spectrumInfo1 = m_spectrumImages[1]->getDescriptorInfo();
+    vk::DescriptorImageInfo displacementInfo = m_displacementImage->getDescriptorInfo();
+    vk::DescriptorImageInfo normalInfo = m_normalImage->getDescriptorInfo();
+
+    DescriptorSetUpdater()
+        .beginDescriptorSet(m_descriptorSet)
+        .addImage(0, vk::DescriptorType::eCombinedImageSampler, &h0Info)
+        .addImage(1, vk::DescriptorType::eStorageImage, &spectrumInfo0)
+        .addImage(2, vk::DescriptorType::eStorageImage, &spectrumInfo1)
+        .addImage(3, vk::DescriptorType::eStorageImage, &displacementInfo)
+        .addImage(4, vk::DescriptorType::eStorageImage, &normalInfo)
+        .update(device);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "ve.hpp"
+#include "ocean_spectrum.hpp"
+
+struct OceanFFTPushConstants
+{
+    float time;
+    float patchSize;
+    float choppiness;
+    uint32_t direction; // 0 = rows, 1 = columns
+};
+
+/// @brief GPU ocean simulation.
+/// Evolves the spectrum and runs the inverse FFT in compute shaders once per
+/// frame, producing a displacement map and a normal map sampled by the
+/// ocean shaders.
+class OceanFFT
+{
+public:
+    OceanFFT(Framework &framework, const OceanSpectrumParams &params);
+    ~OceanFFT();
+
+    OceanFFT(const OceanFFT &) = delete;
+    OceanFFT &operator=(const OceanFFT &) = delete;
+
+    /// @brief Records the simulation passes, must be called outside of a render pass.
+    void record(vk::CommandBuffer commandBuffer, float time);
+
+    vk::DescriptorImageInfo getDisplacementInfo() const { return m_displacementImage->getDescriptorInfo(); }
+    vk::DescriptorImageInfo getNormalInfo() const { return m_normalImage->getDescriptorInfo(); }
+
+    const OceanSpectrum &getSpectrum() const { return m_spectrum; }
+    float getPatchSize() const { return m_spectrum.getParams().patchSize; }
+
+    /// @brief Displacement bound, x = horizontal for a choppiness of 1,
+    /// y = vertical.
+    glm::vec2 getMaxDisplacement() const { return m_maxDisplacement; }
+
+    float choppiness;
+
+private:
+    void createImages();
+    void createSetLayout();
+    void createPipelines();
+    void createDescriptorSet();
+
+    Framework &m_framework;
+    OceanSpectrum m_spectrum;
+    uint32_t m_size;
+    glm::vec2 m_maxDisplacement;
+
+    // xy = h0(k), zw = conj(h0(-k))
+    std::unique_ptr<Image> m_h0Image;
+    // Packed complex spectra, transformed in place
+    std::unique_ptr<Image> m_spectrumImages[2];
+    // Results sampled by the ocean shaders
+    std::unique_ptr<Image> m_displacementImage;
+    std::unique_ptr<Image> m_normalImage;
+
+    vk::DescriptorSetLayout m_setLayout;
+    vk::PipelineLayout m_pipelineLayout;
+    vk::DescriptorSet m_descriptorSet;
+
+    vk::Pipeline m_spectrumPipeline;
+    vk::Pipeline m_fftPipeline;
+    vk::Pipeline m_resolvePipeline;
+};
@@ -0,0 +1,173 @@
+#include "ocean_spectrum.hpp"
+
+#include <random>
+
+#define GRAVITY 9.81f
+#define TAU 6.283185307179586476925286766559f
+
+OceanSpectrum::OceanSpectrum(const OceanSpectrumParams &params)
+    : m_params{ params }
+    , m_h0{}
+{
+    assert(fft::isPowerOfTwo(params.size) && "The spectrum size must be a power of two");
+
+    const uint32_t n = m_params.size;
+
+    std::mt19937 generator(m_params.seed);
+    std::normal_distribution<float> gaussian(0.f, 1.f);
+
+    std::vector<std::complex<float>> h0(n * n);
+    for (uint32_t m = 0; m < n; m++)
+    {
+        for (uint32_t i = 0; i < n; i++)
+        {
+            float xiR = gaussian(generator);
+            float xiI = gaussian(generator);
+            float amplitude = sqrtf(0.5f * phillips(getWaveVector(i, m)));
+            h0[m * n + i] = amplitude * std::complex<float>(xiR, xiI);
+        }
+    }
+
+    m_h0.resize(n * n);
+    for (uint32_t m = 0; m < n; m++)
+    {
+        for (uint32_t i = 0; i < n; i++)
+        {
+            // -k is stored at (N - n, N - m)
+            std::complex<float> hk = h0[m * n + i];
+            std::complex<float> hMinusK = std::conj(h0[((n - m) % n) * n + (n - i) % n]);
+            m_h0[m * n + i] = { hk.real(), hk.imag(), hMinusK.real(), hMinusK.imag() };
+        }
+    }
+}
+
+void OceanSpectrum::setInitialSpectrum(const std::vector<glm::vec4> &h0)
+{
+    assert(h0.size() == m_h0.size() && "The spectrum must have size x size texels");
+    m_h0 = h0;
+}
+
+glm::vec2 OceanSpectrum::getWaveVector(uint32_t n, uint32_t m) const
+{
+    float half = 0.5f * static_cast<float>(m_params.size);
+    return TAU / m_params.patchSize * glm::vec2(
+        static_cast<float>(n) - half,
+        static_cast<float>(m) - half);
+}
+
+float OceanSpectrum::phillips(glm::vec2 k) const
+{
+    float kLength2 = glm::dot(k, k);
+    if (kLength2 < 1e-12f) return 0.f;
+
+    float largestWave = m_params.windSpeed * m_params.windSpeed / GRAVITY;
+    float kDotW = glm::dot(k, glm::normalize(m_params.windDirection));
+    float kDotW2 = kDotW * kDotW / kLength2;
+
+    float damping = expf(-kLength2 * m_params.smallWaveLength * m_params.smallWaveLength);
+
+    return m_params.amplitude
+        * expf(-1.f / (kLength2 * largestWave * largestWave))
+        / (kLength2 * kLength2)
+        * kDotW2 * damping;
+}
+
+void OceanSpectrum::evaluate(
+    float time,
+    std::vector<glm::vec4> &displacements,
+    std::vector<glm::vec4> &normals) const
+{
+    evaluate(time, displacements, normals, m_params.choppiness);
+}
+
+void OceanSpectrum::evaluate(
+    float time,
+    std::vector<glm::vec4> &displacements,
+    std::vector<glm::vec4> &normals,
+    float choppiness) const
+{
+    const uint32_t n = m_params.size;
+    const uint32_t count = n * n;
+
+    // Same packing as ocean_spectrum.comp:
+    // c0 = h + i.dx, c1 = dz + i.sx, c2 = sz
+    std::vector<std::complex<float>> c0(count), c1(count), c2(count);
+    const std::complex<float> i1(0.f, 1.f);
+
+    for (uint32_t m = 0; m < n; m++)
+    {
+        for (uint32_t i = 0; i < n; i++)
+        {
+            const glm::vec4 &h0 = m_h0[m * n + i];
+            glm::vec2 k = getWaveVector(i, m);
+            float kLength = glm::length(k);
+            float omega = sqrtf(GRAVITY * kLength);
+
+            std::complex<float> e = std::polar(1.f, omega * time);
+            std::complex<float> h =
+                std::complex<float>(h0.x, h0.y) * e +
+                std::complex<float>(h0.z, h0.w) * std::conj(e);
+
+            glm::vec2 kn = kLength > 1e-6f ? k / kLength : glm::vec2(0.f);
+            std::complex<float> dx = -i1 * kn.x * h;
+            std::complex<float> dz = -i1 * kn.y * h;
+            std::complex<float> sx = i1 * k.x * h;
+            std::complex<float> sz = i1 * k.y * h;
+
+            c0[m * n + i] = h + i1 * dx;
+            c1[m * n + i] = dz + i1 * sx;
+            c2[m * n + i] = sz;
+        }
+    }
+
+    fft::transform2D(c0, n, true);
+    fft::transform2D(c1, n, true);
+    fft::transform2D(c2, n, true);
+
+    // Same resolve as ocean_resolve.comp
+    displacements.resize(count);
+    normals.resize(count);
+    for (uint32_t m = 0; m < n; m++)
+    {
+        for (uint32_t i = 0; i < n; i++)
+        {
+            uint32_t index = m * n + i;
+            float sign = ((i + m) & 1) == 0 ? 1.f : -1.f;
+
+            float height = sign * c0[index].real();
+            float dx = sign * c0[index].imag();
+            float dz = sign * c1[index].real();
+            float sx = sign * c1[index].imag();
+            float sz = sign * c2[index].real();
+
+            displacements[index] = {
+                -choppiness * dx, height, -choppiness * dz, 0.f
+            };
+            glm::vec3 normal = glm::normalize(glm::vec3(-sx, 1.f, -sz));
+            normals[index] = { normal.x, normal.y, normal.z, 0.f };
+        }
+    }
+}
+
+glm::vec2 OceanSpectrum::estimateMaxDisplacement() const
+{
+    // The waves are random, sample a few unrelated times
+    const float times[] = { 0.f, 2.3f, 5.9f, 11.1f };
+    const float safetyFactor = 1.5f;
+
+    std::vector<glm::vec4> displacements{};
+    std::vector<glm::vec4> normals{};
+    glm::vec2 maxDisplacement(0.f);
+
+    for (float time : times)
+    {
+        evaluate(time, displacements, normals, 1.f);
+        for (const glm::vec4 &d : displacements)
+        {
+            maxDisplacement.x = std::max(maxDisplacement.x, glm::length(glm::vec2(d.x, d.z)));
+            maxDisplacement.y = std::max(maxDisplacement.y, fabsf(d.y));
+        }
+    }
+
+    return safetyFactor * maxDisplacement;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "ve.hpp"
+
+#include <complex>
+
+struct OceanSpectrumParams
+{
+    /// Resolution of the FFT grid, must match N in the ocean compute shaders.
+    uint32_t size = 256;
+    /// World size of the tiled ocean patch.
+    float patchSize = 20.f;
+    float windSpeed = 4.f;
+    glm::vec2 windDirection = { 1.f, 0.5f };
+    /// Phillips spectrum constant.
+    float amplitude = 3e-5f;
+    /// Waves shorter than this length are damped.
+    float smallWaveLength = 0.02f;
+    /// Horizontal displacement factor of the choppy waves.
+    float choppiness = 1.f;
+    uint32_t seed = 1;
+};
+
+/// @brief Tessendorf ocean spectrum.
+/// Generates the Phillips initial spectrum uploaded to the GPU and evaluates
+/// the same height field on the CPU to check the compute path.
+class OceanSpectrum
+{
+public:
+    OceanSpectrum(const OceanSpectrumParams &params);
+
+    const OceanSpectrumParams &getParams() const { return m_params; }
+
+    /// @brief Initial spectrum, xy = h0(k), zw = conj(h0(-k)).
+    /// Texel (n, m) holds the wave vector 2 pi (n - N/2, m - N/2) / patchSize.
+    const std::vector<glm::vec4> &getInitialSpectrum() const { return m_h0; }
+
+    /// @brief Replaces the random initial spectrum, same layout as
+    /// getInitialSpectrum(). Used to evaluate a known set of waves.
+    void setInitialSpectrum(const std::vector<glm::vec4> &h0);
+
+    /// @brief CPU reference of the compute passes.
+    /// @param time the simulation time in seconds.
+    /// @param displacements xyz = displacement of the grid points.
+    /// @param normals xyz = surface normal of the grid points.
+    void evaluate(
+        float time,
+        std::vector<glm::vec4> &displacements,
+        std::vector<glm::vec4> &normals) const;
+    void evaluate(
+        float time,
+        std::vector<glm::vec4> &displacements,
+        std::vector<glm::vec4> &normals,
+        float choppiness) const;
+
+    /// @brief Bound of the surface displacement, from the maximum over a few
+    /// simulation times with a safety factor.
+    /// @return x = horizontal displacement for a choppiness of 1,
+    /// y = vertical displacement.
+    glm::vec2 estimateMaxDisplacement() const;
+
+    glm::vec2 getWaveVector(uint32_t n, uint32_t m) const;
+
+private:
+    float phillips(glm::vec2 k) const;
+
+    OceanSpectrumParams m_params;
+    std::vector<glm::vec4> m_h0;
+};
@@ -0,0 +1,65 @@
+#include "ocean_tessellation.hpp"
+
+OceanTessellation::OceanTessellation(VulkanBase &base, const TessellationParams &params)
+    : params{ params }
+    , m_model{ base, params.patchCount }
+    , m_modelMatrix{ 1.f }
+{
+    update(glm::vec3(0.f));
+}
+
+void OceanTessellation::update(const glm::vec3 &cameraPosition)
+{
+    const float patchSize = params.patchSize;
+    const float halfCount = 0.5f * static_cast<float>(m_model.getPatchCount());
+
+    // Snapped on the patches so that the vertices do not swim
+    glm::vec2 origin = patchSize * glm::floor(
+        glm::vec2(cameraPosition.x, cameraPosition.z) / patchSize);
+
+    m_modelMatrix = glm::translate(
+        glm::mat4(1.f),
+        glm::vec3(origin.x - halfCount * patchSize, 0.f, origin.y - halfCount * patchSize));
+    m_modelMatrix = glm::scale(m_modelMatrix, glm::vec3(patchSize, 1.f, patchSize));
+}
+
+void OceanTessellation::draw(
+    vk::CommandBuffer commandBuffer,
+    vk::PipelineLayout pipelineLayout,
+    vk::Extent2D extent)
+{
+    OceanPushConstants constants{};
+    constants.model = m_modelMatrix;
+    constants.grid = glm::vec4(0.f);
+
+    OceanTessellationPushConstants tessConstants{};
+    tessConstants.tessellation = {
+        params.targetEdgeLength,
+        static_cast<float>(extent.height),
+        params.maxLevel,
+        params.maxDisplacement
+    };
+
+    commandBuffer.pushConstants(
+        pipelineLayout,
+        vk::ShaderStageFlagBits::eVertex |
+        vk::ShaderStageFlagBits::eFragment,
+        0, sizeof(OceanPushConstants), &constants);
+    commandBuffer.pushConstants(
+        pipelineLayout,
+        vk::ShaderStageFlagBits::eTessellationControl,
+        sizeof(OceanPushConstants), sizeof(OceanTessellationPushConstants), &tessConstants);
+
+    m_model.bind(commandBuffer);
+    m_model.draw(commandBuffer);
+}
+
+uint32_t OceanTessellation::getPatchCount() const
+{
+    return static_cast<uint32_t>(m_model.getPatchCount() * m_model.getPatchCount());
+}
+
+float OceanTessellation::getExtent() const
+{
+    return static_cast<float>(m_model.getPatchCount()) * params.patchSize;
+}
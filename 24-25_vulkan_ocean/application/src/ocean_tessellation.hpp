@@ -0,0 +1,55 @@
+#pragma once
+
+#include "ve.hpp"
+#include "model.hpp"
+#include "ocean_clipmap.hpp"
+
+/// Pushed after OceanPushConstants, read by the tessellation control shader.
+struct OceanTessellationPushConstants
+{
+    /// x = target edge length in pixels, y = viewport height in pixels,
+    /// z = max tessellation level, w = max displacement of the surface.
+    alignas(16) glm::vec4 tessellation;
+};
+
+struct TessellationParams
+{
+    /// Patches per side of the grid.
+    int patchCount = 64;
+    /// World size of a patch.
+    float patchSize = 1.6f;
+    /// Length in pixels of the generated triangle edges.
+    float targetEdgeLength = 12.f;
+    /// Must not exceed maxTessellationGenerationLevel, 64 is always supported.
+    float maxLevel = 64.f;
+    /// Margin added to the patch bounds before culling them, set each frame
+    /// from the displacement bound of the waves.
+    float maxDisplacement = 1.f;
+};
+
+/// @brief Camera centered grid of coarse patches refined by the tessellator.
+/// Each patch edge is subdivided according to its projected length, so the
+/// density of triangles stays roughly constant on screen. The control
+/// shader discards the patches outside of the view frustum.
+class OceanTessellation
+{
+public:
+    OceanTessellation(VulkanBase &base, const TessellationParams &params);
+
+    /// @brief Places the grid around the camera.
+    void update(const glm::vec3 &cameraPosition);
+
+    void draw(
+        vk::CommandBuffer commandBuffer,
+        vk::PipelineLayout pipelineLayout,
+        vk::Extent2D extent);
+
+    uint32_t getPatchCount() const;
+    float getExtent() const;
+
+    TessellationParams params;
+
+private:
+    PatchGridModel m_model;
+    glm::mat4 m_modelMatrix;
+};
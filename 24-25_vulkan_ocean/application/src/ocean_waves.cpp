@@ -0,0 +1,113 @@
+#include "ocean_waves.hpp"
+
+#include <random>
+
+namespace
+{
+    constexpr float PI = 3.14159265358979f;
+
+    /// Wavelengths of the generated waves, in meters.
+    constexpr float MAX_WAVELENGTH = 16.f;
+    constexpr float MIN_WAVELENGTH = 0.4f;
+    /// Sum of the steepness of the generated waves, below 1 to avoid loops.
+    constexpr float TOTAL_STEEPNESS = 0.6f;
+    /// Spread of the directions around the wind, in degrees.
+    constexpr float DIRECTION_SPREAD = 45.f;
+}
+
+OceanWaves::OceanWaves(VulkanBase &base, uint32_t frameCount)
+    : m_buffer{}
+    , m_mapped{ nullptr }
+    , m_waves{}
+    , m_version{ 1 }
+    , m_regionVersions(frameCount, 0)
+{
+    assert(frameCount > 0);
+
+    m_buffer = std::make_unique<Buffer>(
+        base.getDevice(),
+        base.getMemoryProperties(),
+        frameCount,
+        MAX_WAVE_COUNT * sizeof(GerstnerWave),
+        vk::BufferUsageFlagBits::eStorageBuffer,
+        vk::MemoryPropertyFlagBits::eHostVisible |
+        vk::MemoryPropertyFlagBits::eHostCoherent,
+        base.getProperties().limits.minStorageBufferOffsetAlignment);
+    m_buffer->map();
+    m_mapped = static_cast<uint8_t *>(m_buffer->getMappedMemory());
+
+    generate(4);
+}
+
+void OceanWaves::generate(uint32_t count, float windAngle, uint32_t seed)
+{
+    count = std::clamp(count, 1u, MAX_WAVE_COUNT);
+
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> spread(-DIRECTION_SPREAD, DIRECTION_SPREAD);
+    std::uniform_real_distribution<float> phase(0.f, 2.f * PI);
+
+    // Geometric series of wavelengths, the same steepness for every wave
+    const float ratio = (count > 1)
+        ? powf(MIN_WAVELENGTH / MAX_WAVELENGTH, 1.f / static_cast<float>(count - 1))
+        : 1.f;
+
+    m_waves.resize(count);
+    float wavelength = MAX_WAVELENGTH;
+    for (GerstnerWave &wave : m_waves)
+    {
+        const float angle = (windAngle + spread(generator)) * PI / 180.f;
+        wave.direction = glm::vec2(cosf(angle), sinf(angle));
+        wave.steepness = TOTAL_STEEPNESS / static_cast<float>(count);
+        wave.wavelength = wavelength;
+        wave.phase = phase(generator);
+        wave.padding = 0.f;
+        wavelength *= ratio;
+    }
+    m_version++;
+}
+
+void OceanWaves::setWaves(const std::vector<GerstnerWave> &waves)
+{
+    assert(waves.empty() == false && waves.size() <= MAX_WAVE_COUNT);
+    m_waves = waves;
+    m_version++;
+}
+
+void OceanWaves::setWave(uint32_t index, const GerstnerWave &wave)
+{
+    assert(index < m_waves.size());
+    m_waves[index] = wave;
+    m_waves[index].direction = glm::normalize(wave.direction);
+    m_version++;
+}
+
+glm::vec2 OceanWaves::getMaxDisplacement() const
+{
+    // Amplitude of a wave = steepness / wave number
+    float amplitude = 0.f;
+    for (const GerstnerWave &wave : m_waves)
+    {
+        amplitude += wave.steepness * wave.wavelength / (2.f * PI);
+    }
+    return glm::vec2(amplitude, amplitude);
+}
+
+uint32_t OceanWaves::update(uint32_t frameIndex)
+{
+    assert(frameIndex < m_regionVersions.size());
+
+    const vk::DeviceSize offset = frameIndex * m_buffer->getAlignmentSize();
+    if (m_regionVersions[frameIndex] != m_version)
+    {
+        memcpy(m_mapped + offset, m_waves.data(), m_waves.size() * sizeof(GerstnerWave));
+        m_regionVersions[frameIndex] = m_version;
+    }
+    return static_cast<uint32_t>(offset);
+}
+
+vk::DescriptorBufferInfo OceanWaves::getDescriptorInfo() const
+{
+    return vk::DescriptorBufferInfo{
+        m_buffer->getBuffer(), 0, MAX_WAVE_COUNT * sizeof(GerstnerWave) };
+}
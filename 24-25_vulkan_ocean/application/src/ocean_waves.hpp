@@ -0,0 +1,68 @@
+#pragma once
+
+#include "ve.hpp"
+
+/// Gerstner wave, std430 layout of ocean_waves.glsl.
+struct GerstnerWave
+{
+    /// Direction of propagation, normalized.
+    glm::vec2 direction;
+    /// Wave number times amplitude, in [0, 1]. The crests loop when the
+    /// sum over the waves exceeds 1.
+    float steepness;
+    /// Distance between two crests, in meters.
+    float wavelength;
+    /// Phase at time 0, in radians.
+    float phase;
+    float padding;
+};
+static_assert(sizeof(GerstnerWave) == 24, "std430 array stride of GerstnerWave");
+
+/// @brief Sum of Gerstner waves, evaluated by the ocean shaders instead of
+/// the FFT displacement when ParametersUniform::waveCount is not 0.
+/// The waves live in a host visible storage buffer with one region per
+/// frame in flight, bound with a dynamic offset. An edit is copied to the
+/// region of each frame when that frame is recorded, so the frames in
+/// flight keep reading their own copy.
+class OceanWaves
+{
+public:
+    static constexpr uint32_t MAX_WAVE_COUNT = 256;
+
+    OceanWaves(VulkanBase &base, uint32_t frameCount);
+
+    OceanWaves(const OceanWaves &) = delete;
+    OceanWaves &operator=(const OceanWaves &) = delete;
+
+    /// @brief Replaces the waves by count waves spread around the wind
+    /// direction, from the longest swell to short ripples. The total
+    /// steepness stays the same whatever the count.
+    /// @param windAngle direction of the wind, in degrees.
+    void generate(uint32_t count, float windAngle = 0.f, uint32_t seed = 1);
+
+    uint32_t getWaveCount() const { return static_cast<uint32_t>(m_waves.size()); }
+    const std::vector<GerstnerWave> &getWaves() const { return m_waves; }
+    void setWaves(const std::vector<GerstnerWave> &waves);
+    void setWave(uint32_t index, const GerstnerWave &wave);
+
+    /// @brief Displacement bound, x = horizontal, y = vertical.
+    glm::vec2 getMaxDisplacement() const;
+
+    /// @brief Copies the waves in the region of the frame if they changed
+    /// since its last use.
+    /// @return the dynamic offset of the region.
+    uint32_t update(uint32_t frameIndex);
+
+    /// @brief Descriptor of a dynamic storage buffer binding.
+    vk::DescriptorBufferInfo getDescriptorInfo() const;
+
+private:
+    std::unique_ptr<Buffer> m_buffer;
+    uint8_t *m_mapped;
+
+    std::vector<GerstnerWave> m_waves;
+    /// Incremented by every edit.
+    uint64_t m_version;
+    /// Version of the waves copied in the region of each frame.
+    std::vector<uint64_t> m_regionVersions;
+};
@@ -0,0 +1,317 @@
+#include "shader_hot_reload.hpp"
+
+#include <filesystem>
+
+namespace
+{
+    constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+
+    bool isShaderSource(const std::filesystem::path &path)
+    {
+        const std::string extension = path.extension().string();
+        return extension == ".vert" || extension == ".frag" || extension == ".comp"
+            || extension == ".geom" || extension == ".tesc" || extension == ".tese";
+    }
+}
+
+void HotPipeline::queue(
+    PipelineBuildQueue &buildQueue, vk::Device device,
+    const std::string &directory, vk::Pipeline *target) const
+{
+    std::vector<vk::PipelineShaderStageCreateInfo> shaderStages;
+    for (const Stage &stage : stages)
+    {
+        shaderStages.push_back(tools::loadShader(device, directory + stage.file, stage.stage));
+        buildQueue.destroyAfterBuild(shaderStages.back().module);
+    }
+    buildQueue.add(createBuilder(shaderStages), target);
+}
+
+ShaderHotReload::ShaderHotReload(
+    vk::Device device,
+    vk::PipelineCache pipelineCache,
+    const std::string &spirvDirectory,
+    const std::string &sourceDirectory,
+    const std::string &compilerPath)
+    : m_device{ device }
+    , m_pipelineCache{ pipelineCache }
+    , m_spirvDirectory{ spirvDirectory }
+    , m_sourceDirectory{ sourceDirectory }
+    , m_compilerPath{ compilerPath }
+    , m_watcher{}
+    , m_pipelines{}
+    , m_changedShaders{}
+    , m_lastChange{}
+    , m_compileState{ std::make_shared<CompileState>() }
+    , m_buildQueue{}
+    , m_pendingBuilds{}
+    , m_retiredPipelines{}
+    , m_reloadCount{ 0 }
+    , m_lastBuildTime{ 0.f }
+    , m_status{}
+{
+    if (m_watcher.addDirectory(m_spirvDirectory) == false)
+    {
+        std::cerr << "Shader hot reload: can't watch " << m_spirvDirectory << std::endl;
+    }
+
+    // Without compiler, the SPIR-V files are still reloaded when rebuilt outside
+    if (m_sourceDirectory.empty() || m_compilerPath.empty())
+    {
+        m_compilerPath.clear();
+    }
+    else if (m_watcher.addDirectory(m_sourceDirectory) == false)
+    {
+        std::cerr << "Shader hot reload: can't watch " << m_sourceDirectory << std::endl;
+        m_compilerPath.clear();
+    }
+    else
+    {
+        std::cout << "Shader hot reload: watching " << m_sourceDirectory << std::endl;
+    }
+}
+
+ShaderHotReload::~ShaderHotReload()
+{
+    if (m_buildQueue)
+    {
+        try
+        {
+            m_buildQueue->wait();
+            for (PendingBuild &build : m_pendingBuilds)
+            {
+                m_device.destroyPipeline(build.pipeline);
+            }
+        }
+        catch (const std::exception &)
+        {
+            // The queue destroyed the pipelines it built
+        }
+    }
+    for (RetiredPipeline &retired : m_retiredPipelines)
+    {
+        m_device.destroyPipeline(retired.pipeline);
+    }
+}
+
+void ShaderHotReload::addPipeline(const HotPipeline &pipeline)
+{
+    assert(m_buildQueue == nullptr && "Can't add a pipeline while rebuilding");
+    assert(pipeline.pipeline != nullptr && pipeline.createBuilder);
+    m_pipelines.push_back(pipeline);
+}
+
+bool ShaderHotReload::update(const Renderer &renderer)
+{
+    VE_TRACE_SCOPE("Shader hot reload");
+
+    const uint64_t frameNumber = renderer.getFrameNumber();
+    const uint32_t framesInFlight = renderer.getFramesInFlight();
+    const auto now = std::chrono::steady_clock::now();
+
+    // The fence of the current frame was waited, so every frame up to
+    // frameNumber - framesInFlight is complete
+    auto retiredEnd = std::remove_if(
+        m_retiredPipelines.begin(), m_retiredPipelines.end(),
+        [&](const RetiredPipeline &retired)
+    {
+        if (frameNumber + 1 < retired.frameNumber + framesInFlight) return false;
+        m_device.destroyPipeline(retired.pipeline);
+        return true;
+    });
+    m_retiredPipelines.erase(retiredEnd, m_retiredPipelines.end());
+
+    std::vector<std::string> changedPaths;
+    m_watcher.poll(changedPaths);
+    for (const std::string &changedPath : changedPaths)
+    {
+        std::filesystem::path path(changedPath);
+        if (path.extension() == ".spv")
+        {
+            m_changedShaders.insert(path.filename().string());
+            m_lastChange = now;
+        }
+        else if (isShaderSource(path) && m_compilerPath.empty() == false)
+        {
+            compile(changedPath);
+        }
+        else if (path.extension() == ".glsl" && m_compilerPath.empty() == false)
+        {
+            // The includes are not tracked, every source of the directory
+            // is compiled again
+            std::error_code error;
+            for (const auto &entry : std::filesystem::directory_iterator(path.parent_path(), error))
+            {
+                if (isShaderSource(entry.path())) compile(entry.path().string());
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_compileState->mutex);
+        for (const std::string &message : m_compileState->messages)
+        {
+            std::cout << "Shader hot reload: " << message << std::endl;
+            m_status = message;
+        }
+        m_compileState->messages.clear();
+    }
+
+    bool swapped = false;
+    if (m_buildQueue && m_buildQueue->isFinished())
+    {
+        swapped = finishBuild(frameNumber);
+    }
+    if (m_buildQueue == nullptr && m_changedShaders.empty() == false &&
+        now - m_lastChange >= SETTLE_TIME)
+    {
+        startBuild();
+    }
+    return swapped;
+}
+
+bool ShaderHotReload::isBusy() const
+{
+    std::lock_guard<std::mutex> lock(m_compileState->mutex);
+    return m_buildQueue != nullptr || m_changedShaders.empty() == false
+        || m_compileState->pendingCount > 0;
+}
+
+void ShaderHotReload::compile(const std::string &sourcePath)
+{
+    const std::string name = std::filesystem::path(sourcePath).filename().string();
+    const std::string spirvPath =
+        (std::filesystem::path(m_spirvDirectory) / (name + ".spv")).string();
+    const std::string tmpPath = spirvPath + ".tmp";
+
+    std::string command =
+        "\"" + m_compilerPath + "\" -V \"" + sourcePath + "\" -o \"" + tmpPath + "\"";
+#ifdef _WIN32
+    // cmd.exe removes the outer quotes of the command line
+    command = "\"" + command + "\"";
+#endif
+
+    std::shared_ptr<CompileState> state = m_compileState;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->pendingCount++;
+    }
+
+    ThreadPool::getShared().enqueue([state, command, name, spirvPath, tmpPath]()
+    {
+        VE_TRACE_SCOPE("Compile shader");
+
+        // glslangValidator prints the errors on the console
+        std::string message;
+        std::error_code error;
+        if (std::system(command.c_str()) == 0)
+        {
+            // The watcher sees the SPIR-V file once it is complete
+            std::filesystem::rename(tmpPath, spirvPath, error);
+            message = error ? name + ": " + error.message() : name + " compiled";
+        }
+        else
+        {
+            std::filesystem::remove(tmpPath, error);
+            message = name + ": compilation failed";
+        }
+
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->messages.push_back(message);
+        state->pendingCount--;
+    });
+}
+
+void ShaderHotReload::startBuild()
+{
+    assert(m_buildQueue == nullptr);
+
+    std::set<std::string> changedShaders = std::move(m_changedShaders);
+    m_changedShaders.clear();
+
+    m_pendingBuilds.clear();
+    for (size_t i = 0; i < m_pipelines.size(); i++)
+    {
+        const HotPipeline &pipeline = m_pipelines[i];
+        bool isChanged = false;
+        bool isValid = true;
+        for (const HotPipeline::Stage &stage : pipeline.stages)
+        {
+            isChanged |= (changedShaders.count(stage.file) > 0);
+            if (isValidSpirv(m_spirvDirectory + stage.file) == false)
+            {
+                m_status = pipeline.name + ": invalid SPIR-V file " + stage.file;
+                isValid = false;
+            }
+        }
+        if (isChanged == false) continue;
+
+        if (isValid == false)
+        {
+            std::cerr << "Shader hot reload: " << m_status << std::endl;
+            continue;
+        }
+        m_pendingBuilds.push_back({ i, VK_NULL_HANDLE });
+    }
+    if (m_pendingBuilds.empty()) return;
+
+    // The handles of m_pendingBuilds receive the pipelines
+    m_buildQueue = std::make_unique<PipelineBuildQueue>(m_device, m_pipelineCache);
+    for (PendingBuild &build : m_pendingBuilds)
+    {
+        m_pipelines[build.pipelineIndex].queue(
+            *m_buildQueue, m_device, m_spirvDirectory, &build.pipeline);
+    }
+    m_buildQueue->start();
+}
+
+bool ShaderHotReload::finishBuild(uint64_t frameNumber)
+{
+    std::unique_ptr<PipelineBuildQueue> buildQueue = std::move(m_buildQueue);
+    try
+    {
+        buildQueue->wait();
+    }
+    catch (const std::exception &e)
+    {
+        m_status = std::string("rebuild failed, ") + e.what();
+        std::cerr << "Shader hot reload: " << m_status << std::endl;
+        m_pendingBuilds.clear();
+        return false;
+    }
+
+    // The frames in flight may still use the old pipelines
+    for (const PendingBuild &build : m_pendingBuilds)
+    {
+        vk::Pipeline &pipeline = *m_pipelines[build.pipelineIndex].pipeline;
+        m_retiredPipelines.push_back({ pipeline, frameNumber });
+        pipeline = build.pipeline;
+    }
+
+    m_reloadCount += static_cast<uint32_t>(m_pendingBuilds.size());
+    m_lastBuildTime = buildQueue->getBuildTime();
+
+    char message[128] = { 0 };
+    snprintf(message, sizeof(message), "%zu pipelines reloaded in %.1f ms",
+        m_pendingBuilds.size(), m_lastBuildTime);
+    m_status = message;
+    std::cout << "Shader hot reload: " << m_status << std::endl;
+
+    m_pendingBuilds.clear();
+    return true;
+}
+
+bool ShaderHotReload::isValidSpirv(const std::string &path) const
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (file.is_open() == false) return false;
+
+    // Header of five words, then whole words
+    const std::streamoff size = file.tellg();
+    if (size < 20 || size % 4 != 0) return false;
+
+    uint32_t magic = 0;
+    file.seekg(0, std::ios::beg);
+    file.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+    return file.good() && magic == SPIRV_MAGIC;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "ve.hpp"
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+
+/// @brief Graphics pipeline rebuilt when one of its shaders changes.
+struct HotPipeline
+{
+    struct Stage
+    {
+        /// SPIR-V file, relative to the shader directory.
+        std::string file;
+        vk::ShaderStageFlagBits stage;
+    };
+
+    std::string name;
+    std::vector<Stage> stages;
+    /// Pipeline used to render, replaced between two frames.
+    vk::Pipeline *pipeline = nullptr;
+    /// Receives the loaded stages, in the order of stages, and returns the
+    /// builder of the pipeline. Its pipeline cache is replaced.
+    std::function<PipelineBuilder(std::vector<vk::PipelineShaderStageCreateInfo> &)> createBuilder;
+
+    /// @brief Loads the shaders and queues the pipeline.
+    /// @param target receives the pipeline when the queue is complete.
+    void queue(
+        PipelineBuildQueue &buildQueue, vk::Device device,
+        const std::string &directory, vk::Pipeline *target) const;
+};
+
+/// @brief Reloads the shaders while the application runs.
+/// A changed GLSL source is compiled to SPIR-V by glslangValidator on the
+/// shared thread pool, then every pipeline that uses a changed SPIR-V file
+/// is rebuilt by a PipelineBuildQueue. A changed include (.glsl) compiles
+/// every source of its directory. The new pipelines replace the old
+/// ones in update(), between two frames, and the old ones are destroyed once
+/// the frames in flight that may use them are complete.
+/// The rendering never waits for a compilation. After an error, the
+/// previous pipelines are kept until the next change.
+class ShaderHotReload
+{
+public:
+    /// Time without change before a rebuild, so that the stages written
+    /// together are rebuilt once.
+    static constexpr std::chrono::milliseconds SETTLE_TIME{ 100 };
+
+    /// @param spirvDirectory directory of the SPIR-V files loaded by the
+    /// pipelines, ending with a separator.
+    /// @param sourceDirectory directory of the GLSL sources, empty to only
+    /// watch the SPIR-V files.
+    /// @param compilerPath glslangValidator, empty to only watch the SPIR-V files.
+    ShaderHotReload(
+        vk::Device device,
+        vk::PipelineCache pipelineCache,
+        const std::string &spirvDirectory,
+        const std::string &sourceDirectory,
+        const std::string &compilerPath);
+    /// @brief The device must be idle, the retired pipelines are destroyed.
+    ~ShaderHotReload();
+
+    ShaderHotReload(const ShaderHotReload &) = delete;
+    ShaderHotReload &operator=(const ShaderHotReload &) = delete;
+
+    void addPipeline(const HotPipeline &pipeline);
+
+    /// @brief Starts the compilations and the rebuilds of the changed files
+    /// and swaps the rebuilt pipelines. Must be called before the recording
+    /// of a frame, once Renderer::waitForFrame() succeeded.
+    /// @return true if pipelines were replaced, the bound states must then
+    /// be invalidated.
+    bool update(const Renderer &renderer);
+
+    /// @brief True while shaders are compiled or pipelines rebuilt.
+    bool isBusy() const;
+    /// @brief Number of pipelines replaced since the start.
+    uint32_t getReloadCount() const { return m_reloadCount; }
+    /// @brief Duration of the last rebuild, in milliseconds.
+    float getLastBuildTime() const { return m_lastBuildTime; }
+    /// @brief Result of the last compilation or rebuild.
+    const std::string &getStatus() const { return m_status; }
+
+private:
+    /// Shared with the compilation tasks, which may outlive the reloader.
+    struct CompileState
+    {
+        std::mutex mutex;
+        uint32_t pendingCount = 0;
+        std::vector<std::string> messages;
+    };
+
+    struct RetiredPipeline
+    {
+        vk::Pipeline pipeline;
+        /// First frame recorded with the new pipeline.
+        uint64_t frameNumber;
+    };
+
+    struct PendingBuild
+    {
+        size_t pipelineIndex;
+        vk::Pipeline pipeline;
+    };
+
+    void compile(const std::string &sourcePath);
+    void startBuild();
+    bool finishBuild(uint64_t frameNumber);
+    bool isValidSpirv(const std::string &path) const;
+
+    vk::Device m_device;
+    vk::PipelineCache m_pipelineCache;
+    std::string m_spirvDirectory;
+    std::string m_sourceDirectory;
+    std::string m_compilerPath;
+
+    FileWatcher m_watcher;
+    std::vector<HotPipeline> m_pipelines;
+
+    /// SPIR-V files changed since the last rebuild.
+    std::set<std::string> m_changedShaders;
+    std::chrono::steady_clock::time_point m_lastChange;
+    std::shared_ptr<CompileState> m_compileState;
+
+    std::unique_ptr<PipelineBuildQueue> m_buildQueue;
+    /// Written by m_buildQueue, not resized while it builds.
+    std::vector<PendingBuild> m_pendingBuilds;
+    std::vector<RetiredPipeline> m_retiredPipelines;
+
+    uint32_t m_reloadCount;
+    float m_lastBuildTime;
+    std::string m_status;
+};
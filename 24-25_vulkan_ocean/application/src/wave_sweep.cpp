@@ -0,0 +1,113 @@
+#include "wave_sweep.hpp"
+
+#include <iomanip>
+
+WaveSweep::WaveSweep(uint32_t minWaveCount, uint32_t maxWaveCount)
+    : m_steps{}
+    , m_stepIndex{ 0 }
+    , m_firstFrame{}
+    , m_lastGpuFrame{ 0 }
+    , m_gpuFrameCount{ 0 }
+    , m_cpuFrameCount{ 0 }
+{
+    assert(minWaveCount > 0 && minWaveCount <= maxWaveCount);
+
+    // The FFT is the reference
+    m_steps.push_back(Step{});
+    for (uint32_t waveCount = minWaveCount; waveCount <= maxWaveCount; waveCount *= 2)
+    {
+        Step step{};
+        step.waveCount = waveCount;
+        m_steps.push_back(step);
+    }
+}
+
+uint32_t WaveSweep::getWaveCount() const
+{
+    return isRunning() ? m_steps[m_stepIndex].waveCount : 0;
+}
+
+void WaveSweep::update(uint64_t frameNumber, const GpuFrameTimings &lastFrame, double cpuFrameTime)
+{
+    if (isRunning() == false) return;
+
+    if (m_firstFrame.has_value() == false)
+    {
+        m_firstFrame = frameNumber + WARMUP_FRAMES;
+        return;
+    }
+
+    Step &step = m_steps[m_stepIndex];
+
+    // The CPU time is the one of the previous frame
+    if (frameNumber > *m_firstFrame && m_cpuFrameCount < MEASURED_FRAMES)
+    {
+        step.cpuFrameTime += cpuFrameTime;
+        m_cpuFrameCount++;
+    }
+
+    // The GPU timings arrive a few frames late, each frame is counted once
+    if (lastFrame.frameNumber >= *m_firstFrame && lastFrame.frameNumber != m_lastGpuFrame &&
+        m_gpuFrameCount < MEASURED_FRAMES)
+    {
+        m_lastGpuFrame = lastFrame.frameNumber;
+        step.gpuFrameTime += lastFrame.duration;
+        for (const GpuScopeTiming &scope : lastFrame.scopes)
+        {
+            if (scope.name.rfind("Ocean", 0) == 0)
+            {
+                step.gpuOceanTime += scope.duration;
+            }
+        }
+        m_gpuFrameCount++;
+    }
+
+    if (m_cpuFrameCount < MEASURED_FRAMES || m_gpuFrameCount < MEASURED_FRAMES) return;
+
+    step.gpuFrameTime /= MEASURED_FRAMES;
+    step.gpuOceanTime /= MEASURED_FRAMES;
+    step.cpuFrameTime /= MEASURED_FRAMES;
+
+    std::cout << "Wave sweep: " << (step.waveCount > 0 ? std::to_string(step.waveCount) + " waves" : "FFT")
+        << ", ocean " << step.gpuOceanTime << " ms, GPU frame " << step.gpuFrameTime
+        << " ms, CPU frame " << step.cpuFrameTime << " ms" << std::endl;
+
+    m_stepIndex++;
+    m_firstFrame.reset();
+    m_gpuFrameCount = 0;
+    m_cpuFrameCount = 0;
+}
+
+std::vector<WaveSweep::Step> WaveSweep::getResults() const
+{
+    return std::vector<Step>(m_steps.begin(), m_steps.begin() + m_stepIndex);
+}
+
+uint32_t WaveSweep::getCrossover() const
+{
+    if (m_stepIndex == 0) return 0;
+
+    const double fftTime = m_steps[0].gpuOceanTime;
+    for (size_t i = 1; i < m_stepIndex; i++)
+    {
+        if (m_steps[i].gpuOceanTime > fftTime) return m_steps[i].waveCount;
+    }
+    return 0;
+}
+
+void WaveSweep::writeCSV(const std::string &path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("failed to open file " + path);
+    }
+
+    file << std::fixed << std::setprecision(4);
+    file << "model,waves,gpu_ocean_ms,gpu_frame_ms,cpu_frame_ms\n";
+    for (const Step &step : getResults())
+    {
+        file << (step.waveCount > 0 ? "gerstner" : "fft") << "," << step.waveCount << ","
+            << step.gpuOceanTime << "," << step.gpuFrameTime << "," << step.cpuFrameTime << "\n";
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "ve.hpp"
+
+/// @brief Measures the Gerstner waves against the FFT displacement.
+/// The FFT is measured first, then the wave count doubles from the minimum
+/// to the maximum count. Each step skips WARMUP_FRAMES frames, so that the
+/// GPU timings of the previous step are resolved, then averages the GPU
+/// and CPU times of MEASURED_FRAMES frames.
+/// The ocean GPU time is the sum of the profiler scopes named "Ocean...":
+/// simulation, preparation and drawing.
+class WaveSweep
+{
+public:
+    static constexpr uint32_t WARMUP_FRAMES = 30;
+    static constexpr uint32_t MEASURED_FRAMES = 120;
+
+    struct Step
+    {
+        /// 0 for the FFT.
+        uint32_t waveCount = 0;
+        /// Averages, in milliseconds.
+        double gpuFrameTime = 0.0;
+        double gpuOceanTime = 0.0;
+        double cpuFrameTime = 0.0;
+    };
+
+    WaveSweep(uint32_t minWaveCount = 4, uint32_t maxWaveCount = 256);
+
+    bool isRunning() const { return m_stepIndex < m_steps.size(); }
+
+    /// @brief Wave count of the frame to record, 0 for the FFT.
+    uint32_t getWaveCount() const;
+
+    /// @brief Must be called once per frame, before the recording.
+    /// @param frameNumber number of the frame to record.
+    /// @param lastFrame last GPU timings resolved by the profiler.
+    /// @param cpuFrameTime duration of the previous frame, in milliseconds.
+    void update(uint64_t frameNumber, const GpuFrameTimings &lastFrame, double cpuFrameTime);
+
+    /// @brief Completed steps, the FFT first.
+    std::vector<Step> getResults() const;
+
+    /// @brief Smallest measured wave count whose ocean GPU time exceeds the
+    /// FFT, 0 if the Gerstner waves stay cheaper over the whole sweep.
+    uint32_t getCrossover() const;
+
+    void writeCSV(const std::string &path) const;
+
+private:
+    std::vector<Step> m_steps;
+    size_t m_stepIndex;
+
+    /// First frame measured by the current step, set by its first update.
+    std::optional<uint64_t> m_firstFrame;
+    uint64_t m_lastGpuFrame;
+    uint32_t m_gpuFrameCount;
+    uint32_t m_cpuFrameCount;
+};
@@ -0,0 +1,125 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#include "core/ve_cpu_trace.hpp"
+#include "core/ve_text_format.hpp"
+
+#include <iomanip>
+
+CpuTracer::CpuTracer()
+    : m_origin{ std::chrono::steady_clock::now() }
+    , m_enabled{ true }
+    , m_clearTime{ 0 }
+    , m_mutex{}
+    , m_buffers{}
+{
+}
+
+CpuTracer &CpuTracer::getShared()
+{
+    static CpuTracer sharedTracer;
+    return sharedTracer;
+}
+
+uint64_t CpuTracer::now() const
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - m_origin).count());
+}
+
+CpuTracer::ThreadBuffer &CpuTracer::getThreadBuffer()
+{
+    thread_local ThreadBuffer *threadBuffer = nullptr;
+    if (threadBuffer == nullptr)
+    {
+        auto buffer = std::make_unique<ThreadBuffer>();
+        buffer->events = std::make_unique<EventSlot[]>(EVENTS_PER_THREAD);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        buffer->threadID = static_cast<uint32_t>(m_buffers.size());
+        buffer->threadName = "Thread " + std::to_string(buffer->threadID);
+        threadBuffer = buffer.get();
+        m_buffers.push_back(std::move(buffer));
+    }
+    return *threadBuffer;
+}
+
+void CpuTracer::record(const char *name, uint64_t begin, uint64_t end)
+{
+    if (isEnabled() == false) return;
+
+    // Single writer: only the owner thread writes in its buffer. The fence
+    // orders the previous head before the slot writes, so that a reader
+    // seeing one of them also sees that the slot is being overwritten.
+    ThreadBuffer &buffer = getThreadBuffer();
+    uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    EventSlot &slot = buffer.events[head % EVENTS_PER_THREAD];
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.begin.store(begin, std::memory_order_relaxed);
+    slot.end.store(end, std::memory_order_relaxed);
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void CpuTracer::setThreadName(const std::string &name)
+{
+    ThreadBuffer &buffer = getThreadBuffer();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    buffer.threadName = name;
+}
+
+void CpuTracer::writeJSON(const std::string &path)
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("failed to open file " + path);
+    }
+
+    const uint64_t clearTime = m_clearTime.load(std::memory_order_relaxed);
+    std::vector<Event> events;
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"traceEvents\":[\n";
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"CPU\"}}";
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const std::unique_ptr<ThreadBuffer> &buffer : m_buffers)
+    {
+        file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadID
+            << ",\"args\":{\"name\":\"" << textformat::escapeJSON(buffer->threadName) << "\"}}";
+
+        // Copies the ring, then drops the events overwritten during the copy
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t first = (head > EVENTS_PER_THREAD) ? head - EVENTS_PER_THREAD : 0;
+        events.clear();
+        for (uint64_t i = first; i < head; i++)
+        {
+            const EventSlot &slot = buffer->events[i % EVENTS_PER_THREAD];
+            events.push_back(Event{
+                slot.name.load(std::memory_order_relaxed),
+                slot.begin.load(std::memory_order_relaxed),
+                slot.end.load(std::memory_order_relaxed) });
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t newHead = buffer->head.load(std::memory_order_relaxed);
+        uint64_t firstValid = (newHead + 1 > EVENTS_PER_THREAD) ? newHead + 1 - EVENTS_PER_THREAD : 0;
+        size_t skipCount = static_cast<size_t>(std::max(first, firstValid) - first);
+
+        for (size_t i = std::min(skipCount, events.size()); i < events.size(); i++)
+        {
+            const Event &event = events[i];
+            if (event.begin < clearTime) continue;
+
+            file << ",\n{\"name\":\"" << textformat::escapeJSON(event.name) << "\",\"cat\":\"cpu\",\"ph\":\"X\""
+                << ",\"ts\":" << 1e-3 * static_cast<double>(event.begin)
+                << ",\"dur\":" << 1e-3 * static_cast<double>(event.end - event.begin)
+                << ",\"pid\":1,\"tid\":" << buffer->threadID << "}";
+        }
+    }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
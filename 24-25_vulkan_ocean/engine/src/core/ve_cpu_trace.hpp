@@ -0,0 +1,119 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#pragma once
+
+#include "ve_settings.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+/// @brief Records the CPU zones of every thread and writes them in the
+/// Chrome trace event format (chrome://tracing, Perfetto).
+/// Each thread appends its zones to its own ring buffer without locking,
+/// the mutex is only taken when a thread records its first zone and when
+/// the trace is written. The oldest zones of a thread are overwritten once
+/// its buffer is full.
+/// Zones are recorded with the VE_TRACE_SCOPE(name) macro, compiled only
+/// when VE_ENABLE_TRACE is defined. The names must be string literals.
+class CpuTracer
+{
+public:
+    static constexpr uint32_t EVENTS_PER_THREAD = 1 << 16;
+
+    /// @brief Tracer shared by the engine, created on first use.
+    static CpuTracer &getShared();
+
+    /// @brief Time since the creation of the tracer, in nanoseconds.
+    uint64_t now() const;
+
+    /// @brief Records a complete zone of the calling thread.
+    void record(const char *name, uint64_t begin, uint64_t end);
+
+    /// @brief Name of the calling thread in the trace.
+    void setThreadName(const std::string &name);
+
+    void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    /// @brief The zones that began before this call are no longer written.
+    void clear() { m_clearTime.store(now(), std::memory_order_relaxed); }
+
+    /// @brief Writes the zones still in the buffers, can be called while
+    /// the other threads record.
+    void writeJSON(const std::string &path);
+
+private:
+    CpuTracer();
+
+    struct Event
+    {
+        const char *name;
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    /// Event slot of a ring, read by writeJSON() while its owner thread
+    /// may overwrite it, hence the atomic fields.
+    struct EventSlot
+    {
+        std::atomic<const char *> name{ nullptr };
+        std::atomic<uint64_t> begin{ 0 };
+        std::atomic<uint64_t> end{ 0 };
+    };
+
+    struct ThreadBuffer
+    {
+        std::unique_ptr<EventSlot[]> events;
+        /// Number of events written since the creation of the buffer.
+        std::atomic<uint64_t> head{ 0 };
+        uint32_t threadID = 0;
+        std::string threadName;
+    };
+
+    ThreadBuffer &getThreadBuffer();
+
+    std::chrono::steady_clock::time_point m_origin;
+    std::atomic<bool> m_enabled;
+    std::atomic<uint64_t> m_clearTime;
+
+    std::mutex m_mutex;
+    /// Kept after the end of their thread, so that their zones are written.
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+};
+
+/// @brief Records the zone from its construction to its destruction.
+class CpuTraceScope
+{
+public:
+    explicit CpuTraceScope(const char *name)
+        : m_name{ name }
+        , m_begin{ CpuTracer::getShared().now() }
+    {}
+    ~CpuTraceScope()
+    {
+        CpuTracer &tracer = CpuTracer::getShared();
+        tracer.record(m_name, m_begin, tracer.now());
+    }
+
+    CpuTraceScope(const CpuTraceScope &) = delete;
+    CpuTraceScope &operator=(const CpuTraceScope &) = delete;
+
+private:
+    const char *m_name;
+    uint64_t m_begin;
+};
+
+#ifdef VE_ENABLE_TRACE
+#  define VE_TRACE_CONCAT_IMPL(a, b) a##b
+#  define VE_TRACE_CONCAT(a, b) VE_TRACE_CONCAT_IMPL(a, b)
+#  define VE_TRACE_SCOPE(name) CpuTraceScope VE_TRACE_CONCAT(veTraceScope, __LINE__){ name }
+#  define VE_TRACE_THREAD_NAME(name) CpuTracer::getShared().setThreadName(name)
+#else
+#  define VE_TRACE_SCOPE(name) ((void)0)
+#  define VE_TRACE_THREAD_NAME(name) ((void)0)
+#endif
@@ -0,0 +1,78 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#include "core/ve_fft.hpp"
+
+namespace
+{
+    constexpr double PI = 3.14159265358979323846;
+}
+
+bool fft::isPowerOfTwo(uint32_t n)
+{
+    return n > 0 && (n & (n - 1)) == 0;
+}
+
+void fft::transform(std::vector<std::complex<float>> &data, bool inverse)
+{
+    transform(data.data(), static_cast<uint32_t>(data.size()), 1, inverse);
+}
+
+void fft::transform(std::complex<float> *data, uint32_t count, uint32_t stride, bool inverse)
+{
+    assert(isPowerOfTwo(count) && "The FFT size must be a power of two");
+
+    // Bit reversal permutation
+    for (uint32_t i = 1, j = 0; i < count; i++)
+    {
+        uint32_t bit = count >> 1;
+        for (; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j ^= bit;
+
+        if (i < j)
+        {
+            std::swap(data[i * stride], data[j * stride]);
+        }
+    }
+
+    // Butterflies, same order as in ocean_fft.comp
+    const double sign = inverse ? 1.0 : -1.0;
+    for (uint32_t span = 1; span < count; span <<= 1)
+    {
+        for (uint32_t pos = 0; pos < span; pos++)
+        {
+            double angle = sign * PI * static_cast<double>(pos) / static_cast<double>(span);
+            std::complex<float> w(
+                static_cast<float>(std::cos(angle)),
+                static_cast<float>(std::sin(angle)));
+
+            for (uint32_t i = pos; i < count; i += 2 * span)
+            {
+                std::complex<float> a = data[i * stride];
+                std::complex<float> b = data[(i + span) * stride] * w;
+                data[i * stride] = a + b;
+                data[(i + span) * stride] = a - b;
+            }
+        }
+    }
+}
+
+void fft::transform2D(std::vector<std::complex<float>> &data, uint32_t n, bool inverse)
+{
+    assert(data.size() == static_cast<size_t>(n) * n && "The grid must be n x n");
+
+    for (uint32_t row = 0; row < n; row++)
+    {
+        transform(data.data() + row * n, n, 1, inverse);
+    }
+    for (uint32_t col = 0; col < n; col++)
+    {
+        transform(data.data() + col, n, n, inverse);
+    }
+}
@@ -0,0 +1,31 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#pragma once
+
+#include "ve_settings.hpp"
+
+#include <complex>
+
+/// @brief Reference CPU implementation of the radix-2 FFT.
+/// It mirrors the compute shader version and is used to check its results
+/// without a GPU. The inverse transform is not normalized.
+namespace fft
+{
+    bool isPowerOfTwo(uint32_t n);
+
+    /// @brief In-place 1D FFT of a power-of-two sized sequence.
+    /// @param data the sequence, its size must be a power of two.
+    /// @param inverse computes the inverse transform (exponent sign +1).
+    void transform(std::vector<std::complex<float>> &data, bool inverse);
+
+    /// @brief In-place 1D FFT of count values separated by stride.
+    void transform(std::complex<float> *data, uint32_t count, uint32_t stride, bool inverse);
+
+    /// @brief In-place 2D FFT of a n x n row-major grid.
+    /// Rows are transformed first, then columns.
+    void transform2D(std::vector<std::complex<float>> &data, uint32_t n, bool inverse);
+}
@@ -0,0 +1,50 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#include "core/ve_file_io.hpp"
+
+#include <filesystem>
+
+void writeFileAtomic(const std::string &path, std::initializer_list<FileChunk> chunks)
+{
+    const std::string tmpPath = path + ".tmp";
+    std::error_code error;
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (file.is_open() == false)
+        {
+            throw std::runtime_error("failed to open file " + tmpPath);
+        }
+
+        for (const FileChunk &chunk : chunks)
+        {
+            file.write(
+                static_cast<const char *>(chunk.data),
+                static_cast<std::streamsize>(chunk.size));
+        }
+        file.flush();
+
+        if (file.good() == false)
+        {
+            file.close();
+            std::filesystem::remove(tmpPath, error);
+            throw std::runtime_error("failed to write file " + tmpPath);
+        }
+    }
+
+    std::filesystem::rename(tmpPath, path, error);
+    if (error)
+    {
+        const std::string message = error.message();
+        std::filesystem::remove(tmpPath, error);
+        throw std::runtime_error("failed to rename " + tmpPath + " to " + path + ": " + message);
+    }
+}
+
+void writeFileAtomic(const std::string &path, const void *data, size_t size)
+{
+    writeFileAtomic(path, { FileChunk{ data, size } });
+}
@@ -0,0 +1,24 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#pragma once
+
+#include "ve_settings.hpp"
+
+/// @brief Contiguous bytes written by writeFileAtomic().
+struct FileChunk
+{
+    const void *data;
+    size_t size;
+};
+
+/// @brief Writes the chunks one after the other to path + ".tmp", then
+/// renames it to the path, so that an interrupted write never leaves a
+/// truncated file behind.
+/// Throws std::runtime_error on failure, the temporary file is removed.
+void writeFileAtomic(const std::string &path, std::initializer_list<FileChunk> chunks);
+
+void writeFileAtomic(const std::string &path, const void *data, size_t size);
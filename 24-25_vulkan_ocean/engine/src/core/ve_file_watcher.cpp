@@ -0,0 +1,134 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#include "core/ve_file_watcher.hpp"
+
+#ifdef __linux__
+#  include <sys/inotify.h>
+#  include <unistd.h>
+#endif
+
+namespace
+{
+    void addUnique(std::vector<std::string> &paths, const std::string &path)
+    {
+        if (std::find(paths.begin(), paths.end(), path) == paths.end())
+        {
+            paths.push_back(path);
+        }
+    }
+}
+
+FileWatcher::FileWatcher()
+    : m_directories{}
+    , m_lastPoll{ std::chrono::steady_clock::now() }
+    , m_inotify{ -1 }
+{
+#ifdef __linux__
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotify < 0)
+    {
+        std::cerr << "inotify is not available, the files are polled" << std::endl;
+    }
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+#ifdef __linux__
+    // Closing the descriptor removes the watches
+    if (m_inotify >= 0) close(m_inotify);
+#endif
+}
+
+bool FileWatcher::addDirectory(const std::string &path)
+{
+    std::error_code error;
+    if (std::filesystem::is_directory(path, error) == false)
+    {
+        return false;
+    }
+
+    Directory directory{};
+    directory.path = path;
+
+#ifdef __linux__
+    if (m_inotify >= 0)
+    {
+        // Editors often save by renaming a temporary file
+        directory.watch = inotify_add_watch(
+            m_inotify, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (directory.watch < 0) return false;
+    }
+#endif
+    if (directory.watch < 0)
+    {
+        scan(directory, nullptr);
+    }
+
+    m_directories.push_back(std::move(directory));
+    return true;
+}
+
+void FileWatcher::poll(std::vector<std::string> &changedPaths)
+{
+#ifdef __linux__
+    if (m_inotify >= 0)
+    {
+        alignas(inotify_event) char buffer[4096];
+        while (true)
+        {
+            ssize_t size = read(m_inotify, buffer, sizeof(buffer));
+            if (size <= 0) break;
+
+            for (ssize_t offset = 0; offset < size;)
+            {
+                const inotify_event *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+                offset += sizeof(inotify_event) + event->len;
+
+                if (event->len == 0 || (event->mask & IN_ISDIR)) continue;
+                for (const Directory &directory : m_directories)
+                {
+                    if (directory.watch != event->wd) continue;
+                    addUnique(changedPaths, (directory.path / event->name).string());
+                }
+            }
+        }
+        return;
+    }
+#endif
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - m_lastPoll < POLL_INTERVAL) return;
+    m_lastPoll = now;
+
+    for (Directory &directory : m_directories)
+    {
+        scan(directory, &changedPaths);
+    }
+}
+
+void FileWatcher::scan(Directory &directory, std::vector<std::string> *changedPaths)
+{
+    std::error_code error;
+    for (const auto &entry : std::filesystem::directory_iterator(directory.path, error))
+    {
+        if (entry.is_regular_file(error) == false) continue;
+
+        const std::string name = entry.path().filename().string();
+        std::filesystem::file_time_type writeTime = entry.last_write_time(error);
+        if (error) continue;
+
+        auto it = directory.writeTimes.find(name);
+        if (it != directory.writeTimes.end() && it->second == writeTime) continue;
+
+        directory.writeTimes[name] = writeTime;
+        if (changedPaths)
+        {
+            addUnique(*changedPaths, entry.path().string());
+        }
+    }
+}
@@ -0,0 +1,54 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#pragma once
+
+#include "ve_settings.hpp"
+
+#include <chrono>
+#include <filesystem>
+
+/// @brief Reports the files written in a set of directories, without
+/// blocking the calling thread.
+/// On Linux, the changes come from inotify: a file is reported once it is
+/// closed after a write or renamed into the directory, so a file is never
+/// reported while it is being written. Elsewhere, the modification times
+/// are polled, at most every POLL_INTERVAL.
+/// The subdirectories are not watched.
+class FileWatcher
+{
+public:
+    static constexpr std::chrono::milliseconds POLL_INTERVAL{ 250 };
+
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher &) = delete;
+    FileWatcher &operator=(const FileWatcher &) = delete;
+
+    /// @return false if the directory does not exist or can't be watched.
+    bool addDirectory(const std::string &path);
+
+    /// @brief Appends the paths of the files written since the previous
+    /// call, each path once. The paths are the directory given to
+    /// addDirectory() followed by the file name.
+    void poll(std::vector<std::string> &changedPaths);
+
+private:
+    struct Directory
+    {
+        std::filesystem::path path;
+        int watch = -1;
+        /// Last modification time of each file, used without inotify.
+        std::map<std::string, std::filesystem::file_time_type> writeTimes;
+    };
+
+    void scan(Directory &directory, std::vector<std::string> *changedPaths);
+
+    std::vector<Directory> m_directories;
+    std::chrono::steady_clock::time_point m_lastPoll;
+    int m_inotify;
+};
@@ -0,0 +1,144 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#include "core/ve_frame_pacer.hpp"
+
+#include <thread>
+
+namespace
+{
+    /// Sleeps are not precise, the last part of the wait spins.
+    constexpr std::chrono::microseconds SPIN_DURATION{ 1500 };
+    /// Added to the predicted CPU time to absorb its variations.
+    constexpr std::chrono::microseconds SAFETY_MARGIN{ 500 };
+}
+
+FramePacer::FramePacer(uint32_t frameSlotCount)
+    : m_targetFrameRate{ 0.f }
+    , m_period{ 0 }
+    , m_predictedCpuTime{ 0 }
+    , m_deadline{}
+    , m_sampleTime{}
+    , m_lastSubmitTime{}
+    , m_isFrameStarted{ false }
+    , m_frameSlot{ 0 }
+    , m_slotSampleTimes(frameSlotCount)
+    , m_stats{}
+{
+    assert(frameSlotCount > 0);
+}
+
+void FramePacer::setTargetFrameRate(float frameRate)
+{
+    m_targetFrameRate = std::max(frameRate, 0.f);
+    m_period = (m_targetFrameRate > 0.f)
+        ? std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / m_targetFrameRate))
+        : Clock::duration{ 0 };
+
+    // Restart the schedule from the next frame
+    m_deadline = Clock::time_point{};
+}
+
+void FramePacer::beginFrame(uint32_t frameSlot)
+{
+    assert(frameSlot < m_slotSampleTimes.size());
+
+    Clock::time_point now = Clock::now();
+
+    // The GPU is done with the frame previously recorded in this slot
+    Clock::time_point &slotSampleTime = m_slotSampleTimes[frameSlot];
+    if (slotSampleTime != Clock::time_point{})
+    {
+        smooth(m_stats.latency, seconds(now - slotSampleTime));
+        slotSampleTime = Clock::time_point{};
+    }
+
+    if (m_period > Clock::duration{ 0 } && m_deadline != Clock::time_point{})
+    {
+        Clock::time_point wakeTime = m_deadline - m_predictedCpuTime - SAFETY_MARGIN;
+        sleepUntil(wakeTime);
+    }
+
+    m_sampleTime = Clock::now();
+    smooth(m_stats.sleepTime, seconds(m_sampleTime - now));
+
+    slotSampleTime = m_sampleTime;
+    m_frameSlot = frameSlot;
+    m_isFrameStarted = true;
+}
+
+void FramePacer::endFrame()
+{
+    assert(m_isFrameStarted && "beginFrame() must be called first");
+    m_isFrameStarted = false;
+
+    Clock::time_point submitTime = Clock::now();
+    Clock::duration cpuTime = submitTime - m_sampleTime;
+
+    // Predict with the largest of the last frame and a slowly decaying maximum,
+    // a late frame costs more latency than waking up a bit early
+    m_predictedCpuTime = std::max(cpuTime, m_predictedCpuTime - m_predictedCpuTime / 16);
+
+    smooth(m_stats.cpuTime, seconds(cpuTime));
+    if (m_lastSubmitTime != Clock::time_point{})
+    {
+        smooth(m_stats.frameTime, seconds(submitTime - m_lastSubmitTime));
+    }
+    m_lastSubmitTime = submitTime;
+
+    if (m_period <= Clock::duration{ 0 })
+    {
+        return;
+    }
+
+    if (m_deadline == Clock::time_point{})
+    {
+        m_deadline = submitTime + m_period;
+    }
+    else if (submitTime > m_deadline + m_period / 2)
+    {
+        // Too late, resynchronize instead of trying to catch up
+        m_stats.missedCount++;
+        m_deadline = submitTime + m_period;
+    }
+    else
+    {
+        m_deadline += m_period;
+    }
+}
+
+void FramePacer::abortFrame()
+{
+    if (m_isFrameStarted == false) return;
+    m_isFrameStarted = false;
+
+    // Nothing was submitted in the slot, its fence gives no latency
+    m_slotSampleTimes[m_frameSlot] = Clock::time_point{};
+}
+
+float FramePacer::seconds(Clock::duration duration)
+{
+    return std::chrono::duration<float>(duration).count();
+}
+
+void FramePacer::smooth(float &value, float sample)
+{
+    value = (value == 0.f) ? sample : 0.9f * value + 0.1f * sample;
+}
+
+void FramePacer::sleepUntil(Clock::time_point time)
+{
+    Clock::time_point now = Clock::now();
+    if (time - now > SPIN_DURATION)
+    {
+        std::this_thread::sleep_until(time - SPIN_DURATION);
+    }
+    while (Clock::now() < time)
+    {
+        std::this_thread::yield();
+    }
+}
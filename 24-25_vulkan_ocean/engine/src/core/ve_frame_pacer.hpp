@@ -0,0 +1,84 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#pragma once
+
+#include "ve_settings.hpp"
+
+#include <chrono>
+
+/// @brief Smoothed timings measured by the FramePacer, in seconds.
+struct FramePacingStats
+{
+    /// Time between two submissions.
+    float frameTime = 0.f;
+    /// Time from the input sampling to the submission.
+    float cpuTime = 0.f;
+    /// Time slept by the pacer before sampling the input.
+    float sleepTime = 0.f;
+    /// Time from the input sampling to the end of the GPU work of the frame.
+    /// Measured when the fence of the frame is next waited, so it is an
+    /// upper bound when the GPU finished earlier.
+    float latency = 0.f;
+    /// Submissions later than half a period after their deadline.
+    uint32_t missedCount = 0;
+};
+
+/// @brief Spaces the frames to a target frame rate and delays the input
+/// sampling until just before the recording, so that the frame is submitted
+/// right on its deadline with the most recent input.
+/// Usage, each frame:
+/// - wait for the fence of the frame (Renderer::waitForFrame()),
+/// - beginFrame(): sleeps then returns, sample the input and record,
+/// - endFrame() after the submission, or abortFrame() if the frame is
+///   not submitted.
+class FramePacer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// @param frameSlotCount number of frames in flight.
+    FramePacer(uint32_t frameSlotCount = 4);
+
+    /// @brief Target frame rate, 0 disables the pacing.
+    void setTargetFrameRate(float frameRate);
+    float getTargetFrameRate() const { return m_targetFrameRate; }
+
+    /// @brief Must be called once the GPU is done with the frame slot.
+    /// Sleeps until the predicted start of the recording.
+    void beginFrame(uint32_t frameSlot);
+
+    /// @brief Must be called right after the submission.
+    void endFrame();
+
+    /// @brief Cancels the frame started by beginFrame() when it is not
+    /// submitted, does nothing if no frame is started.
+    void abortFrame();
+
+    const FramePacingStats &getStats() const { return m_stats; }
+
+private:
+    static float seconds(Clock::duration duration);
+    static void smooth(float &value, float sample);
+
+    void sleepUntil(Clock::time_point time);
+
+    float m_targetFrameRate;
+    Clock::duration m_period;
+
+    /// Predicted time from the input sampling to the submission.
+    Clock::duration m_predictedCpuTime;
+    Clock::time_point m_deadline;
+    Clock::time_point m_sampleTime;
+    Clock::time_point m_lastSubmitTime;
+    bool m_isFrameStarted;
+    uint32_t m_frameSlot;
+
+    /// Input sampling time of the last frame recorded in each slot.
+    std::vector<Clock::time_point> m_slotSampleTimes;
+
+    FramePacingStats m_stats;
+};
@@ -0,0 +1,149 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#include "core/ve_frame_time_histogram.hpp"
+
+#include <iomanip>
+
+FrameTimeHistogram::FrameTimeHistogram(size_t capacity)
+    : m_capacity{ capacity }
+    , m_samples{}
+    , m_hitches{}
+    , m_next{ 0 }
+    , m_frameCount{ 0 }
+    , m_hitchFactor{ DEFAULT_HITCH_FACTOR }
+    , m_hitchCount{ 0 }
+    , m_lastHitchFrame{ 0 }
+    , m_lastHitchTime{ 0.f }
+    , m_median{ 0.f }
+    , m_scratch{}
+    , m_percentiles{}
+    , m_percentilesDirty{ false }
+{
+    assert(capacity > 0);
+    m_samples.reserve(capacity);
+    m_hitches.reserve(capacity);
+    m_scratch.reserve(capacity);
+}
+
+void FrameTimeHistogram::addSample(uint64_t frameTimeNS)
+{
+    float frameTime = static_cast<float>(static_cast<double>(frameTimeNS) * 1e-6);
+
+    // Compared to the median of the previous frames
+    bool hitch = m_samples.empty() == false && isHitch(frameTime, m_median);
+    if (hitch)
+    {
+        m_hitchCount++;
+        m_lastHitchFrame = m_frameCount;
+        m_lastHitchTime = frameTime;
+    }
+
+    if (m_samples.size() < m_capacity)
+    {
+        m_samples.push_back(frameTime);
+        m_hitches.push_back(hitch ? 1 : 0);
+    }
+    else
+    {
+        m_samples[m_next] = frameTime;
+        m_hitches[m_next] = hitch ? 1 : 0;
+    }
+    m_next = (m_next + 1) % m_capacity;
+    m_frameCount++;
+
+    m_median = computeMedian();
+    m_percentilesDirty = true;
+}
+
+void FrameTimeHistogram::clear()
+{
+    m_samples.clear();
+    m_hitches.clear();
+    m_next = 0;
+    m_frameCount = 0;
+    m_hitchCount = 0;
+    m_lastHitchFrame = 0;
+    m_lastHitchTime = 0.f;
+    m_median = 0.f;
+    m_percentiles = FrameTimePercentiles{};
+    m_percentilesDirty = false;
+}
+
+float FrameTimeHistogram::getLastSample() const
+{
+    if (m_samples.empty()) return 0.f;
+    return m_samples[(m_next + m_capacity - 1) % m_capacity];
+}
+
+bool FrameTimeHistogram::isHitch(float frameTime, float median) const
+{
+    return frameTime > m_hitchFactor * median && frameTime - median > MIN_HITCH_TIME;
+}
+
+float FrameTimeHistogram::computeMedian()
+{
+    m_scratch.assign(m_samples.begin(), m_samples.end());
+    auto middle = m_scratch.begin() + m_scratch.size() / 2;
+    std::nth_element(m_scratch.begin(), middle, m_scratch.end());
+    return *middle;
+}
+
+const FrameTimePercentiles &FrameTimeHistogram::getPercentiles() const
+{
+    if (m_percentilesDirty == false) return m_percentiles;
+
+    // Nearest rank
+    std::vector<float> sorted(m_samples);
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&sorted](float p) {
+        size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+        return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+    };
+
+    m_percentiles.p50 = percentile(0.50f);
+    m_percentiles.p95 = percentile(0.95f);
+    m_percentiles.p99 = percentile(0.99f);
+    m_percentiles.max = sorted.back();
+    m_percentilesDirty = false;
+
+    return m_percentiles;
+}
+
+std::vector<float> FrameTimeHistogram::getBuckets(uint32_t bucketCount, float maxTime) const
+{
+    assert(bucketCount > 0 && maxTime > 0.f);
+
+    std::vector<float> buckets(bucketCount, 0.f);
+    for (float frameTime : m_samples)
+    {
+        uint32_t bucket = static_cast<uint32_t>(frameTime / maxTime * bucketCount);
+        buckets[std::min(bucket, bucketCount - 1)] += 1.f;
+    }
+    return buckets;
+}
+
+void FrameTimeHistogram::writeCSV(const std::string &path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("failed to open file " + path);
+    }
+
+    file << std::fixed << std::setprecision(4);
+    file << "frame,frame_ms,hitch\n";
+
+    size_t sampleCount = m_samples.size();
+    size_t first = (sampleCount < m_capacity) ? 0 : m_next;
+    uint64_t firstFrame = m_frameCount - sampleCount;
+    for (size_t i = 0; i < sampleCount; i++)
+    {
+        size_t index = (first + i) % m_capacity;
+        file << firstFrame + i << "," << m_samples[index] << ","
+            << static_cast<uint32_t>(m_hitches[index]) << "\n";
+    }
+}
@@ -0,0 +1,88 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#pragma once
+
+#include "ve_settings.hpp"
+
+/// @brief Frame time percentiles of the samples of a histogram, in milliseconds.
+struct FrameTimePercentiles
+{
+    float p50 = 0.f;
+    float p95 = 0.f;
+    float p99 = 0.f;
+    float max = 0.f;
+};
+
+/// @brief Rolling window of the last frame times with percentiles and
+/// hitch detection. A hitch is a frame slower than hitchFactor times the
+/// median of the window before it, and at least MIN_HITCH_TIME slower than it
+/// so that the jitter of very short frames is not reported. Frames are
+/// flagged when added, the exported flags are the ones counted live.
+class FrameTimeHistogram
+{
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+    static constexpr float DEFAULT_HITCH_FACTOR = 2.f;
+    /// In milliseconds.
+    static constexpr float MIN_HITCH_TIME = 1.f;
+
+    FrameTimeHistogram(size_t capacity = DEFAULT_CAPACITY);
+
+    /// @brief Adds the duration of a frame, in nanoseconds.
+    void addSample(uint64_t frameTimeNS);
+    void clear();
+
+    void setHitchFactor(float factor) { m_hitchFactor = factor; }
+    float getHitchFactor() const { return m_hitchFactor; }
+
+    /// @brief Frame times in milliseconds, in a ring: the oldest sample is
+    /// at getOffset() once the window is full.
+    const std::vector<float> &getSamples() const { return m_samples; }
+    size_t getOffset() const { return m_next; }
+    size_t getSampleCount() const { return m_samples.size(); }
+    uint64_t getFrameCount() const { return m_frameCount; }
+    float getLastSample() const;
+
+    /// @brief Percentiles of the window, sorted once per new sample at most.
+    const FrameTimePercentiles &getPercentiles() const;
+
+    /// @brief Number of samples of the window in bucketCount buckets of
+    /// maxTime / bucketCount milliseconds, the last one gets the slower frames.
+    std::vector<float> getBuckets(uint32_t bucketCount, float maxTime) const;
+
+    uint32_t getHitchCount() const { return m_hitchCount; }
+    /// @brief Index of the last hitch frame since the creation or clear().
+    uint64_t getLastHitchFrame() const { return m_lastHitchFrame; }
+    float getLastHitchTime() const { return m_lastHitchTime; }
+
+    /// @brief Writes the samples of the window, oldest first, one per line:
+    /// frame, frame_ms, hitch, with the hitch flag set when the frame was added.
+    void writeCSV(const std::string &path) const;
+
+private:
+    float computeMedian();
+    bool isHitch(float frameTime, float median) const;
+
+    size_t m_capacity;
+    std::vector<float> m_samples;
+    /// Hitch flag of each sample, same ring as m_samples.
+    std::vector<uint8_t> m_hitches;
+    size_t m_next;
+    uint64_t m_frameCount;
+
+    float m_hitchFactor;
+    uint32_t m_hitchCount;
+    uint64_t m_lastHitchFrame;
+    float m_lastHitchTime;
+
+    /// Median of the window, updated with each sample.
+    float m_median;
+    std::vector<float> m_scratch;
+
+    mutable FrameTimePercentiles m_percentiles;
+    mutable bool m_percentilesDirty;
+};
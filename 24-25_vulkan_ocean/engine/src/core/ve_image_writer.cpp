@@ -0,0 +1,217 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#include "core/ve_image_writer.hpp"
+
+namespace
+{
+    class ByteWriter
+    {
+    public:
+        void u8(uint8_t value) { bytes.push_back(value); }
+        void u16le(uint16_t value) { u8(value & 0xFF); u8(value >> 8); }
+        void u32le(uint32_t value) { u16le(value & 0xFFFF); u16le(value >> 16); }
+        void u64le(uint64_t value) { u32le(value & 0xFFFFFFFF); u32le(value >> 32); }
+        void u32be(uint32_t value)
+        {
+            u8(value >> 24); u8((value >> 16) & 0xFF); u8((value >> 8) & 0xFF); u8(value & 0xFF);
+        }
+        void string(const char *value) { while (*value) u8(*value++); u8(0); }
+        void data(const void *src, size_t size)
+        {
+            const uint8_t *begin = static_cast<const uint8_t *>(src);
+            bytes.insert(bytes.end(), begin, begin + size);
+        }
+
+        std::vector<uint8_t> bytes;
+    };
+
+    void writeFile(const std::string &filepath, const std::vector<uint8_t> &bytes)
+    {
+        std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("failed to open the image file " + filepath);
+        }
+        file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+        if (!file.good())
+        {
+            throw std::runtime_error("failed to write the image file " + filepath);
+        }
+    }
+
+    uint32_t crc32(const uint8_t *data, size_t size)
+    {
+        static const std::array<uint32_t, 256> table = []() {
+            std::array<uint32_t, 256> values{};
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++)
+                {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : (c >> 1);
+                }
+                values[i] = c;
+            }
+            return values;
+        }();
+
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 0; i < size; i++)
+        {
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    void writeChunk(ByteWriter &png, const char type[4], const std::vector<uint8_t> &data)
+    {
+        png.u32be(static_cast<uint32_t>(data.size()));
+        size_t typeBegin = png.bytes.size();
+        png.data(type, 4);
+        png.data(data.data(), data.size());
+        png.u32be(crc32(png.bytes.data() + typeBegin, png.bytes.size() - typeBegin));
+    }
+
+    void exrAttribute(ByteWriter &exr, const char *name, const char *type, uint32_t size)
+    {
+        exr.string(name);
+        exr.string(type);
+        exr.u32le(size);
+    }
+}
+
+void imageio::writePNG(const std::string &filepath, uint32_t width, uint32_t height, const uint8_t *rgba)
+{
+    assert(rgba != nullptr && width > 0 && height > 0);
+
+    ByteWriter png;
+    const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    png.data(signature, sizeof(signature));
+
+    ByteWriter header;
+    header.u32be(width);
+    header.u32be(height);
+    header.u8(8); // Bit depth
+    header.u8(6); // RGBA
+    header.u8(0); // Deflate
+    header.u8(0); // Adaptive filtering
+    header.u8(0); // No interlace
+    writeChunk(png, "IHDR", header.bytes);
+
+    // Rows prefixed by the filter type 0 (none)
+    const size_t rowSize = 4 * static_cast<size_t>(width);
+    std::vector<uint8_t> rows;
+    rows.reserve((rowSize + 1) * height);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        rows.push_back(0);
+        rows.insert(rows.end(), rgba + y * rowSize, rgba + (y + 1) * rowSize);
+    }
+
+    // zlib stream made of stored deflate blocks
+    ByteWriter zlib;
+    zlib.u8(0x78);
+    zlib.u8(0x01);
+    const size_t maxBlockSize = 0xFFFF;
+    for (size_t offset = 0; offset < rows.size(); offset += maxBlockSize)
+    {
+        uint16_t blockSize = static_cast<uint16_t>(std::min(maxBlockSize, rows.size() - offset));
+        bool isLast = (offset + blockSize == rows.size());
+        zlib.u8(isLast ? 1 : 0);
+        zlib.u16le(blockSize);
+        zlib.u16le(static_cast<uint16_t>(~blockSize));
+        zlib.data(rows.data() + offset, blockSize);
+    }
+    uint32_t a = 1, b = 0;
+    for (uint8_t value : rows)
+    {
+        a = (a + value) % 65521;
+        b = (b + a) % 65521;
+    }
+    zlib.u32be((b << 16) | a);
+    writeChunk(png, "IDAT", zlib.bytes);
+
+    writeChunk(png, "IEND", {});
+
+    writeFile(filepath, png.bytes);
+}
+
+void imageio::writeEXR(const std::string &filepath, uint32_t width, uint32_t height, const uint16_t *rgba)
+{
+    assert(rgba != nullptr && width > 0 && height > 0);
+
+    ByteWriter exr;
+    exr.u32le(20000630); // Magic number
+    exr.u32le(2);        // Version 2, single part scanline image
+
+    // The channels are stored in alphabetical order
+    const char *channelNames[] = { "A", "B", "G", "R" };
+    const int channelIndices[] = { 3, 2, 1, 0 };
+
+    exrAttribute(exr, "channels", "chlist", 4 * (2 + 16) + 1);
+    for (const char *name : channelNames)
+    {
+        exr.string(name);
+        exr.u32le(1); // Half
+        exr.u8(0);    // pLinear
+        exr.u8(0); exr.u8(0); exr.u8(0);
+        exr.u32le(1); // xSampling
+        exr.u32le(1); // ySampling
+    }
+    exr.u8(0);
+
+    exrAttribute(exr, "compression", "compression", 1);
+    exr.u8(0); // NO_COMPRESSION
+
+    exrAttribute(exr, "dataWindow", "box2i", 16);
+    exr.u32le(0); exr.u32le(0); exr.u32le(width - 1); exr.u32le(height - 1);
+    exrAttribute(exr, "displayWindow", "box2i", 16);
+    exr.u32le(0); exr.u32le(0); exr.u32le(width - 1); exr.u32le(height - 1);
+
+    exrAttribute(exr, "lineOrder", "lineOrder", 1);
+    exr.u8(0); // INCREASING_Y
+
+    exrAttribute(exr, "pixelAspectRatio", "float", 4);
+    float aspect = 1.f;
+    exr.data(&aspect, 4);
+
+    exrAttribute(exr, "screenWindowCenter", "v2f", 8);
+    float center[2] = { 0.f, 0.f };
+    exr.data(center, 8);
+
+    exrAttribute(exr, "screenWindowWidth", "float", 4);
+    float windowWidth = 1.f;
+    exr.data(&windowWidth, 4);
+
+    exr.u8(0); // End of the header
+
+    // One scanline per chunk without compression
+    const uint32_t lineDataSize = 4 * 2 * width;
+    const uint64_t chunkSize = 4 + 4 + lineDataSize;
+    const uint64_t tableEnd = exr.bytes.size() + 8ull * height;
+    for (uint32_t y = 0; y < height; y++)
+    {
+        exr.u64le(tableEnd + y * chunkSize);
+    }
+
+    exr.bytes.reserve(exr.bytes.size() + height * chunkSize);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        exr.u32le(y);
+        exr.u32le(lineDataSize);
+        const uint16_t *row = rgba + 4 * static_cast<size_t>(width) * y;
+        for (int channel : channelIndices)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                exr.u16le(row[4 * x + channel]);
+            }
+        }
+    }
+
+    writeFile(filepath, exr.bytes);
+}
@@ -0,0 +1,23 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#pragma once
+
+#include "ve_settings.hpp"
+
+/// @brief Minimal image encoders without external dependency, used to save
+/// the frames read back from the GPU. The encoders do not compress, they are
+/// limited by the disk bandwidth rather than by the CPU.
+namespace imageio
+{
+    /// @brief Writes an 8-bit RGBA image as a PNG file, throws on failure.
+    /// @param rgba tightly packed rows, top row first.
+    void writePNG(const std::string &filepath, uint32_t width, uint32_t height, const uint8_t *rgba);
+
+    /// @brief Writes a half float RGBA image as an OpenEXR file, throws on failure.
+    /// @param rgba tightly packed rows of IEEE 754 half floats, top row first.
+    void writeEXR(const std::string &filepath, uint32_t width, uint32_t height, const uint16_t *rgba);
+}
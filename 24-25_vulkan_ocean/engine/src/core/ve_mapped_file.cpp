@@ -0,0 +1,136 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#include "core/ve_mapped_file.hpp"
+
+#ifdef _WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  define NOMINMAX
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string &filepath)
+    : m_data{ nullptr }
+    , m_size{ 0 }
+    , m_fileHandle{ INVALID_HANDLE_VALUE }
+    , m_mappingHandle{ nullptr }
+{
+    m_fileHandle = CreateFileA(
+        filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_fileHandle == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("failed to open " + filepath);
+    }
+
+    LARGE_INTEGER size{};
+    GetFileSizeEx(m_fileHandle, &size);
+    m_size = static_cast<size_t>(size.QuadPart);
+
+    // Empty files cannot be mapped
+    if (m_size == 0) return;
+
+    m_mappingHandle = CreateFileMappingA(m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mappingHandle != nullptr)
+    {
+        m_data = static_cast<const uint8_t *>(
+            MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    }
+
+    if (m_data == nullptr)
+    {
+        if (m_mappingHandle != nullptr) CloseHandle(m_mappingHandle);
+        CloseHandle(m_fileHandle);
+        throw std::runtime_error("failed to map " + filepath);
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr) UnmapViewOfFile(m_data);
+    if (m_mappingHandle != nullptr) CloseHandle(m_mappingHandle);
+    CloseHandle(m_fileHandle);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string &filepath)
+    : m_data{ nullptr }
+    , m_size{ 0 }
+{
+    int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("failed to open " + filepath);
+    }
+
+    struct stat fileStat {};
+    if (fstat(fd, &fileStat) != 0)
+    {
+        close(fd);
+        throw std::runtime_error("failed to stat " + filepath);
+    }
+    m_size = static_cast<size_t>(fileStat.st_size);
+
+    if (m_size > 0)
+    {
+        void *data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            close(fd);
+            throw std::runtime_error("failed to map " + filepath);
+        }
+        m_data = static_cast<const uint8_t *>(data);
+
+        // The file is read front to back
+        madvise(data, m_size, MADV_SEQUENTIAL);
+    }
+
+    // The mapping keeps its own reference on the file
+    close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr)
+    {
+        munmap(const_cast<uint8_t *>(m_data), m_size);
+    }
+}
+
+#endif
+
+uint64_t MappedFile::computeHash(const uint8_t *data, size_t size)
+{
+    // FNV-1a on 64-bit words, with a final avalanche
+    constexpr uint64_t prime = 0x100000001B3ull;
+    uint64_t hash = 0xCBF29CE484222325ull ^ size;
+
+    size_t offset = 0;
+    for (; offset + 8 <= size; offset += 8)
+    {
+        uint64_t word;
+        memcpy(&word, data + offset, 8);
+        hash = (hash ^ word) * prime;
+        hash ^= hash >> 29;
+    }
+    for (; offset < size; offset++)
+    {
+        hash = (hash ^ data[offset]) * prime;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    return hash;
+}
@@ -0,0 +1,41 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#pragma once
+
+#include "ve_settings.hpp"
+
+/// @brief Read-only memory mapping of a whole file.
+/// The pages are loaded by the OS on first access, so reading the file costs
+/// no copy besides the one made by the caller.
+class MappedFile
+{
+public:
+    /// @brief Maps the file, throws if it cannot be opened.
+    MappedFile(const std::string &filepath);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const uint8_t *getData() const { return m_data; }
+    size_t getSize() const { return m_size; }
+
+    /// @brief 64-bit hash of the file contents.
+    uint64_t computeHash() const { return computeHash(m_data, m_size); }
+
+    /// @brief 64-bit hash of a memory block, the one used for the files.
+    static uint64_t computeHash(const uint8_t *data, size_t size);
+
+private:
+    const uint8_t *m_data;
+    size_t m_size;
+
+#ifdef _WIN32
+    void *m_fileHandle;
+    void *m_mappingHandle;
+#endif
+};
@@ -0,0 +1,383 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#include "core/ve_mesh_optimizer.hpp"
+
+namespace
+{
+    constexpr uint32_t INVALID_INDEX = ~0u;
+
+    /// Score of a vertex from its position in the LRU cache (-1 if absent)
+    /// and its number of remaining triangles, as described by Tom Forsyth.
+    float vertexScore(int cachePosition, uint32_t remainingCount)
+    {
+        if (remainingCount == 0)
+        {
+            return -1.f;
+        }
+
+        float score = 0.f;
+        if (cachePosition >= 0)
+        {
+            if (cachePosition < 3)
+            {
+                // The last triangle vertices get a fixed score so that
+                // strips are not favored over fans
+                score = 0.75f;
+            }
+            else
+            {
+                const float scaler = 1.f / static_cast<float>(meshopt::VERTEX_CACHE_SIZE - 3);
+                score = 1.f - static_cast<float>(cachePosition - 3) * scaler;
+                score = std::pow(score, 1.5f);
+            }
+        }
+
+        // Favors the vertices with few triangles left to avoid isolated ones
+        score += 2.f / std::sqrt(static_cast<float>(remainingCount));
+        return score;
+    }
+
+    glm::vec3 loadPosition(const float *positions, size_t stride, uint32_t index)
+    {
+        const float *p = reinterpret_cast<const float *>(
+            reinterpret_cast<const uint8_t *>(positions) + index * stride);
+        return glm::vec3(p[0], p[1], p[2]);
+    }
+}
+
+meshopt::VertexCacheStats meshopt::analyzeVertexCache(
+    const std::vector<uint32_t> &indices, uint32_t vertexCount, uint32_t cacheSize)
+{
+    assert(indices.size() % 3 == 0);
+    assert(cacheSize > 0);
+
+    // Each vertex stores the time it entered the FIFO
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+
+    VertexCacheStats stats{};
+    for (uint32_t index : indices)
+    {
+        assert(index < vertexCount);
+        if (time - timestamps[index] > cacheSize)
+        {
+            timestamps[index] = time++;
+            stats.transformedCount++;
+        }
+    }
+
+    const size_t triangleCount = indices.size() / 3;
+    stats.acmr = triangleCount > 0 ?
+        static_cast<float>(stats.transformedCount) / static_cast<float>(triangleCount) : 0.f;
+    stats.atvr = vertexCount > 0 ?
+        static_cast<float>(stats.transformedCount) / static_cast<float>(vertexCount) : 0.f;
+    return stats;
+}
+
+void meshopt::optimizeVertexCache(std::vector<uint32_t> &indices, uint32_t vertexCount)
+{
+    assert(indices.size() % 3 == 0);
+
+    const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    // Triangles adjacent to each vertex, the first remainingCounts[v]
+    // entries of the list are the triangles not emitted yet
+    std::vector<uint32_t> remainingCounts(vertexCount, 0);
+    for (uint32_t index : indices)
+    {
+        assert(index < vertexCount);
+        remainingCounts[index]++;
+    }
+
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (uint32_t v = 0; v < vertexCount; v++)
+    {
+        offsets[v + 1] = offsets[v] + remainingCounts[v];
+    }
+
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fillCounts(vertexCount, 0);
+        for (uint32_t t = 0; t < triangleCount; t++)
+        {
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                uint32_t v = indices[3 * t + k];
+                adjacency[offsets[v] + fillCounts[v]++] = t;
+            }
+        }
+    }
+
+    std::vector<int> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; v++)
+    {
+        vertexScores[v] = vertexScore(-1, remainingCounts[v]);
+    }
+
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    uint32_t bestTriangle = 0;
+    for (uint32_t t = 0; t < triangleCount; t++)
+    {
+        triangleScores[t] =
+            vertexScores[indices[3 * t + 0]] +
+            vertexScores[indices[3 * t + 1]] +
+            vertexScores[indices[3 * t + 2]];
+
+        if (triangleScores[t] > triangleScores[bestTriangle])
+        {
+            bestTriangle = t;
+        }
+    }
+
+    // The cache can hold three extra entries while it is updated
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> nextCache;
+    cache.reserve(VERTEX_CACHE_SIZE + 3);
+    nextCache.reserve(VERTEX_CACHE_SIZE + 3);
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    uint32_t cursor = 0;
+
+    while (result.size() < indices.size())
+    {
+        if (bestTriangle == INVALID_INDEX)
+        {
+            // Dead end, restarts from the next triangle in input order
+            while (emitted[cursor])
+            {
+                cursor++;
+            }
+            bestTriangle = cursor;
+        }
+
+        const uint32_t *triangle = &indices[3 * bestTriangle];
+        emitted[bestTriangle] = true;
+        result.insert(result.end(), triangle, triangle + 3);
+
+        // Removes the triangle from the adjacency of its vertices
+        for (uint32_t k = 0; k < 3; k++)
+        {
+            uint32_t v = triangle[k];
+            uint32_t *list = &adjacency[offsets[v]];
+            uint32_t count = remainingCounts[v];
+            for (uint32_t i = 0; i < count; i++)
+            {
+                if (list[i] == bestTriangle)
+                {
+                    std::swap(list[i], list[count - 1]);
+                    break;
+                }
+            }
+            remainingCounts[v]--;
+        }
+
+        // Moves the triangle vertices to the front of the LRU cache
+        nextCache.clear();
+        nextCache.insert(nextCache.end(), triangle, triangle + 3);
+        for (uint32_t v : cache)
+        {
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+            {
+                nextCache.push_back(v);
+            }
+        }
+
+        for (size_t i = 0; i < nextCache.size(); i++)
+        {
+            uint32_t v = nextCache[i];
+            cachePositions[v] = i < VERTEX_CACHE_SIZE ? static_cast<int>(i) : -1;
+            vertexScores[v] = vertexScore(cachePositions[v], remainingCounts[v]);
+        }
+
+        // Updates the scores of the triangles touched by the cache
+        bestTriangle = INVALID_INDEX;
+        float bestScore = -1.f;
+        for (uint32_t v : nextCache)
+        {
+            const uint32_t *list = &adjacency[offsets[v]];
+            for (uint32_t i = 0; i < remainingCounts[v]; i++)
+            {
+                uint32_t t = list[i];
+                float score =
+                    vertexScores[indices[3 * t + 0]] +
+                    vertexScores[indices[3 * t + 1]] +
+                    vertexScores[indices[3 * t + 2]];
+                triangleScores[t] = score;
+
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    bestTriangle = t;
+                }
+            }
+        }
+
+        if (nextCache.size() > VERTEX_CACHE_SIZE)
+        {
+            nextCache.resize(VERTEX_CACHE_SIZE);
+        }
+        cache.swap(nextCache);
+    }
+
+    indices.swap(result);
+}
+
+void meshopt::optimizeOverdraw(
+    std::vector<uint32_t> &indices,
+    const float *positions, size_t stride, uint32_t vertexCount,
+    float threshold)
+{
+    assert(indices.size() % 3 == 0);
+    assert(positions != nullptr && stride >= 3 * sizeof(float));
+
+    const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    constexpr uint32_t cacheSize = VERTEX_CACHE_SIZE;
+
+    // Cuts a cluster where a triangle misses the cache on its three vertices,
+    // drawing the clusters in any order then costs almost nothing
+    std::vector<uint32_t> clusterStarts;
+    {
+        std::vector<uint32_t> timestamps(vertexCount, 0);
+        uint32_t time = cacheSize + 1;
+
+        for (uint32_t t = 0; t < triangleCount; t++)
+        {
+            uint32_t missCount = 0;
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                uint32_t v = indices[3 * t + k];
+                if (time - timestamps[v] > cacheSize)
+                {
+                    timestamps[v] = time++;
+                    missCount++;
+                }
+            }
+
+            if (t == 0 || missCount == 3)
+            {
+                clusterStarts.push_back(t);
+            }
+        }
+    }
+
+    const uint32_t clusterCount = static_cast<uint32_t>(clusterStarts.size());
+    if (clusterCount <= 1)
+    {
+        return;
+    }
+    clusterStarts.push_back(triangleCount);
+
+    // Area weighted centroid and normal of each cluster
+    std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3(0.f));
+    std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.f));
+    glm::vec3 meshCentroid(0.f);
+    float meshArea = 0.f;
+
+    for (uint32_t c = 0; c < clusterCount; c++)
+    {
+        float clusterArea = 0.f;
+        for (uint32_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++)
+        {
+            glm::vec3 p0 = loadPosition(positions, stride, indices[3 * t + 0]);
+            glm::vec3 p1 = loadPosition(positions, stride, indices[3 * t + 1]);
+            glm::vec3 p2 = loadPosition(positions, stride, indices[3 * t + 2]);
+
+            glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+            float area = glm::length(normal);
+            glm::vec3 centroid = (p0 + p1 + p2) / 3.f;
+
+            clusterCentroids[c] += area * centroid;
+            clusterNormals[c] += normal;
+            clusterArea += area;
+        }
+
+        meshCentroid += clusterCentroids[c];
+        meshArea += clusterArea;
+
+        if (clusterArea > 0.f)
+        {
+            clusterCentroids[c] /= clusterArea;
+        }
+    }
+
+    if (meshArea > 0.f)
+    {
+        meshCentroid /= meshArea;
+    }
+
+    // Clusters on the outside and facing outwards occlude the others
+    std::vector<float> sortKeys(clusterCount);
+    for (uint32_t c = 0; c < clusterCount; c++)
+    {
+        float length = glm::length(clusterNormals[c]);
+        glm::vec3 normal = length > 0.f ? clusterNormals[c] / length : glm::vec3(0.f);
+        sortKeys[c] = glm::dot(clusterCentroids[c] - meshCentroid, normal);
+    }
+
+    std::vector<uint32_t> order(clusterCount);
+    for (uint32_t c = 0; c < clusterCount; c++)
+    {
+        order[c] = c;
+    }
+    std::stable_sort(order.begin(), order.end(),
+        [&sortKeys](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (uint32_t c : order)
+    {
+        result.insert(
+            result.end(),
+            indices.begin() + 3 * clusterStarts[c],
+            indices.begin() + 3 * clusterStarts[c + 1]);
+    }
+
+    float acmrBefore = analyzeVertexCache(indices, vertexCount, cacheSize).acmr;
+    float acmrAfter = analyzeVertexCache(result, vertexCount, cacheSize).acmr;
+    if (acmrAfter <= threshold * acmrBefore)
+    {
+        indices.swap(result);
+    }
+}
+
+std::vector<uint32_t> meshopt::optimizeVertexFetchRemap(
+    std::vector<uint32_t> &indices, uint32_t vertexCount)
+{
+    std::vector<uint32_t> remap(vertexCount, INVALID_INDEX);
+    uint32_t nextIndex = 0;
+
+    for (uint32_t &index : indices)
+    {
+        assert(index < vertexCount);
+        if (remap[index] == INVALID_INDEX)
+        {
+            remap[index] = nextIndex++;
+        }
+        index = remap[index];
+    }
+
+    for (uint32_t &newIndex : remap)
+    {
+        if (newIndex == INVALID_INDEX)
+        {
+            newIndex = nextIndex++;
+        }
+    }
+    return remap;
+}
@@ -0,0 +1,74 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#pragma once
+
+#include "ve_settings.hpp"
+
+/// @brief Reordering of indexed triangle lists for the GPU vertex pipeline.
+/// The usual sequence is optimizeVertexCache, then optionally
+/// optimizeOverdraw, then optimizeVertexFetch which renumbers the vertices.
+namespace meshopt
+{
+    /// Cache size assumed by the triangle reordering.
+    constexpr uint32_t VERTEX_CACHE_SIZE = 32;
+
+    struct VertexCacheStats
+    {
+        /// Number of simulated vertex shader invocations.
+        uint32_t transformedCount = 0;
+        /// Average cache miss ratio, transformed vertices per triangle.
+        /// 0.5 is the limit for a large regular grid, 3 is the worst case.
+        float acmr = 0.f;
+        /// Average transformed vertex ratio, transformed vertices per vertex.
+        /// 1 is optimal.
+        float atvr = 0.f;
+    };
+
+    /// @brief Simulates a FIFO post-transform cache, of the size targeted by
+    /// the optimizations by default.
+    VertexCacheStats analyzeVertexCache(
+        const std::vector<uint32_t> &indices, uint32_t vertexCount,
+        uint32_t cacheSize = VERTEX_CACHE_SIZE);
+
+    /// @brief Reorders the triangles for the post-transform vertex cache
+    /// using the linear-speed algorithm of Tom Forsyth.
+    void optimizeVertexCache(std::vector<uint32_t> &indices, uint32_t vertexCount);
+
+    /// @brief Reorders clusters of triangles so that triangles facing away
+    /// from the mesh center are drawn first, which reduces overdraw from
+    /// any view point. The input must already be cache optimized.
+    /// Clusters are cut where the vertex cache is cold anyway, and the
+    /// order is kept if the ACMR grows by more than threshold.
+    /// @param positions first vertex position, vec3 of floats.
+    /// @param stride distance in bytes between two positions.
+    void optimizeOverdraw(
+        std::vector<uint32_t> &indices,
+        const float *positions, size_t stride, uint32_t vertexCount,
+        float threshold = 1.05f);
+
+    /// @brief Computes a vertex numbering in order of first use by the
+    /// indices and rewrites the indices with it.
+    /// Unreferenced vertices are moved to the end.
+    /// @return remap[oldIndex] = newIndex.
+    std::vector<uint32_t> optimizeVertexFetchRemap(
+        std::vector<uint32_t> &indices, uint32_t vertexCount);
+
+    /// @brief Reorders the vertices in order of first use by the indices.
+    template <class Vtx>
+    void optimizeVertexFetch(std::vector<Vtx> &vertices, std::vector<uint32_t> &indices)
+    {
+        std::vector<uint32_t> remap = optimizeVertexFetchRemap(
+            indices, static_cast<uint32_t>(vertices.size()));
+
+        std::vector<Vtx> reordered(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            reordered[remap[i]] = vertices[i];
+        }
+        vertices.swap(reordered);
+    }
+}
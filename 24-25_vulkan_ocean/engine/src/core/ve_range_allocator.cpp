@@ -0,0 +1,102 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#include "core/ve_range_allocator.hpp"
+
+BuddyAllocator::BuddyAllocator(uint64_t size)
+    : m_maxOrder{ getOrder(size) }
+    , m_freeLists{}
+{
+    assert((size & (size - 1)) == 0 && size >= MIN_NODE_SIZE &&
+        "The block size must be a power of two");
+
+    m_freeLists.resize(m_maxOrder + 1);
+    m_freeLists[m_maxOrder].insert(0);
+}
+
+uint32_t BuddyAllocator::getOrder(uint64_t size)
+{
+    uint32_t order = 0;
+    while ((MIN_NODE_SIZE << order) < size)
+    {
+        order++;
+    }
+    return order;
+}
+
+bool BuddyAllocator::allocate(uint64_t size, uint64_t &offset, uint64_t &reservedSize)
+{
+    const uint32_t order = getOrder(size);
+    if (order > m_maxOrder) return false;
+
+    uint32_t freeOrder = order;
+    while (freeOrder <= m_maxOrder && m_freeLists[freeOrder].empty())
+    {
+        freeOrder++;
+    }
+    if (freeOrder > m_maxOrder) return false;
+
+    // Lowest offsets first, keeps the allocations packed
+    offset = *m_freeLists[freeOrder].begin();
+    m_freeLists[freeOrder].erase(m_freeLists[freeOrder].begin());
+
+    // Splits the node, the upper halves become free
+    while (freeOrder > order)
+    {
+        freeOrder--;
+        m_freeLists[freeOrder].insert(offset + (MIN_NODE_SIZE << freeOrder));
+    }
+
+    reservedSize = MIN_NODE_SIZE << order;
+    return true;
+}
+
+void BuddyAllocator::free(uint64_t offset, uint64_t reservedSize)
+{
+    uint32_t order = getOrder(reservedSize);
+    assert(order <= m_maxOrder && offset % reservedSize == 0);
+
+    // Merges the node with its buddy as long as the buddy is free
+    while (order < m_maxOrder)
+    {
+        uint64_t buddy = offset ^ (MIN_NODE_SIZE << order);
+        auto it = m_freeLists[order].find(buddy);
+        if (it == m_freeLists[order].end()) break;
+
+        m_freeLists[order].erase(it);
+        offset = std::min(offset, buddy);
+        order++;
+    }
+
+    m_freeLists[order].insert(offset);
+}
+
+uint64_t BuddyAllocator::getLargestFreeSize() const
+{
+    for (uint32_t order = m_maxOrder + 1; order-- > 0;)
+    {
+        if (m_freeLists[order].empty() == false) return MIN_NODE_SIZE << order;
+    }
+    return 0;
+}
+
+LinearAllocator::LinearAllocator(uint64_t size)
+    : m_size{ size }
+    , m_head{ 0 }
+{
+}
+
+bool LinearAllocator::allocate(uint64_t size, uint64_t alignment, uint64_t &offset, uint64_t &reservedSize)
+{
+    assert(alignment > 0);
+    const uint64_t alignedHead = (m_head + alignment - 1) / alignment * alignment;
+    if (alignedHead + size > m_size) return false;
+
+    offset = alignedHead;
+    reservedSize = alignedHead + size - m_head;
+    m_head = alignedHead + size;
+    return true;
+}
@@ -0,0 +1,67 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#pragma once
+
+#include "ve_settings.hpp"
+
+/// @brief Buddy allocator of the ranges of a block whose size is a power of
+/// two. Sizes are rounded up to a power of two of at least MIN_NODE_SIZE
+/// bytes and the ranges are aligned on their rounded size.
+class BuddyAllocator
+{
+public:
+    /// Size of the order 0 nodes.
+    static constexpr uint64_t MIN_NODE_SIZE = 256;
+
+    /// @param size block size, a power of two of at least MIN_NODE_SIZE.
+    BuddyAllocator(uint64_t size);
+
+    /// @brief Reserves the free range with the lowest offset.
+    /// @param reservedSize rounded size, to give back to free().
+    /// @return false if no free range is large enough.
+    bool allocate(uint64_t size, uint64_t &offset, uint64_t &reservedSize);
+
+    /// @brief Releases a range, merged with its buddies when they are free.
+    void free(uint64_t offset, uint64_t reservedSize);
+
+    uint64_t getSize() const { return MIN_NODE_SIZE << m_maxOrder; }
+
+    /// @brief Size of the largest range that can be allocated.
+    uint64_t getLargestFreeSize() const;
+
+    static uint32_t getOrder(uint64_t size);
+
+private:
+    uint32_t m_maxOrder;
+
+    /// Free node offsets of each order.
+    std::vector<std::set<uint64_t>> m_freeLists;
+};
+
+/// @brief Linear allocator of the ranges of a block. Freed ranges are only
+/// reused once the whole block is reset.
+class LinearAllocator
+{
+public:
+    LinearAllocator(uint64_t size);
+
+    /// @param alignment power of two or not, the offset is a multiple of it.
+    /// @param reservedSize size plus the alignment padding.
+    /// @return false if the end of the block is reached.
+    bool allocate(uint64_t size, uint64_t alignment, uint64_t &offset, uint64_t &reservedSize);
+
+    void reset() { m_head = 0; }
+
+    uint64_t getSize() const { return m_size; }
+
+    /// @brief First free byte.
+    uint64_t getHead() const { return m_head; }
+
+private:
+    uint64_t m_size;
+    uint64_t m_head;
+};
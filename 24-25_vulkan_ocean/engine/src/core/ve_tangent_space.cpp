@@ -0,0 +1,221 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#include "core/ve_tangent_space.hpp"
+#include "core/ve_thread_pool.hpp"
+
+namespace
+{
+    constexpr uint32_t INVALID_INDEX = ~0u;
+    constexpr uint32_t MIN_RANGE_SIZE = 4096;
+
+    template <class T>
+    T loadAttribute(const float *first, size_t stride, uint32_t index)
+    {
+        T value;
+        memcpy(&value, reinterpret_cast<const uint8_t *>(first) + index * stride, sizeof(T));
+        return value;
+    }
+
+    /// Component of v orthogonal to the unit vector n, normalized,
+    /// or zero if v is parallel to n.
+    glm::vec3 projectOnPlane(const glm::vec3 &v, const glm::vec3 &n)
+    {
+        glm::vec3 projected = v - glm::dot(n, v) * n;
+        float length = glm::length(projected);
+        return length > 0.f ? projected / length : glm::vec3(0.f);
+    }
+}
+
+std::vector<glm::vec4> meshopt::generateTangents(
+    const TangentSpaceInput &input,
+    std::vector<uint32_t> &indices,
+    std::vector<uint32_t> &splitVertices)
+{
+    assert(input.positions && input.normals && input.texCoords);
+    assert(indices.size() % 3 == 0);
+
+    ThreadPool &threadPool = ThreadPool::getShared();
+    const uint32_t vertexCount = input.vertexCount;
+    const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+
+    auto position = [&input](uint32_t v) {
+        return loadAttribute<glm::vec3>(input.positions, input.stride, v);
+    };
+    auto normal = [&input](uint32_t v) {
+        return loadAttribute<glm::vec3>(input.normals, input.stride, v);
+    };
+    auto texCoord = [&input](uint32_t v) {
+        return loadAttribute<glm::vec2>(input.texCoords, input.stride, v);
+    };
+
+    // Angle weighted tangent and bitangent of each triangle corner and
+    // handedness of each triangle, 0 if its texture coordinates are degenerate
+    std::vector<glm::vec3> cornerTangents(indices.size());
+    std::vector<glm::vec3> cornerBitangents(indices.size());
+    std::vector<int8_t> triangleSigns(triangleCount);
+
+    threadPool.parallelFor(triangleCount, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t t = begin; t < end; t++)
+        {
+            const uint32_t *triangle = &indices[3 * t];
+            glm::vec3 p[3] = { position(triangle[0]), position(triangle[1]), position(triangle[2]) };
+            glm::vec2 uv[3] = { texCoord(triangle[0]), texCoord(triangle[1]), texCoord(triangle[2]) };
+
+            glm::vec3 d1 = p[1] - p[0];
+            glm::vec3 d2 = p[2] - p[0];
+            glm::vec2 t21 = uv[1] - uv[0];
+            glm::vec2 t31 = uv[2] - uv[0];
+
+            // Twice the signed area in texture space
+            float signedArea = t21.x * t31.y - t21.y * t31.x;
+
+            // Directions of the U and V axes on the triangle, the division by
+            // the area is replaced by its sign since only the directions are kept
+            glm::vec3 faceTangent = t31.y * d1 - t21.y * d2;
+            glm::vec3 faceBitangent = t21.x * d2 - t31.x * d1;
+            if (signedArea < 0.f)
+            {
+                faceTangent = -faceTangent;
+                faceBitangent = -faceBitangent;
+            }
+
+            // The handedness compares the frame to the vertex normals, the
+            // sign of the area alone depends on the winding of the triangle
+            glm::vec3 n = normal(triangle[0]) + normal(triangle[1]) + normal(triangle[2]);
+            float handedness = glm::dot(glm::cross(n, faceTangent), faceBitangent);
+
+            bool degenerate =
+                std::abs(signedArea) <= std::numeric_limits<float>::min() ||
+                glm::dot(faceTangent, faceTangent) <= 0.f ||
+                handedness == 0.f ||
+                std::isfinite(signedArea) == false;
+
+            triangleSigns[t] = degenerate ? 0 : (handedness > 0.f ? 1 : -1);
+
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                glm::vec3 &cornerTangent = cornerTangents[3 * t + k];
+                glm::vec3 &cornerBitangent = cornerBitangents[3 * t + k];
+                cornerTangent = glm::vec3(0.f);
+                cornerBitangent = glm::vec3(0.f);
+                if (degenerate) continue;
+
+                glm::vec3 cornerNormal = normal(triangle[k]);
+                glm::vec3 e1 = projectOnPlane(p[(k + 1) % 3] - p[k], cornerNormal);
+                glm::vec3 e2 = projectOnPlane(p[(k + 2) % 3] - p[k], cornerNormal);
+                float angle = std::acos(glm::clamp(glm::dot(e1, e2), -1.f, 1.f));
+
+                cornerTangent = angle * projectOnPlane(faceTangent, cornerNormal);
+                cornerBitangent = angle * projectOnPlane(faceBitangent, cornerNormal);
+            }
+        }
+    }, MIN_RANGE_SIZE);
+
+    // Splits the vertices shared by mirrored and non mirrored triangles,
+    // MikkTSpace never averages tangents of opposite handedness
+    enum : uint8_t { USED_POSITIVE = 1, USED_NEGATIVE = 2 };
+    std::vector<uint8_t> vertexUsage(vertexCount, 0);
+    for (uint32_t t = 0; t < triangleCount; t++)
+    {
+        if (triangleSigns[t] == 0) continue;
+
+        uint8_t usage = triangleSigns[t] > 0 ? USED_POSITIVE : USED_NEGATIVE;
+        for (uint32_t k = 0; k < 3; k++)
+        {
+            vertexUsage[indices[3 * t + k]] |= usage;
+        }
+    }
+
+    splitVertices.clear();
+    std::vector<uint32_t> splitIndices(vertexCount, INVALID_INDEX);
+    for (uint32_t v = 0; v < vertexCount; v++)
+    {
+        if (vertexUsage[v] == (USED_POSITIVE | USED_NEGATIVE))
+        {
+            splitIndices[v] = vertexCount + static_cast<uint32_t>(splitVertices.size());
+            splitVertices.push_back(v);
+        }
+    }
+
+    for (uint32_t t = 0; t < triangleCount; t++)
+    {
+        if (triangleSigns[t] >= 0 || splitVertices.empty()) continue;
+
+        for (uint32_t k = 0; k < 3; k++)
+        {
+            uint32_t &index = indices[3 * t + k];
+            if (splitIndices[index] != INVALID_INDEX)
+            {
+                index = splitIndices[index];
+            }
+        }
+    }
+
+    // Corners of each vertex, so that the vertices are accumulated in
+    // parallel without atomics and in a deterministic order
+    const uint32_t totalCount = vertexCount + static_cast<uint32_t>(splitVertices.size());
+    std::vector<uint32_t> offsets(totalCount + 1, 0);
+    for (uint32_t index : indices)
+    {
+        offsets[index + 1]++;
+    }
+    for (uint32_t v = 0; v < totalCount; v++)
+    {
+        offsets[v + 1] += offsets[v];
+    }
+
+    std::vector<uint32_t> corners(indices.size());
+    {
+        std::vector<uint32_t> fillOffsets(offsets.begin(), offsets.end() - 1);
+        for (uint32_t c = 0; c < static_cast<uint32_t>(indices.size()); c++)
+        {
+            corners[fillOffsets[indices[c]]++] = c;
+        }
+    }
+
+    std::vector<glm::vec4> tangents(totalCount);
+
+    threadPool.parallelFor(totalCount, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t v = begin; v < end; v++)
+        {
+            const bool isSplit = v >= vertexCount;
+            const uint32_t source = isSplit ? splitVertices[v - vertexCount] : v;
+            const glm::vec3 n = normal(source);
+
+            glm::vec3 sum(0.f);
+            glm::vec3 bitangentSum(0.f);
+            for (uint32_t i = offsets[v]; i < offsets[v + 1]; i++)
+            {
+                sum += cornerTangents[corners[i]];
+                bitangentSum += cornerBitangents[corners[i]];
+            }
+
+            glm::vec3 tangent = projectOnPlane(sum, n);
+            if (glm::dot(tangent, tangent) <= 0.f)
+            {
+                // No usable texture coordinates around the vertex
+                glm::vec3 axis = std::abs(n.x) < 0.9f ? glm::vec3(1.f, 0.f, 0.f) : glm::vec3(0.f, 1.f, 0.f);
+                tangent = projectOnPlane(axis, n);
+            }
+
+            // Handedness of the orthogonalized frame, as MikkTSpace. The
+            // copies always belong to the mirrored triangles, which also
+            // decide when the bitangents cancel out
+            float sign = (isSplit || vertexUsage[v] == USED_NEGATIVE) ? -1.f : 1.f;
+            float handedness = glm::dot(glm::cross(n, tangent), bitangentSum);
+            if (handedness != 0.f)
+            {
+                sign = handedness > 0.f ? 1.f : -1.f;
+            }
+            tangents[v] = glm::vec4(tangent, sign);
+        }
+    }, MIN_RANGE_SIZE);
+
+    return tangents;
+}
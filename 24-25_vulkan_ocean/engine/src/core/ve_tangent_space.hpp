@@ -0,0 +1,47 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#pragma once
+
+#include "ve_settings.hpp"
+
+namespace meshopt
+{
+    /// @brief Input of generateTangents, the attributes are read from
+    /// interleaved vertices: each pointer is the first attribute and the
+    /// next vertex is stride bytes further.
+    struct TangentSpaceInput
+    {
+        /// vec3 positions.
+        const float *positions = nullptr;
+        /// vec3 unit normals.
+        const float *normals = nullptr;
+        /// vec2 texture coordinates.
+        const float *texCoords = nullptr;
+        size_t stride = 0;
+        uint32_t vertexCount = 0;
+    };
+
+    /// @brief Per-vertex tangent frames following the MikkTSpace conventions.
+    /// Face tangents are projected on the plane of each vertex normal and
+    /// accumulated with corner angle weights, as are the face bitangents.
+    /// The w component is the handedness, sign(dot(cross(n, t), b)) with the
+    /// accumulated bitangent b, whatever the winding of the triangles: the
+    /// shader rebuilds the bitangent as w * cross(normal, tangent.xyz).
+    /// A vertex used by both mirrored and non-mirrored triangles is split,
+    /// the indices of the mirrored ones are redirected to the copy.
+    /// Triangles with degenerate texture coordinates do not contribute, and a
+    /// vertex without any contribution gets an arbitrary tangent orthogonal
+    /// to its normal. Large meshes are processed on the shared thread pool.
+    /// @param indices triangle list, updated when vertices are split.
+    /// @param splitVertices receives the source vertex of each vertex
+    /// appended by the splits, vertex vertexCount + i copies splitVertices[i].
+    /// @return one tangent per vertex, including the appended ones.
+    std::vector<glm::vec4> generateTangents(
+        const TangentSpaceInput &input,
+        std::vector<uint32_t> &indices,
+        std::vector<uint32_t> &splitVertices);
+}
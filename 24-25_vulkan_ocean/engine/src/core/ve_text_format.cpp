@@ -0,0 +1,41 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#include "core/ve_text_format.hpp"
+
+std::string textformat::escapeJSON(const std::string &text)
+{
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text)
+    {
+        if (static_cast<unsigned char>(c) < 0x20)
+        {
+            // Control characters are not allowed in a JSON string
+            char code[7];
+            snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned int>(c));
+            escaped += code;
+            continue;
+        }
+        if (c == '"' || c == '\\') escaped.push_back('\\');
+        escaped.push_back(c);
+    }
+    return escaped;
+}
+
+std::string textformat::quoteCSV(const std::string &text)
+{
+    std::string quoted;
+    quoted.reserve(text.size() + 2);
+    quoted.push_back('"');
+    for (char c : text)
+    {
+        if (c == '"') quoted.push_back('"');
+        quoted.push_back(c);
+    }
+    quoted.push_back('"');
+    return quoted;
+}
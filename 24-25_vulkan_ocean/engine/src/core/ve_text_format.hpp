@@ -0,0 +1,20 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#pragma once
+
+#include "ve_settings.hpp"
+
+/// @brief Escaping of the strings written in the trace and profile files.
+namespace textformat
+{
+    /// @brief Content of a JSON string, without the surrounding quotes.
+    /// Quotes and backslashes are escaped, control characters become \u00XX.
+    std::string escapeJSON(const std::string &text);
+
+    /// @brief CSV field, quoted with its embedded quotes doubled (RFC 4180).
+    std::string quoteCSV(const std::string &text);
+}
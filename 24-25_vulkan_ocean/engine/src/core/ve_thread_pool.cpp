@@ -0,0 +1,158 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#include "core/ve_thread_pool.hpp"
+#include "core/ve_cpu_trace.hpp"
+
+#include <exception>
+
+ThreadPool::ThreadPool(uint32_t threadCount)
+    : m_workers{}
+    , m_tasks{}
+    , m_activeCount{ 0 }
+    , m_stop{ false }
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_workers.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++)
+    {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_taskCondition.notify_all();
+
+    for (std::thread &worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+ThreadPool &ThreadPool::getShared()
+{
+    static ThreadPool sharedPool;
+    return sharedPool;
+}
+
+void ThreadPool::enqueue(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push(std::move(task));
+    }
+    m_taskCondition.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [this] {
+        return m_tasks.empty() && m_activeCount == 0;
+    });
+}
+
+void ThreadPool::parallelFor(
+    uint32_t count,
+    const std::function<void(uint32_t, uint32_t)> &function,
+    uint32_t minRangeSize)
+{
+    if (count == 0) return;
+
+    minRangeSize = std::max(1u, minRangeSize);
+    uint32_t rangeCount = std::min(getThreadCount() + 1, (count + minRangeSize - 1) / minRangeSize);
+    rangeCount = std::max(1u, rangeCount);
+
+    const uint32_t rangeSize = (count + rangeCount - 1) / rangeCount;
+
+    // Counts the ranges of this call only, the pool may run other tasks
+    std::mutex doneMutex;
+    std::condition_variable doneCondition;
+    uint32_t remaining = rangeCount - 1;
+    std::exception_ptr firstError{};
+
+    // The tasks refer to the locals of this call, every range must be done
+    // before leaving it, even when one of them throws
+    auto runRange = [&](uint32_t begin, uint32_t end) {
+        try
+        {
+            if (begin < end) function(begin, end);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (firstError == nullptr) firstError = std::current_exception();
+        }
+    };
+
+    for (uint32_t r = 1; r < rangeCount; r++)
+    {
+        uint32_t begin = r * rangeSize;
+        uint32_t end = std::min(count, begin + rangeSize);
+
+        enqueue([&, begin, end] {
+            runRange(begin, end);
+
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (--remaining == 0) doneCondition.notify_one();
+        });
+    }
+
+    runRange(0, std::min(count, rangeSize));
+
+    std::unique_lock<std::mutex> lock(doneMutex);
+    doneCondition.wait(lock, [&] { return remaining == 0; });
+
+    if (firstError)
+    {
+        std::rethrow_exception(firstError);
+    }
+}
+
+void ThreadPool::workerLoop()
+{
+    VE_TRACE_THREAD_NAME("Worker");
+
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_taskCondition.wait(lock, [this] {
+                return m_stop || m_tasks.empty() == false;
+            });
+
+            if (m_stop && m_tasks.empty()) return;
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+            m_activeCount++;
+        }
+
+        {
+            VE_TRACE_SCOPE("Task");
+            task();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_activeCount--;
+            if (m_tasks.empty() && m_activeCount == 0)
+            {
+                m_doneCondition.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,60 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#pragma once
+
+#include "ve_settings.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+/// @brief Fixed set of worker threads executing queued tasks.
+class ThreadPool
+{
+public:
+    /// @param threadCount number of workers, 0 = one per hardware thread.
+    ThreadPool(uint32_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /// @brief Pool shared by the engine, created on first use.
+    static ThreadPool &getShared();
+
+    uint32_t getThreadCount() const { return static_cast<uint32_t>(m_workers.size()); }
+
+    void enqueue(std::function<void()> task);
+
+    /// @brief Blocks until every queued task is complete.
+    void wait();
+
+    /// @brief Splits [0, count) into contiguous ranges run on the workers and
+    /// waits for them. The calling thread runs one of the ranges.
+    /// If ranges throw, the first exception is rethrown once every range
+    /// is done.
+    /// @param function called as function(begin, end) for each range.
+    /// @param minRangeSize ranges are not split below this size.
+    void parallelFor(
+        uint32_t count,
+        const std::function<void(uint32_t, uint32_t)> &function,
+        uint32_t minRangeSize = 1);
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> m_workers;
+    std::queue<std::function<void()>> m_tasks;
+
+    std::mutex m_mutex;
+    std::condition_variable m_taskCondition;
+    std::condition_variable m_doneCondition;
+    uint32_t m_activeCount;
+    bool m_stop;
+};
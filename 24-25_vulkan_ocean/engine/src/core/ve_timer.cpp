@@ -8,6 +8,7 @@
 
 Timer::Timer()
 {
+    m_frequency = SDL_GetPerformanceFrequency();
     m_startTime = 0;
     m_currentTime = 0;
     m_previousTime = 0;
@@ -17,23 +18,33 @@ Timer::Timer()
     m_elapsed = 0;
     m_unscaledElapsed = 0;
 
-    m_maxDelta = 100;
+    m_maxDelta = 100000000;
     m_scale = 1.f;
 }
 
+Uint64 Timer::counterToNS(Uint64 counter) const
+{
+    // Sans débordement pour les grandes valeurs du compteur
+    return (counter / m_frequency) * 1000000000 +
+        (counter % m_frequency) * 1000000000 / m_frequency;
+}
+
 void Timer::start()
 {
-    m_currentTime = SDL_GetTicks64();
-    m_previousTime = SDL_GetTicks64();
+    m_startTime = counterToNS(SDL_GetPerformanceCounter());
+    m_currentTime = m_startTime;
+    m_previousTime = m_startTime;
     m_delta = 0;
+    m_histogram.clear();
 }
 
 void Timer::update()
 {
     m_previousTime = m_currentTime;
-    m_currentTime = SDL_GetTicks64();
+    m_currentTime = counterToNS(SDL_GetPerformanceCounter());
 
     m_unscaledDelta = m_currentTime - m_previousTime;
+    m_histogram.addSample(m_unscaledDelta);
     if (m_unscaledDelta > m_maxDelta)
     {
         m_unscaledDelta = m_maxDelta;
@@ -44,9 +55,19 @@ void Timer::update()
     m_elapsed += m_delta;
 }
 
+void Timer::update(float deltaTime)
+{
+    advance(static_cast<Uint64>(static_cast<double>(deltaTime) * 1e9));
+}
+
 void Timer::update(Uint64 deltaTimeMS)
 {
-    m_unscaledDelta = deltaTimeMS;
+    advance(deltaTimeMS * 1000000);
+}
+
+void Timer::advance(Uint64 deltaTimeNS)
+{
+    m_unscaledDelta = deltaTimeNS;
     if (m_unscaledDelta > m_maxDelta)
     {
         m_unscaledDelta = m_maxDelta;
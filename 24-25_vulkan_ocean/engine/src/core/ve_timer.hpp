@@ -7,9 +7,11 @@
 #pragma once
 
 #include "ve_settings.hpp"
+#include "core/ve_frame_time_histogram.hpp"
 
 /// @ingroup Timer
 /// @brief Structure représentant un chronomètre.
+/// Les temps sont mesurés en nanosecondes avec SDL_GetPerformanceCounter().
 class Timer
 {
 public:
@@ -35,9 +37,29 @@ public:
     Uint64 getElapsedMS() const;
     Uint64 getUnscaledElapsedMS() const;
 
+    Uint64 getDeltaNS() const;
+    Uint64 getUnscaledDeltaNS() const;
+
+    /// @brief Renvoie l'histogramme des durées réelles des frames mesurées
+    /// par update(), avant le bornage par le delta maximal.
+    FrameTimeHistogram &getHistogram();
+    const FrameTimeHistogram &getHistogram() const;
+
 protected:
     /// @protected
-    /// @brief Temps de départ.
+    /// @brief Avance le chronomètre d'une durée fixe en nanosecondes.
+    void advance(Uint64 deltaTimeNS);
+
+    /// @protected
+    /// @brief Convertit une durée du compteur de performance en nanosecondes.
+    Uint64 counterToNS(Uint64 counter) const;
+
+    /// @protected
+    /// @brief Fréquence du compteur de performance.
+    Uint64 m_frequency;
+
+    /// @protected
+    /// @brief Temps de départ, en nanosecondes.
     Uint64 m_startTime;
 
     /// @protected
@@ -59,11 +81,15 @@ protected:
 
     Uint64 m_elapsed;
     Uint64 m_unscaledElapsed;
+
+    /// @protected
+    /// @brief Durées réelles des dernières frames.
+    FrameTimeHistogram m_histogram;
 };
 
 inline void Timer::setMaximumDeltaTime(float maxDelta)
 {
-    m_maxDelta = static_cast<Uint64>(maxDelta * 1000.0);
+    m_maxDelta = static_cast<Uint64>(maxDelta * 1e9);
 }
 
 inline void Timer::setTimeScale(float scale)
@@ -73,7 +99,7 @@ inline void Timer::setTimeScale(float scale)
 
 inline float Timer::getDelta() const
 {
-    return static_cast<float>(m_delta) / 1000.f;
+    return static_cast<float>(static_cast<double>(m_delta) * 1e-9);
 }
 
 inline float Timer::getTimeScale() const
@@ -83,40 +109,56 @@ inline float Timer::getTimeScale() const
 
 inline float Timer::getUnscaledDelta() const
 {
-    return static_cast<float>(m_unscaledDelta) / 1000.f;
+    return static_cast<float>(static_cast<double>(m_unscaledDelta) * 1e-9);
 }
 
 inline float Timer::getElapsed() const
 {
-    return static_cast<float>(m_elapsed) / 1000.f;
+    return static_cast<float>(static_cast<double>(m_elapsed) * 1e-9);
 }
 
 inline float Timer::getUnscaledElapsed() const
 {
-    return static_cast<float>(m_unscaledElapsed) / 1000.f;
+    return static_cast<float>(static_cast<double>(m_unscaledElapsed) * 1e-9);
 }
 
 inline Uint64 Timer::getDeltaMS() const
 {
-    return m_delta;
+    return m_delta / 1000000;
 }
 
 inline Uint64 Timer::getUnscaledDeltaMS() const
 {
-    return m_unscaledElapsed;
+    return m_unscaledDelta / 1000000;
 }
 
 inline Uint64 Timer::getElapsedMS() const
 {
-    return m_elapsed;
+    return m_elapsed / 1000000;
 }
 
 inline Uint64 Timer::getUnscaledElapsedMS() const
 {
-    return m_unscaledElapsed;
+    return m_unscaledElapsed / 1000000;
 }
 
-inline void Timer::update(float deltaTime)
+inline Uint64 Timer::getDeltaNS() const
 {
-    update(static_cast<Uint64>(deltaTime * 1000.0));
+    return m_delta;
+}
+
+inline Uint64 Timer::getUnscaledDeltaNS() const
+{
+    return m_unscaledDelta;
 }
+
+inline FrameTimeHistogram &Timer::getHistogram()
+{
+    return m_histogram;
+}
+
+inline const FrameTimeHistogram &Timer::getHistogram() const
+{
+    return m_histogram;
+}
+
@@ -10,15 +10,35 @@
 #include "vulkan/ve_instance.hpp"
 #include "vulkan/ve_window.hpp"
 #include "vulkan/ve_device.hpp"
+#include "vulkan/ve_memory_allocator.hpp"
 #include "vulkan/ve_base.hpp"
 #include "vulkan/ve_framework.hpp"
 #include "vulkan/ve_buffer.hpp"
+#include "vulkan/ve_staging.hpp"
+#include "vulkan/ve_uniform_ring.hpp"
 #include "vulkan/ve_renderer.hpp"
 #include "vulkan/ve_image.hpp"
 #include "vulkan/ve_descriptor.hpp"
+#include "vulkan/ve_command_recorder.hpp"
+#include "vulkan/ve_gpu_profiler.hpp"
 #include "vulkan/ve_pipeline.hpp"
+#include "vulkan/ve_pipeline_cache.hpp"
+#include "vulkan/ve_pipeline_build_queue.hpp"
 #include "vulkan/ve_tools.hpp"
 
 #include "core/ve_timer.hpp"
+#include "core/ve_frame_time_histogram.hpp"
+#include "core/ve_cpu_trace.hpp"
+#include "core/ve_text_format.hpp"
+#include "core/ve_frame_pacer.hpp"
+#include "core/ve_fft.hpp"
+#include "core/ve_image_writer.hpp"
+#include "core/ve_mesh_optimizer.hpp"
+#include "core/ve_tangent_space.hpp"
+#include "core/ve_mapped_file.hpp"
+#include "core/ve_file_io.hpp"
+#include "core/ve_range_allocator.hpp"
+#include "core/ve_file_watcher.hpp"
+#include "core/ve_thread_pool.hpp"
 #include "core/ve_input_manager.hpp"
 #include "core/ve_input_group.hpp"
@@ -81,14 +81,33 @@ VulkanBase::VulkanBase(
     InstanceBuilder & instanceBuilder,
     DeviceBuilder &deviceBuilder,
     Window &window)
-    : m_window{ window }
+    : m_window{ &window }
+    , m_surface{ VK_NULL_HANDLE }
+{
+    init(instanceBuilder, deviceBuilder);
+}
+
+VulkanBase::VulkanBase(
+    InstanceBuilder &instanceBuilder,
+    DeviceBuilder &deviceBuilder)
+    : m_window{ nullptr }
+    , m_surface{ VK_NULL_HANDLE }
+{
+    init(instanceBuilder, deviceBuilder);
+}
+
+void VulkanBase::init(InstanceBuilder &instanceBuilder, DeviceBuilder &deviceBuilder)
 {
     //m_dynamicDispatcher = vk::DispatchLoaderDynamic();
     //m_dynamicDispatcher.init(vkGetInstanceProcAddr);
 
     // Create the instance
     m_instance = instanceBuilder.build();
-    initDispatchLoaderStaticWithInstance();
+    if (instanceBuilder.isExtensionEnabled(VK_EXT_DEBUG_UTILS_EXTENSION_NAME))
+    {
+        // A headless run on a CI box usually has no validation layer
+        initDispatchLoaderStaticWithInstance();
+    }
 
     //m_dynamicDispatcher.init(m_instance);
 
@@ -111,7 +130,10 @@ VulkanBase::VulkanBase(
     }
 
     // Create the surface
-    m_window.createSurface(m_instance, &m_surface);
+    if (m_window)
+    {
+        m_window->createSurface(m_instance, &m_surface);
+    }
 
     // Create the physical device
     createPhysicalDevice(deviceBuilder);
@@ -121,9 +143,13 @@ VulkanBase::VulkanBase(
 
     //m_dynamicDispatcher.init(m_device);
 
-    // Create the pipeline cache
-    vk::PipelineCacheCreateInfo pipelineCacheCI{};
-    m_pipelineCache = m_device.createPipelineCache(pipelineCacheCI);
+    // Create the memory allocator used by the buffers and the images
+    m_memoryAllocator = std::make_unique<MemoryAllocator>(
+        m_device, m_memoryProperties, m_properties.limits);
+
+    // Create the pipeline cache, warm if a previous run saved it
+    m_pipelineCache = std::make_unique<PipelineCache>(
+        m_device, m_properties, deviceBuilder.getPipelineCachePath());
 
     // Create the command pool
     createCommandPool();
@@ -131,12 +157,22 @@ VulkanBase::VulkanBase(
 
 VulkanBase::~VulkanBase()
 {
+    m_memoryAllocator.reset();
+
     m_device.destroyCommandPool(m_commandPool);
-    m_device.destroyPipelineCache(m_pipelineCache);
+
+    m_pipelineCache->save();
+    m_pipelineCache.reset();
     m_device.destroy();
 
-    m_instance.destroySurfaceKHR(m_surface);
-    m_instance.destroyDebugUtilsMessengerEXT(m_debugUtilsMessenger);
+    if (m_surface)
+    {
+        m_instance.destroySurfaceKHR(m_surface);
+    }
+    if (m_debugUtilsMessenger)
+    {
+        m_instance.destroyDebugUtilsMessengerEXT(m_debugUtilsMessenger);
+    }
     m_instance.destroy();
 }
 
@@ -208,6 +244,23 @@ bool VulkanBase::checkPhysicalDeviceProperties(
         }
     }
 
+    // Headless: any queue family supporting graphics
+    if (!m_surface)
+    {
+        std::vector<vk::QueueFamilyProperties> familyProperties = physicalDevice.getQueueFamilyProperties();
+        for (uint32_t i = 0; i < familyProperties.size(); i++)
+        {
+            if ((familyProperties[i].queueCount > 0) &&
+                (familyProperties[i].queueFlags & vk::QueueFlagBits::eGraphics))
+            {
+                selectedGraphicsQueueFamilyIndex = i;
+                selectedPresentQueueFamilyIndex = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
     // Check swapchain support
     std::vector<vk::SurfaceFormatKHR> surfaceFormats = physicalDevice.getSurfaceFormatsKHR(m_surface);
     std::vector<vk::PresentModeKHR> presentModes = physicalDevice.getSurfacePresentModesKHR(m_surface);
@@ -282,7 +335,8 @@ void VulkanBase::createLogicalDevice(DeviceBuilder &deviceBuilder)
     if (m_presentQueueFamilyIndex != m_graphicsQueueFamilyIndex)
         deviceBuilder.addQueue(m_presentQueueFamilyIndex);
 
-    // Create the logical device
+    // Create the logical device, with the optional features the device has
+    deviceBuilder.enableSupportedFeatures(m_features);
     m_device = deviceBuilder.build(m_physicalDevice);
     m_enabledFeatures = deviceBuilder.getDesiredFeatures();
 
@@ -10,6 +10,8 @@
 #include "vulkan/ve_instance.hpp"
 #include "vulkan/ve_device.hpp"
 #include "vulkan/ve_window.hpp"
+#include "vulkan/ve_memory_allocator.hpp"
+#include "vulkan/ve_pipeline_cache.hpp"
 
 class VulkanBase
 {
@@ -19,10 +21,17 @@ public:
         DeviceBuilder &deviceBuilder,
         Window &window);
 
+    /// @brief Headless base without window nor surface, for offscreen rendering.
+    /// The present queue is the graphics queue.
+    VulkanBase(
+        InstanceBuilder &instanceBuilder,
+        DeviceBuilder &deviceBuilder);
+
     ~VulkanBase();
 
     vk::Instance getInstance() const { return m_instance; }
     vk::SurfaceKHR getSurface() const { return m_surface; }
+    bool isHeadless() const { return m_window == nullptr; }
     vk::PhysicalDevice getPhysicalDevice() const { return m_physicalDevice; }
     vk::PhysicalDeviceMemoryProperties getMemoryProperties() const { return m_memoryProperties; }
     vk::PhysicalDeviceFeatures getFeatures() const { return m_features; }
@@ -33,11 +42,17 @@ public:
     vk::Queue getPresentQueue() { return m_presentQueue; }
     uint32_t getGraphicsQueueFamilyIndex() const { return m_graphicsQueueFamilyIndex; }
     uint32_t getPresentQueueFamilyIndex() const { return m_presentQueueFamilyIndex; }
-    vk::PipelineCache getPipelineCache() const { return m_pipelineCache; }
+    vk::PipelineCache getPipelineCache() const { return m_pipelineCache->getHandle(); }
+    const PipelineCacheStats &getPipelineCacheStats() const { return m_pipelineCache->getStats(); }
+
+    /// @brief Writes the pipeline cache to its file, also done on destruction.
+    void savePipelineCache() const { m_pipelineCache->save(); }
 
     vk::CommandPool getCommandPool() { return m_commandPool; }
+    MemoryAllocator &getMemoryAllocator() { return *m_memoryAllocator; }
 
 private:
+    void init(InstanceBuilder &instanceBuilder, DeviceBuilder &deviceBuilder);
     void createPhysicalDevice(DeviceBuilder &deviceBuilder);
     bool checkPhysicalDeviceProperties(
         vk::PhysicalDevice physicalDevice,
@@ -49,7 +64,8 @@ private:
     void createCommandPool();
     void initDispatchLoaderStaticWithInstance();
 
-    Window &m_window;
+    /// nullptr when headless.
+    Window *m_window;
 
     vk::Instance m_instance;
     vk::SurfaceKHR m_surface;
@@ -59,7 +75,7 @@ private:
     //vk::DispatchLoaderDynamic m_dynamicDispatcher;
     vk::DebugUtilsMessengerEXT m_debugUtilsMessenger;
 
-    vk::PipelineCache m_pipelineCache;
+    std::unique_ptr<PipelineCache> m_pipelineCache;
     vk::PhysicalDeviceMemoryProperties m_memoryProperties;
 
     uint32_t m_graphicsQueueFamilyIndex;
@@ -72,4 +88,6 @@ private:
     vk::PhysicalDeviceFeatures m_enabledFeatures;
 
     vk::CommandPool m_commandPool;
+
+    std::unique_ptr<MemoryAllocator> m_memoryAllocator;
 };
\ No newline at end of file
@@ -11,6 +11,19 @@
 #include <cstring>
 #include <iostream>
 
+namespace
+{
+    MemoryAllocator &findAllocator(vk::Device device)
+    {
+        MemoryAllocator *allocator = MemoryAllocator::find(device);
+        if (allocator == nullptr)
+        {
+            throw std::runtime_error("no memory allocator for this device");
+        }
+        return *allocator;
+    }
+}
+
 Buffer::Buffer(
     vk::Device device,
     const vk::PhysicalDeviceMemoryProperties &memoryProperties,
@@ -18,9 +31,12 @@ Buffer::Buffer(
     vk::DeviceSize elementSize,
     vk::BufferUsageFlags usageFlags,
     vk::MemoryPropertyFlags memoryPropertyFlags,
-    vk::DeviceSize minOffsetAlignment
+    vk::DeviceSize minOffsetAlignment,
+    AllocationLifetime lifetime
 )
     : m_device{ device }
+    , m_allocator{ findAllocator(device) }
+    , m_allocation{}
     , m_elementSize{ elementSize }
     , m_elementCount{ elementCount }
     , m_usageFlags{ usageFlags }
@@ -39,36 +55,29 @@ Buffer::Buffer(
     m_buffer = m_device.createBuffer(bufferCI);
 
     vk::MemoryRequirements memoryRequirements = m_device.getBufferMemoryRequirements(m_buffer);
-    vk::MemoryAllocateInfo memoryAllocateInfo{};
-    memoryAllocateInfo.allocationSize = memoryRequirements.size;
-    memoryAllocateInfo.memoryTypeIndex = tools::findMemoryTypeIndex(
-        memoryProperties, memoryRequirements.memoryTypeBits, memoryPropertyFlags);
-
-    m_memory = m_device.allocateMemory(memoryAllocateInfo);
-    m_device.bindBufferMemory(m_buffer, m_memory, 0);
+    m_allocation = m_allocator.allocate(memoryRequirements, memoryPropertyFlags, false, lifetime);
+    m_device.bindBufferMemory(m_buffer, m_allocation.memory, m_allocation.offset);
 }
 
 Buffer::~Buffer()
 {
     unmap();
-    m_device.freeMemory(m_memory);
     m_device.destroyBuffer(m_buffer);
+    m_allocator.free(m_allocation);
 }
 
 void Buffer::map(vk::DeviceSize size, vk::DeviceSize offset)
 {
-    assert(m_buffer && m_memory && "Called map on buffer before create");
+    assert(m_buffer && m_allocation.memory && "Called map on buffer before create");
+    assert(m_allocation.mapped && "Cannot map a buffer that is not host visible");
 
-    m_mapped = m_device.mapMemory(m_memory, offset, size);
+    // The memory block is persistently mapped
+    m_mapped = static_cast<uint8_t *>(m_allocation.mapped) + offset;
 }
 
 void Buffer::unmap()
 {
-    if (m_mapped)
-    {
-        m_device.unmapMemory(m_memory);
-        m_mapped = nullptr;
-    }
+    m_mapped = nullptr;
 }
 
 vk::DescriptorBufferInfo Buffer::getDescriptorInfo(vk::DeviceSize size, vk::DeviceSize offset)
@@ -92,6 +101,11 @@ void Buffer::writeToBuffer(void *data, vk::DeviceSize size, vk::DeviceSize offse
     }
 }
 
+void Buffer::invalidate(vk::DeviceSize size, vk::DeviceSize offset)
+{
+    m_allocator.invalidate(m_allocation, offset, size);
+}
+
 void Buffer::writeElementToBuffer(void *data, int index)
 {
     assert(m_mapped && "Cannot copy to unmapped buffer");
@@ -8,7 +8,11 @@
 
 #include "ve_settings.hpp"
 #include "vulkan/ve_device.hpp"
+#include "vulkan/ve_memory_allocator.hpp"
 
+/// @brief Buffer sub-allocated by the MemoryAllocator of its device.
+/// Host visible buffers stay mapped, map() and unmap() only expose the
+/// pointer.
 class Buffer
 {
 public:
@@ -19,7 +23,8 @@ public:
         vk::DeviceSize elementSize,
         vk::BufferUsageFlags usageFlags,
         vk::MemoryPropertyFlags memoryPropertyFlags,
-        vk::DeviceSize minOffsetAlignment = 1);
+        vk::DeviceSize minOffsetAlignment = 1,
+        AllocationLifetime lifetime = AllocationLifetime::ePersistent);
     ~Buffer();
 
     Buffer(const Buffer&) = delete;
@@ -42,10 +47,15 @@ public:
     void writeToBuffer(void *data, vk::DeviceSize size = VK_WHOLE_SIZE, vk::DeviceSize offset = 0);
     void writeElementToBuffer(void *data, int index);
 
+    /// @brief Makes the device writes visible to the mapped pointer, needed
+    /// before a host read when the memory is not host coherent.
+    void invalidate(vk::DeviceSize size = VK_WHOLE_SIZE, vk::DeviceSize offset = 0);
+
 private:
     vk::Device m_device;
     vk::Buffer m_buffer;
-    vk::DeviceMemory m_memory;
+    MemoryAllocator &m_allocator;
+    MemoryAllocation m_allocation;
     void* m_mapped = nullptr;
 
     vk::DeviceSize m_bufferSize;
@@ -0,0 +1,118 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#include "vulkan/ve_command_recorder.hpp"
+
+CommandRecorder::CommandRecorder()
+    : m_commandBuffer{ VK_NULL_HANDLE }
+    , m_graphicsState{}
+    , m_computeState{}
+    , m_recordedCount{ 0 }
+    , m_skippedCount{ 0 }
+{
+}
+
+CommandRecorder::CommandRecorder(vk::CommandBuffer commandBuffer)
+    : CommandRecorder()
+{
+    begin(commandBuffer);
+}
+
+void CommandRecorder::begin(vk::CommandBuffer commandBuffer)
+{
+    m_commandBuffer = commandBuffer;
+    m_recordedCount = 0;
+    m_skippedCount = 0;
+    invalidate();
+}
+
+void CommandRecorder::invalidate()
+{
+    m_graphicsState = BindPointState{};
+    m_computeState = BindPointState{};
+}
+
+void CommandRecorder::bindPipeline(vk::PipelineBindPoint bindPoint, vk::Pipeline pipeline)
+{
+    assert(m_commandBuffer && "begin() must be called first");
+
+    BindPointState &state = getState(bindPoint);
+    if (state.pipeline == pipeline)
+    {
+        m_skippedCount++;
+        return;
+    }
+
+    // Binding a pipeline does not disturb the bound descriptor sets
+    m_commandBuffer.bindPipeline(bindPoint, pipeline);
+    state.pipeline = pipeline;
+    m_recordedCount++;
+}
+
+void CommandRecorder::bindDescriptorSets(
+    vk::PipelineBindPoint bindPoint,
+    vk::PipelineLayout layout,
+    uint32_t firstSet,
+    vk::ArrayProxy<const vk::DescriptorSet> const &descriptorSets,
+    vk::ArrayProxy<const uint32_t> const &dynamicOffsets)
+{
+    assert(m_commandBuffer && "begin() must be called first");
+
+    const uint32_t setCount = descriptorSets.size();
+    assert(setCount > 0 && firstSet + setCount <= MAX_BOUND_SETS);
+
+    BindPointState &state = getState(bindPoint);
+
+    // The dynamic offsets are matched per bind command because the recorder
+    // does not know how many of them belong to each set
+    bool isRedundant = (state.layout == layout);
+    if (isRedundant)
+    {
+        const BoundSet &first = state.sets[firstSet];
+        isRedundant =
+            first.firstSet == firstSet &&
+            first.setCount == setCount &&
+            first.dynamicOffsets.size() == dynamicOffsets.size() &&
+            std::equal(dynamicOffsets.begin(), dynamicOffsets.end(), first.dynamicOffsets.begin());
+    }
+    for (uint32_t i = 0; isRedundant && i < setCount; i++)
+    {
+        isRedundant = (state.sets[firstSet + i].set == descriptorSets.data()[i]);
+    }
+    if (isRedundant)
+    {
+        m_skippedCount++;
+        return;
+    }
+
+    m_commandBuffer.bindDescriptorSets(bindPoint, layout, firstSet, descriptorSets, dynamicOffsets);
+    m_recordedCount++;
+
+    if (state.layout != layout)
+    {
+        // Conservative: an other layout may disturb the sets bound before
+        state.sets = {};
+        state.layout = layout;
+    }
+    for (uint32_t i = 0; i < setCount; i++)
+    {
+        BoundSet &bound = state.sets[firstSet + i];
+        bound.set = descriptorSets.data()[i];
+        bound.firstSet = firstSet;
+        bound.setCount = setCount;
+        bound.dynamicOffsets.clear();
+    }
+    state.sets[firstSet].dynamicOffsets.assign(dynamicOffsets.begin(), dynamicOffsets.end());
+}
+
+CommandRecorder::BindPointState &CommandRecorder::getState(vk::PipelineBindPoint bindPoint)
+{
+    assert(
+        (bindPoint == vk::PipelineBindPoint::eGraphics ||
+         bindPoint == vk::PipelineBindPoint::eCompute) &&
+        "Unsupported bind point");
+    return (bindPoint == vk::PipelineBindPoint::eCompute) ? m_computeState : m_graphicsState;
+}
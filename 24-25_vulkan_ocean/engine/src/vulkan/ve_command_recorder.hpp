@@ -0,0 +1,73 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#pragma once
+
+#include "ve_settings.hpp"
+
+/// @brief Thin wrapper around a command buffer that remembers the bound
+/// pipelines and descriptor sets of the graphics and compute bind points,
+/// and skips the bind commands that would not change anything.
+/// The state is only valid while every bind goes through the recorder,
+/// call invalidate() after handing the command buffer to other code.
+class CommandRecorder
+{
+public:
+    static constexpr uint32_t MAX_BOUND_SETS = 4;
+
+    CommandRecorder();
+    explicit CommandRecorder(vk::CommandBuffer commandBuffer);
+
+    /// @brief Starts recording in a command buffer, forgets the bound state.
+    void begin(vk::CommandBuffer commandBuffer);
+
+    /// @brief Forgets the bound state, the next binds are always recorded.
+    void invalidate();
+
+    void bindPipeline(vk::PipelineBindPoint bindPoint, vk::Pipeline pipeline);
+
+    void bindDescriptorSets(
+        vk::PipelineBindPoint bindPoint,
+        vk::PipelineLayout layout,
+        uint32_t firstSet,
+        vk::ArrayProxy<const vk::DescriptorSet> const &descriptorSets,
+        vk::ArrayProxy<const uint32_t> const &dynamicOffsets = nullptr);
+
+    vk::CommandBuffer getCommandBuffer() const { return m_commandBuffer; }
+
+    /// @brief Number of bind commands recorded since begin().
+    uint32_t getRecordedCount() const { return m_recordedCount; }
+    /// @brief Number of redundant bind commands skipped since begin().
+    uint32_t getSkippedCount() const { return m_skippedCount; }
+
+private:
+    struct BoundSet
+    {
+        vk::DescriptorSet set;
+        /// Index of the first set of the bind command that bound this set.
+        uint32_t firstSet = 0;
+        /// Number of sets of that command.
+        uint32_t setCount = 0;
+        /// Dynamic offsets of that command, only kept by its first set.
+        std::vector<uint32_t> dynamicOffsets;
+    };
+
+    struct BindPointState
+    {
+        vk::Pipeline pipeline;
+        vk::PipelineLayout layout;
+        std::array<BoundSet, MAX_BOUND_SETS> sets;
+    };
+
+    BindPointState &getState(vk::PipelineBindPoint bindPoint);
+
+    vk::CommandBuffer m_commandBuffer;
+    BindPointState m_graphicsState;
+    BindPointState m_computeState;
+
+    uint32_t m_recordedCount;
+    uint32_t m_skippedCount;
+};
@@ -82,6 +82,19 @@ vk::DescriptorSetLayout DescriptorSetLayoutBuilder::build(vk::Device device)
     return device.createDescriptorSetLayout(descriptorSetLayoutCI);
 }
 
+uint32_t DescriptorSetLayoutBuilder::getDynamicOffsetCount() const
+{
+    uint32_t count = 0;
+    for (auto &kv : m_bindings)
+    {
+        if (isDynamicDescriptorType(kv.second.descriptorType))
+        {
+            count += kv.second.descriptorCount;
+        }
+    }
+    return count;
+}
+
 //==============================================================================
 // Descriptor Set
 
@@ -119,6 +132,10 @@ DescriptorSetUpdater &DescriptorSetUpdater::addBuffer(
     vk::DescriptorBufferInfo *bufferInfo)
 {
     assert(m_dstSet != VK_NULL_HANDLE && "beginDescriptorSet() must be called first");
+    assert(bufferInfo != nullptr);
+    assert(
+        (isDynamicDescriptorType(descriptorType) == false || bufferInfo->range != VK_WHOLE_SIZE) &&
+        "Dynamic buffers need an explicit range");
     vk::WriteDescriptorSet write{};
     write.dstSet = m_dstSet;
     write.dstBinding = binding;
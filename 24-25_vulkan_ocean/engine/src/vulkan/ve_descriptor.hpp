@@ -9,6 +9,14 @@
 #include "ve_settings.hpp"
 #include "vulkan/ve_device.hpp"
 
+/// @brief Returns true for the descriptor types bound with a dynamic offset.
+inline bool isDynamicDescriptorType(vk::DescriptorType descriptorType)
+{
+    return
+        descriptorType == vk::DescriptorType::eUniformBufferDynamic ||
+        descriptorType == vk::DescriptorType::eStorageBufferDynamic;
+}
+
 //==============================================================================
 // Descriptor Pool
 
@@ -36,6 +44,8 @@ class DescriptorSetLayoutBuilder
 public:
     DescriptorSetLayoutBuilder() {}
 
+    /// @brief Adds a binding to the layout. Dynamic buffer bindings take one
+    /// offset per descriptor in bindDescriptorSets(), in binding order.
     DescriptorSetLayoutBuilder &addBinding(
         uint32_t binding,
         vk::DescriptorType descriptorType,
@@ -44,6 +54,9 @@ public:
 
     vk::DescriptorSetLayout build(vk::Device device);
 
+    /// @brief Number of dynamic offsets expected when binding a set of the layout.
+    uint32_t getDynamicOffsetCount() const;
+
 private:
     std::unordered_map<uint32_t, vk::DescriptorSetLayoutBinding> m_bindings{};
 };
@@ -74,6 +87,9 @@ public:
 
     DescriptorSetUpdater &beginDescriptorSet(vk::DescriptorSet dstSet);
 
+    /// @brief Writes a buffer descriptor. For dynamic buffers, the offset of
+    /// bufferInfo is added to the dynamic offset and the range must be the size
+    /// read by the shader, not VK_WHOLE_SIZE.
     DescriptorSetUpdater &addBuffer(
         uint32_t binding,
         vk::DescriptorType descriptorType,
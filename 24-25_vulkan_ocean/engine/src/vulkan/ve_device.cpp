@@ -10,6 +10,7 @@
 
 DeviceBuilder::DeviceBuilder()
     : m_features{}
+    , m_optionalFeatures{}
 {
 }
 
@@ -73,6 +74,39 @@ DeviceBuilder &DeviceBuilder::enableFillModeNonSolid()
     return *this;
 }
 
+DeviceBuilder &DeviceBuilder::enableMultiDrawIndirect()
+{
+    m_features.multiDrawIndirect = vk::True;
+    return *this;
+}
+
+DeviceBuilder &DeviceBuilder::setOptionalFeatures(const vk::PhysicalDeviceFeatures &features)
+{
+    m_optionalFeatures = features;
+    return *this;
+}
+
+void DeviceBuilder::enableSupportedFeatures(const vk::PhysicalDeviceFeatures &supportedFeatures)
+{
+    // The features structure is an array of VkBool32
+    VkBool32 *featuresArray = reinterpret_cast<VkBool32 *>(&m_features);
+    const VkBool32 *optionalArray = reinterpret_cast<const VkBool32 *>(&m_optionalFeatures);
+    const VkBool32 *supportedArray = reinterpret_cast<const VkBool32 *>(&supportedFeatures);
+    for (size_t i = 0; i < sizeof(vk::PhysicalDeviceFeatures) / sizeof(VkBool32); i++)
+    {
+        if (optionalArray[i] && supportedArray[i])
+        {
+            featuresArray[i] = VK_TRUE;
+        }
+    }
+}
+
+DeviceBuilder &DeviceBuilder::setPipelineCachePath(const std::string &path)
+{
+    m_pipelineCachePath = path;
+    return *this;
+}
+
 vk::Device DeviceBuilder::build(vk::PhysicalDevice physicalDevice)
 {
     vk::DeviceCreateInfo deviceCI{};
@@ -24,12 +24,25 @@ public:
     DeviceBuilder &enableShaderFloat64();
     DeviceBuilder &enableSamplerAnisotropy();
     DeviceBuilder &enableFillModeNonSolid();
+    DeviceBuilder &enableMultiDrawIndirect();
+
+    /// @brief Features enabled only if the selected device supports them,
+    /// while the features above exclude the devices without them.
+    DeviceBuilder &setOptionalFeatures(const vk::PhysicalDeviceFeatures &features);
+    /// @brief Adds the optional features supported by the selected device
+    /// to the features of the device.
+    void enableSupportedFeatures(const vk::PhysicalDeviceFeatures &supportedFeatures);
+
+    /// @brief File the pipeline cache is loaded from and saved to,
+    /// the cache is not persistent without it.
+    DeviceBuilder &setPipelineCachePath(const std::string &path);
 
     vk::Device build(vk::PhysicalDevice physicalDevice);
 
     const std::vector<const char *> &getDesiredLayers() const { return m_layers; }
     const std::vector<const char *> &getDesiredExtensions() const { return m_extensions; }
     const vk::PhysicalDeviceFeatures &getDesiredFeatures() const { return m_features; }
+    const std::string &getPipelineCachePath() const { return m_pipelineCachePath; }
 
 private:
     std::vector<const char *> m_layers;
@@ -37,4 +50,6 @@ private:
     std::vector<vk::DeviceQueueCreateInfo> m_queues;
     std::vector<std::vector<float> > m_queuePriorities;
     vk::PhysicalDeviceFeatures m_features;
+    vk::PhysicalDeviceFeatures m_optionalFeatures;
+    std::string m_pipelineCachePath;
 };
@@ -11,10 +11,26 @@ Framework::Framework(
     InstanceBuilder &instanceBuilder,
     DeviceBuilder &deviceBuilder,
     DescriptorPoolBuilder &descriptorPoolBuilder,
-    Window &window)
-    : m_base{ instanceBuilder, deviceBuilder, window }
-    , m_renderer{ m_base, (vk::Extent2D)(window.getExtent()) }
-    , m_window{ window }
+    Window &window,
+    uint32_t framesInFlight)
+    : m_window{ &window }
+    , m_base{ instanceBuilder, deviceBuilder, window }
+    , m_renderer{ m_base, (vk::Extent2D)(window.getExtent()), framesInFlight }
+{
+    // Create the descriptor pool
+    m_descriptorPool = descriptorPoolBuilder.build(m_base.getDevice());
+}
+
+Framework::Framework(
+    InstanceBuilder &instanceBuilder,
+    DeviceBuilder &deviceBuilder,
+    DescriptorPoolBuilder &descriptorPoolBuilder,
+    vk::Extent2D extent,
+    uint32_t framesInFlight,
+    vk::Format colorFormat)
+    : m_window{ nullptr }
+    , m_base{ instanceBuilder, deviceBuilder }
+    , m_renderer{ m_base, extent, framesInFlight, colorFormat }
 {
     // Create the descriptor pool
     m_descriptorPool = descriptorPoolBuilder.build(m_base.getDevice());
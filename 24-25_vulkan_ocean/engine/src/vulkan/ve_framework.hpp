@@ -18,11 +18,23 @@ public:
         InstanceBuilder &instanceBuilder,
         DeviceBuilder &deviceBuilder,
         DescriptorPoolBuilder &descriptorPoolBuilder,
-        Window &window);
+        Window &window,
+        uint32_t framesInFlight = Renderer::DEFAULT_FRAMES_IN_FLIGHT);
+
+    /// @brief Headless framework, the renderer draws into offscreen images
+    /// of the given extent and format.
+    Framework(
+        InstanceBuilder &instanceBuilder,
+        DeviceBuilder &deviceBuilder,
+        DescriptorPoolBuilder &descriptorPoolBuilder,
+        vk::Extent2D extent,
+        uint32_t framesInFlight = Renderer::DEFAULT_FRAMES_IN_FLIGHT,
+        vk::Format colorFormat = Renderer::DEFAULT_HEADLESS_FORMAT);
 
     ~Framework();
 
-    Window &getWindow() { return m_window; }
+    bool isHeadless() const { return m_window == nullptr; }
+    Window &getWindow() { assert(m_window && "Headless framework"); return *m_window; }
     VulkanBase &getVulkanBase() { return m_base; }
     vk::Instance getInstance() const { return m_base.getInstance(); }
     vk::PhysicalDevice getPhysicalDevice() const { return m_base.getPhysicalDevice(); }
@@ -42,7 +54,8 @@ public:
     Renderer &getRenderer() { return m_renderer; }
 
 private:
-    Window &m_window;
+    /// nullptr when headless.
+    Window *m_window;
     VulkanBase m_base;
     Renderer m_renderer;
 
@@ -0,0 +1,284 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#include "vulkan/ve_gpu_profiler.hpp"
+#include "core/ve_text_format.hpp"
+
+#include <iomanip>
+
+GpuProfiler::GpuProfiler(
+    vk::PhysicalDevice physicalDevice,
+    vk::Device device,
+    uint32_t queueFamilyIndex,
+    uint32_t frameSlotCount,
+    uint32_t maxScopeCount)
+    : m_device{ device }
+    , m_queryPool{ VK_NULL_HANDLE }
+    , m_queriesPerSlot{ 2 * maxScopeCount }
+    , m_timestampPeriod{ 1.0 }
+    , m_timestampMask{ 0 }
+    , m_enabled{ false }
+    , m_slots(frameSlotCount)
+    , m_currentSlot{ nullptr }
+    , m_currentFirstQuery{ 0 }
+    , m_lastFrame{}
+    , m_capturing{ false }
+{
+    assert(frameSlotCount > 0 && maxScopeCount > 0);
+
+    std::vector<vk::QueueFamilyProperties> queueFamilies =
+        physicalDevice.getQueueFamilyProperties();
+    assert(queueFamilyIndex < queueFamilies.size());
+
+    uint32_t validBits = queueFamilies[queueFamilyIndex].timestampValidBits;
+    float timestampPeriod = physicalDevice.getProperties().limits.timestampPeriod;
+    if (validBits == 0 || timestampPeriod <= 0.f)
+    {
+        std::cout << "GPU profiler: no timestamp support on the queue family" << std::endl;
+        return;
+    }
+
+    m_timestampPeriod = static_cast<double>(timestampPeriod);
+    m_timestampMask = (validBits >= 64) ? ~0ull : ((1ull << validBits) - 1);
+
+    vk::QueryPoolCreateInfo poolInfo{};
+    poolInfo.queryType = vk::QueryType::eTimestamp;
+    poolInfo.queryCount = frameSlotCount * m_queriesPerSlot;
+    m_queryPool = m_device.createQueryPool(poolInfo);
+}
+
+GpuProfiler::~GpuProfiler()
+{
+    if (m_queryPool)
+    {
+        m_device.destroyQueryPool(m_queryPool);
+    }
+}
+
+void GpuProfiler::beginFrame(vk::CommandBuffer commandBuffer, uint32_t frameSlot, uint64_t frameNumber)
+{
+    assert(m_currentSlot == nullptr && "Can't call beginFrame while a frame is in progress");
+    assert(frameSlot < m_slots.size());
+
+    if (isSupported() == false) return;
+
+    FrameSlot &slot = m_slots[frameSlot];
+    uint32_t firstQuery = frameSlot * m_queriesPerSlot;
+    if (slot.recorded)
+    {
+        resolve(slot, firstQuery);
+    }
+
+    slot.scopes.clear();
+    slot.queryCount = 0;
+    slot.frameNumber = frameNumber;
+    slot.recorded = false;
+
+    if (m_enabled == false) return;
+
+    commandBuffer.resetQueryPool(m_queryPool, firstQuery, m_queriesPerSlot);
+
+    m_currentSlot = &slot;
+    m_currentFirstQuery = firstQuery;
+    m_scopeStack.clear();
+}
+
+void GpuProfiler::endFrame()
+{
+    if (m_currentSlot == nullptr) return;
+
+    assert(m_scopeStack.empty() && "Every GPU scope must be closed before the end of the frame");
+
+    m_currentSlot->recorded = (m_currentSlot->queryCount > 0);
+    m_currentSlot = nullptr;
+}
+
+void GpuProfiler::beginScope(vk::CommandBuffer commandBuffer, const char *name)
+{
+    if (m_currentSlot == nullptr) return;
+
+    uint32_t depth = static_cast<uint32_t>(m_scopeStack.size());
+
+    // Keeps a query for the end of each open scope
+    if (m_currentSlot->queryCount + depth + 2 > m_queriesPerSlot)
+    {
+        m_scopeStack.push_back(DROPPED_SCOPE);
+        return;
+    }
+
+    ScopeQuery scope{};
+    scope.name = name;
+    scope.depth = depth;
+    scope.beginQuery = writeTimestamp(commandBuffer, vk::PipelineStageFlagBits::eTopOfPipe);
+    scope.endQuery = DROPPED_SCOPE;
+
+    m_scopeStack.push_back(static_cast<uint32_t>(m_currentSlot->scopes.size()));
+    m_currentSlot->scopes.push_back(scope);
+}
+
+void GpuProfiler::endScope(vk::CommandBuffer commandBuffer)
+{
+    if (m_currentSlot == nullptr) return;
+
+    assert(m_scopeStack.empty() == false && "endScope without beginScope");
+    uint32_t scopeIndex = m_scopeStack.back();
+    m_scopeStack.pop_back();
+
+    if (scopeIndex == DROPPED_SCOPE) return;
+
+    m_currentSlot->scopes[scopeIndex].endQuery =
+        writeTimestamp(commandBuffer, vk::PipelineStageFlagBits::eBottomOfPipe);
+}
+
+uint32_t GpuProfiler::writeTimestamp(
+    vk::CommandBuffer commandBuffer, vk::PipelineStageFlagBits stage)
+{
+    assert(m_currentSlot->queryCount < m_queriesPerSlot);
+
+    uint32_t query = m_currentSlot->queryCount++;
+    commandBuffer.writeTimestamp(stage, m_queryPool, m_currentFirstQuery + query);
+    return query;
+}
+
+void GpuProfiler::resolveAll()
+{
+    assert(m_currentSlot == nullptr && "Can't call resolveAll while a frame is in progress");
+
+    // In frame order, for the averages and the capture
+    std::vector<uint32_t> slotIndices;
+    for (uint32_t i = 0; i < m_slots.size(); i++)
+    {
+        if (m_slots[i].recorded) slotIndices.push_back(i);
+    }
+    std::sort(slotIndices.begin(), slotIndices.end(), [this](uint32_t a, uint32_t b) {
+        return m_slots[a].frameNumber < m_slots[b].frameNumber;
+    });
+
+    for (uint32_t i : slotIndices)
+    {
+        resolve(m_slots[i], i * m_queriesPerSlot);
+        m_slots[i].recorded = false;
+    }
+}
+
+void GpuProfiler::resolve(FrameSlot &slot, uint32_t firstQuery)
+{
+    // The fence of the slot is signaled, the results are available
+    std::vector<uint64_t> timestamps(slot.queryCount);
+    vk::Result result = m_device.getQueryPoolResults(
+        m_queryPool, firstQuery, slot.queryCount,
+        timestamps.size() * sizeof(uint64_t), timestamps.data(),
+        sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+
+    if (result != vk::Result::eSuccess)
+    {
+        return;
+    }
+
+    uint64_t frameBegin = std::numeric_limits<uint64_t>::max();
+    uint64_t frameEnd = 0;
+    for (uint64_t &timestamp : timestamps)
+    {
+        timestamp &= m_timestampMask;
+        frameBegin = std::min(frameBegin, timestamp);
+        frameEnd = std::max(frameEnd, timestamp);
+    }
+
+    const double ticksToMS = m_timestampPeriod * 1e-6;
+
+    GpuFrameTimings frame{};
+    frame.frameNumber = slot.frameNumber;
+    frame.start = static_cast<double>(frameBegin) * ticksToMS;
+    frame.duration = static_cast<double>(frameEnd - frameBegin) * ticksToMS;
+
+    for (const ScopeQuery &scope : slot.scopes)
+    {
+        if (scope.endQuery == DROPPED_SCOPE) continue;
+
+        uint64_t scopeBegin = timestamps[scope.beginQuery];
+        uint64_t scopeEnd = std::max(scopeBegin, timestamps[scope.endQuery]);
+
+        GpuScopeTiming timing{};
+        timing.name = scope.name;
+        timing.depth = scope.depth;
+        timing.start = static_cast<double>(scopeBegin - frameBegin) * ticksToMS;
+        timing.duration = static_cast<double>(scopeEnd - scopeBegin) * ticksToMS;
+
+        auto it = m_averageDurations.find(scope.name);
+        if (it == m_averageDurations.end())
+        {
+            it = m_averageDurations.emplace(scope.name, timing.duration).first;
+        }
+        else
+        {
+            it->second += 0.05 * (timing.duration - it->second);
+        }
+        timing.averageDuration = it->second;
+
+        frame.scopes.push_back(timing);
+    }
+
+    if (m_capturing)
+    {
+        m_capture.push_back(frame);
+    }
+    m_lastFrame = std::move(frame);
+}
+
+void GpuProfiler::startCapture()
+{
+    m_capture.clear();
+    m_capturing = true;
+}
+
+void GpuProfiler::writeCSV(const std::string &path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("failed to open file " + path);
+    }
+
+    file << std::fixed << std::setprecision(4);
+    file << "frame,scope,depth,start_ms,duration_ms\n";
+    for (const GpuFrameTimings &frame : m_capture)
+    {
+        for (const GpuScopeTiming &scope : frame.scopes)
+        {
+            file << frame.frameNumber << "," << textformat::quoteCSV(scope.name) << ","
+                << scope.depth << ","
+                << scope.start << "," << scope.duration << "\n";
+        }
+    }
+}
+
+void GpuProfiler::writeJSON(const std::string &path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("failed to open file " + path);
+    }
+
+    // Complete events, the timestamps are in microseconds
+    const double origin = m_capture.empty() ? 0.0 : m_capture.front().start;
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"traceEvents\":[\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"GPU\"}}";
+    for (const GpuFrameTimings &frame : m_capture)
+    {
+        for (const GpuScopeTiming &scope : frame.scopes)
+        {
+            file << ",\n{\"name\":\"" << textformat::escapeJSON(scope.name) << "\",\"cat\":\"gpu\",\"ph\":\"X\""
+                << ",\"ts\":" << 1000.0 * (frame.start - origin + scope.start)
+                << ",\"dur\":" << 1000.0 * scope.duration
+                << ",\"pid\":0,\"tid\":0"
+                << ",\"args\":{\"frame\":" << frame.frameNumber << "}}";
+        }
+    }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
@@ -0,0 +1,137 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#pragma once
+
+#include "ve_settings.hpp"
+
+/// @brief GPU time spent in a named scope of a frame, in milliseconds.
+struct GpuScopeTiming
+{
+    std::string name;
+    /// Nesting level, 0 for the scopes opened outside any other scope.
+    uint32_t depth = 0;
+    /// Start relative to the first timestamp of the frame.
+    double start = 0.0;
+    double duration = 0.0;
+    /// Exponential moving average of the duration of the scopes of that name.
+    double averageDuration = 0.0;
+};
+
+/// @brief Scopes of a frame, in the order they were opened.
+struct GpuFrameTimings
+{
+    uint64_t frameNumber = 0;
+    /// GPU clock of the first timestamp of the frame.
+    double start = 0.0;
+    /// Time between the first and the last timestamp of the frame.
+    double duration = 0.0;
+    std::vector<GpuScopeTiming> scopes;
+};
+
+/// @brief Measures named scopes of the command buffers with timestamp queries.
+/// Each frame slot owns a range of queries of a single pool. The queries of a
+/// slot are read when the slot is reused, after the renderer has waited for
+/// its fence, so the results arrive framesInFlight frames late but never stall.
+/// A scope begins at the top of the pipe and ends at the bottom of the pipe:
+/// its duration covers the work of its commands, overlapped with the end of
+/// the previous commands.
+class GpuProfiler
+{
+public:
+    static constexpr uint32_t DEFAULT_MAX_SCOPE_COUNT = 64;
+
+    GpuProfiler(
+        vk::PhysicalDevice physicalDevice,
+        vk::Device device,
+        uint32_t queueFamilyIndex,
+        uint32_t frameSlotCount,
+        uint32_t maxScopeCount = DEFAULT_MAX_SCOPE_COUNT);
+
+    GpuProfiler(const GpuProfiler &) = delete;
+    GpuProfiler &operator=(const GpuProfiler &) = delete;
+    ~GpuProfiler();
+
+    /// @brief false when the queue family has no timestamp support, every
+    /// call is then a no-op.
+    bool isSupported() const { return m_queryPool != VK_NULL_HANDLE; }
+
+    /// @brief Off by default, no timestamp is written until it is enabled.
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+    bool isEnabled() const { return m_enabled; }
+
+    /// @brief Reads the results of the previous use of the slot, then resets
+    /// its queries. Must be recorded outside a render pass, once the fence of
+    /// the slot is signaled.
+    void beginFrame(vk::CommandBuffer commandBuffer, uint32_t frameSlot, uint64_t frameNumber);
+    void endFrame();
+
+    /// @brief Opens a scope, scopes can be nested. The scopes beyond the
+    /// maximum scope count of a frame are ignored.
+    void beginScope(vk::CommandBuffer commandBuffer, const char *name);
+    void endScope(vk::CommandBuffer commandBuffer);
+
+    /// @brief Reads the results of every recorded frame, the GPU must be idle.
+    void resolveAll();
+
+    /// @brief Last resolved frame, framesInFlight frames behind the recording.
+    const GpuFrameTimings &getLastFrame() const { return m_lastFrame; }
+
+    /// @brief Keeps every resolved frame until stopCapture().
+    void startCapture();
+    void stopCapture() { m_capturing = false; }
+    bool isCapturing() const { return m_capturing; }
+    size_t getCapturedFrameCount() const { return m_capture.size(); }
+
+    /// @brief One line per scope: frame, scope, depth, start_ms, duration_ms.
+    void writeCSV(const std::string &path) const;
+
+    /// @brief Trace event format, opens in chrome://tracing or Perfetto.
+    void writeJSON(const std::string &path) const;
+
+private:
+    struct ScopeQuery
+    {
+        std::string name;
+        uint32_t depth;
+        uint32_t beginQuery;
+        uint32_t endQuery;
+    };
+
+    struct FrameSlot
+    {
+        std::vector<ScopeQuery> scopes;
+        uint32_t queryCount = 0;
+        uint64_t frameNumber = 0;
+        bool recorded = false;
+    };
+
+    static constexpr uint32_t DROPPED_SCOPE = std::numeric_limits<uint32_t>::max();
+
+    void resolve(FrameSlot &slot, uint32_t firstQuery);
+    uint32_t writeTimestamp(
+        vk::CommandBuffer commandBuffer, vk::PipelineStageFlagBits stage);
+
+    vk::Device m_device;
+    vk::QueryPool m_queryPool;
+    uint32_t m_queriesPerSlot;
+    /// Nanoseconds per timestamp tick.
+    double m_timestampPeriod;
+    uint64_t m_timestampMask;
+    bool m_enabled;
+
+    std::vector<FrameSlot> m_slots;
+    /// Slot of the frame being recorded, nullptr outside a frame.
+    FrameSlot *m_currentSlot;
+    uint32_t m_currentFirstQuery;
+    std::vector<uint32_t> m_scopeStack;
+
+    GpuFrameTimings m_lastFrame;
+    std::unordered_map<std::string, double> m_averageDurations;
+
+    bool m_capturing;
+    std::vector<GpuFrameTimings> m_capture;
+};
@@ -386,15 +386,16 @@ Image::Image(
             vk::MemoryPropertyFlagBits::eHostVisible;
     }
 
-    vk::MemoryAllocateInfo allocInfo{};
-    allocInfo.allocationSize = memoryRequirements.size;
-    allocInfo.memoryTypeIndex = tools::findMemoryTypeIndex(
-        memoryProperties,
-        memoryRequirements.memoryTypeBits,
-        search);
+    MemoryAllocator *allocator = MemoryAllocator::find(m_device);
+    if (allocator == nullptr)
+    {
+        throw std::runtime_error("no memory allocator for this device");
+    }
 
-    m_imageMemory = m_device.allocateMemory(allocInfo);
-    m_device.bindImageMemory(m_image, m_imageMemory, 0);
+    m_allocation = allocator->allocate(
+        memoryRequirements, search,
+        imageCI.tiling == vk::ImageTiling::eOptimal);
+    m_device.bindImageMemory(m_image, m_allocation.memory, m_allocation.offset);
 
     if (makeHostImage == false)
     {
@@ -439,7 +440,9 @@ void Image::upload(
         1,
         byteCount,
         vk::BufferUsageFlagBits::eTransferSrc,
-        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+        1,
+        AllocationLifetime::eTransient
     };
 
     stagingBuffer.map();
@@ -492,6 +495,18 @@ void Image::upload(
     tools::endSingleTimeCommands(m_device, queue, commandPool, commandBuffer);
 }
 
+void Image::transitionLayout(vk::CommandBuffer commandBuffer, vk::ImageLayout newLayout)
+{
+    vk::ImageSubresourceRange imageSubresourceRange{};
+    imageSubresourceRange.aspectMask = m_aspectMask;
+    imageSubresourceRange.baseMipLevel = 0;
+    imageSubresourceRange.levelCount = m_imageCI.mipLevels;
+    imageSubresourceRange.baseArrayLayer = 0;
+    imageSubresourceRange.layerCount = m_imageCI.arrayLayers;
+
+    setImageLayout(commandBuffer, newLayout, imageSubresourceRange);
+}
+
 void Image::generateMipmaps(
     vk::CommandBuffer commandBuffer,
     vk::ImageLayout finalLayout)
@@ -590,8 +605,8 @@ Image::~Image()
 {
     if (m_sampler) m_device.destroySampler(m_sampler);
     if (m_imageView) m_device.destroyImageView(m_imageView);
-    m_device.freeMemory(m_imageMemory);
     m_device.destroyImage(m_image);
+    MemoryAllocator::find(m_device)->free(m_allocation);
 }
 
 vk::ImageCreateInfo Image::defaultCreateInfo2D(uint32_t width, uint32_t height, vk::Format format)
@@ -8,6 +8,7 @@
 
 #include "ve_settings.hpp"
 #include "ve_base.hpp"
+#include "vulkan/ve_memory_allocator.hpp"
 
 class SamplerBuilder
 {
@@ -64,6 +65,9 @@ public:
         vk::ImageLayout finalLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
         bool uploadMipmaps = true);
 
+    /// @brief Records a layout transition of the whole image.
+    void transitionLayout(vk::CommandBuffer commandBuffer, vk::ImageLayout newLayout);
+
 
     //Image(vk::Device device, const std::array<std::string, 6> &paths);
     //Image(vk::Device device, const std::string &path);
@@ -74,14 +78,16 @@ public:
 
     vk::Image getImage() const { return m_image; }
     vk::ImageView getView() const { return m_imageView; }
-    vk::DeviceMemory getMemory() const { return m_imageMemory; }
+    vk::DeviceMemory getMemory() const { return m_allocation.memory; }
+    vk::DeviceSize getMemoryOffset() const { return m_allocation.offset; }
     vk::ImageCreateInfo getCreateInfo() const { return m_imageCI; }
+    vk::ImageLayout getLayout() const { return m_layout; }
 
 private:
     vk::Device m_device;
 
     vk::Image m_image;
-    vk::DeviceMemory m_imageMemory;
+    MemoryAllocation m_allocation;
     vk::ImageView m_imageView;
     vk::Sampler m_sampler;
 
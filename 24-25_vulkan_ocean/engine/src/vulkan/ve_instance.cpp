@@ -29,6 +29,13 @@ InstanceBuilder &InstanceBuilder::addExtension(const char *extension)
     return *this;
 }
 
+bool InstanceBuilder::isExtensionEnabled(const char *extension) const
+{
+    return std::any_of(
+        m_extensions.begin(), m_extensions.end(),
+        [extension](const char *enabled) { return strcmp(enabled, extension) == 0; });
+}
+
 InstanceBuilder &InstanceBuilder::addSDLExtensions(SDL_Window *window)
 {
     std::vector<const char *> extensions;
@@ -25,6 +25,7 @@ public:
     vk::Instance build();
 
     bool areValidationLayersEnabled() const { return m_enableValidationLayers; }
+    bool isExtensionEnabled(const char *extension) const;
 
 private:
     vk::ApplicationInfo m_applicationInfo;
@@ -0,0 +1,365 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#include "vulkan/ve_memory_allocator.hpp"
+#include "vulkan/ve_tools.hpp"
+#include "core/ve_range_allocator.hpp"
+
+/// @brief Device memory allocated from the driver.
+struct MemoryBlock
+{
+    vk::DeviceMemory memory;
+    vk::DeviceSize size = 0;
+    uint8_t *mapped = nullptr;
+    bool dedicated = false;
+
+    uint32_t allocationCount = 0;
+    vk::DeviceSize usedBytes = 0;
+    vk::DeviceSize reservedBytes = 0;
+
+    /// Sub-allocator of the shared blocks, depending on the pool.
+    std::optional<BuddyAllocator> buddy;
+    std::optional<LinearAllocator> linear;
+};
+
+namespace
+{
+    vk::DeviceSize alignUp(vk::DeviceSize size, vk::DeviceSize alignment)
+    {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    vk::DeviceSize alignDown(vk::DeviceSize size, vk::DeviceSize alignment)
+    {
+        return size / alignment * alignment;
+    }
+
+    std::mutex &getRegistryMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    std::unordered_map<VkDevice, MemoryAllocator *> &getRegistry()
+    {
+        static std::unordered_map<VkDevice, MemoryAllocator *> registry;
+        return registry;
+    }
+}
+
+MemoryStats &MemoryStats::operator+=(const MemoryStats &other)
+{
+    blockCount += other.blockCount;
+    dedicatedCount += other.dedicatedCount;
+    allocationCount += other.allocationCount;
+    reservedBytes += other.reservedBytes;
+    usedBytes += other.usedBytes;
+    fragmentedBytes += other.fragmentedBytes;
+    return *this;
+}
+
+MemoryAllocator::MemoryAllocator(
+    vk::Device device,
+    const vk::PhysicalDeviceMemoryProperties &memoryProperties,
+    const vk::PhysicalDeviceLimits &limits,
+    vk::DeviceSize blockSize)
+    : m_device{ device }
+    , m_memoryProperties{ memoryProperties }
+    , m_nonCoherentAtomSize{ std::max<vk::DeviceSize>(limits.nonCoherentAtomSize, 1) }
+    , m_blockSize{ blockSize }
+    , m_pools{}
+{
+    assert((blockSize & (blockSize - 1)) == 0 && blockSize >= BuddyAllocator::MIN_NODE_SIZE &&
+        "The block size must be a power of two");
+
+    // Buddy and linear pools of buffers and images for each memory type
+    m_pools.resize(4 * m_memoryProperties.memoryTypeCount);
+    for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; i++)
+    {
+        for (int isOptimalImage = 0; isOptimalImage < 2; isOptimalImage++)
+        {
+            for (int isLinear = 0; isLinear < 2; isLinear++)
+            {
+                Pool &pool = m_pools[getPoolIndex(i, isOptimalImage, isLinear)];
+                pool.memoryTypeIndex = i;
+                pool.isLinear = isLinear;
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(getRegistryMutex());
+    getRegistry()[static_cast<VkDevice>(m_device)] = this;
+}
+
+MemoryAllocator::~MemoryAllocator()
+{
+    {
+        std::lock_guard<std::mutex> lock(getRegistryMutex());
+        getRegistry().erase(static_cast<VkDevice>(m_device));
+    }
+
+    for (Pool &pool : m_pools)
+    {
+        for (auto &block : pool.blocks)
+        {
+            assert(block->allocationCount == 0 && "Device memory still in use");
+            if (block->mapped) m_device.unmapMemory(block->memory);
+            m_device.freeMemory(block->memory);
+        }
+        pool.blocks.clear();
+    }
+}
+
+MemoryAllocator *MemoryAllocator::find(vk::Device device)
+{
+    std::lock_guard<std::mutex> lock(getRegistryMutex());
+    auto it = getRegistry().find(static_cast<VkDevice>(device));
+    return it != getRegistry().end() ? it->second : nullptr;
+}
+
+uint32_t MemoryAllocator::getPoolIndex(uint32_t memoryTypeIndex, bool isOptimalImage, bool isLinear) const
+{
+    return 4 * memoryTypeIndex + 2 * (isOptimalImage ? 1 : 0) + (isLinear ? 1 : 0);
+}
+
+MemoryAllocation MemoryAllocator::allocate(
+    const vk::MemoryRequirements &requirements,
+    vk::MemoryPropertyFlags propertyFlags,
+    bool isOptimalImage,
+    AllocationLifetime lifetime)
+{
+    uint32_t memoryTypeIndex = tools::findMemoryTypeIndex(
+        m_memoryProperties, requirements.memoryTypeBits, propertyFlags);
+    if (memoryTypeIndex >= m_memoryProperties.memoryTypeCount)
+    {
+        throw std::runtime_error("failed to find a suitable memory type");
+    }
+
+    vk::DeviceSize alignment = std::max<vk::DeviceSize>(requirements.alignment, 1);
+    vk::DeviceSize size = requirements.size;
+
+    // Host writes to non coherent memory are flushed by whole atoms
+    const vk::MemoryPropertyFlags typeFlags = m_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags;
+    if ((typeFlags & vk::MemoryPropertyFlagBits::eHostVisible) &&
+        !(typeFlags & vk::MemoryPropertyFlagBits::eHostCoherent))
+    {
+        alignment = std::max(alignment, m_nonCoherentAtomSize);
+        size = alignUp(size, m_nonCoherentAtomSize);
+    }
+
+    const bool isLinear = (lifetime == AllocationLifetime::eTransient);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const uint32_t poolIndex = getPoolIndex(memoryTypeIndex, isOptimalImage, isLinear);
+    Pool &pool = m_pools[poolIndex];
+
+    MemoryBlock *block = nullptr;
+    vk::DeviceSize offset = 0;
+    vk::DeviceSize reservedSize = 0;
+
+    if (size > m_blockSize / 2)
+    {
+        // Large resources do not fit in a block without wasting most of it
+        block = createBlock(pool, size, true);
+        reservedSize = size;
+    }
+    else
+    {
+        for (auto &candidate : pool.blocks)
+        {
+            if (candidate->dedicated) continue;
+
+            bool success = isLinear ?
+                candidate->linear->allocate(size, alignment, offset, reservedSize) :
+                candidate->buddy->allocate(std::max(size, alignment), offset, reservedSize);
+            if (success)
+            {
+                block = candidate.get();
+                break;
+            }
+        }
+
+        if (block == nullptr)
+        {
+            block = createBlock(pool, m_blockSize, false);
+            bool success = isLinear ?
+                block->linear->allocate(size, alignment, offset, reservedSize) :
+                block->buddy->allocate(std::max(size, alignment), offset, reservedSize);
+            assert(success);
+        }
+    }
+
+    block->allocationCount++;
+    block->usedBytes += requirements.size;
+    block->reservedBytes += reservedSize;
+
+    MemoryAllocation allocation{};
+    allocation.memory = block->memory;
+    allocation.offset = offset;
+    allocation.size = requirements.size;
+    allocation.mapped = block->mapped ? block->mapped + offset : nullptr;
+    allocation.block = block;
+    allocation.poolIndex = poolIndex;
+    allocation.reservedSize = reservedSize;
+    return allocation;
+}
+
+void MemoryAllocator::free(MemoryAllocation &allocation)
+{
+    if (allocation.block == nullptr) return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    MemoryBlock &block = *allocation.block;
+    Pool &pool = m_pools[allocation.poolIndex];
+
+    assert(block.allocationCount > 0);
+    block.allocationCount--;
+    block.usedBytes -= allocation.size;
+    block.reservedBytes -= allocation.reservedSize;
+
+    if (block.dedicated == false)
+    {
+        if (pool.isLinear)
+        {
+            // The whole block is reused once it is empty
+            if (block.allocationCount == 0)
+            {
+                block.linear->reset();
+            }
+        }
+        else
+        {
+            block.buddy->free(allocation.offset, allocation.reservedSize);
+        }
+    }
+
+    if (block.allocationCount == 0)
+    {
+        // Keeps the block if it is the only shared block of the pool, so
+        // that a pool of short lived resources does not reallocate it for
+        // every resource. Dedicated blocks are always released
+        uint32_t sharedBlockCount = 0;
+        for (auto &other : pool.blocks)
+        {
+            if (other->dedicated == false) sharedBlockCount++;
+        }
+
+        if (block.dedicated || sharedBlockCount > 1)
+        {
+            destroyBlock(pool, &block);
+        }
+    }
+
+    allocation = MemoryAllocation{};
+}
+
+void MemoryAllocator::invalidate(
+    const MemoryAllocation &allocation, vk::DeviceSize offset, vk::DeviceSize size) const
+{
+    if (allocation.block == nullptr) return;
+    assert(allocation.mapped && "Cannot invalidate memory that is not host visible");
+
+    const uint32_t memoryTypeIndex = m_pools[allocation.poolIndex].memoryTypeIndex;
+    const vk::MemoryPropertyFlags typeFlags = m_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags;
+    if (typeFlags & vk::MemoryPropertyFlagBits::eHostCoherent) return;
+
+    if (size == VK_WHOLE_SIZE)
+    {
+        assert(offset <= allocation.size);
+        size = allocation.size - offset;
+    }
+
+    // The range is widened to whole atoms, clamped to the block
+    const MemoryBlock &block = *allocation.block;
+    vk::DeviceSize begin = alignDown(allocation.offset + offset, m_nonCoherentAtomSize);
+    vk::DeviceSize end = alignUp(allocation.offset + offset + size, m_nonCoherentAtomSize);
+
+    vk::MappedMemoryRange range{};
+    range.memory = block.memory;
+    range.offset = begin;
+    range.size = (end >= block.size) ? VK_WHOLE_SIZE : end - begin;
+    m_device.invalidateMappedMemoryRanges(range);
+}
+
+MemoryBlock *MemoryAllocator::createBlock(Pool &pool, vk::DeviceSize size, bool dedicated)
+{
+    vk::MemoryAllocateInfo allocInfo{};
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = pool.memoryTypeIndex;
+
+    auto block = std::make_unique<MemoryBlock>();
+    block->memory = m_device.allocateMemory(allocInfo);
+    block->size = size;
+    block->dedicated = dedicated;
+
+    const vk::MemoryPropertyFlags typeFlags =
+        m_memoryProperties.memoryTypes[pool.memoryTypeIndex].propertyFlags;
+    if (typeFlags & vk::MemoryPropertyFlagBits::eHostVisible)
+    {
+        // A memory object can only be mapped once, so it stays mapped
+        block->mapped = static_cast<uint8_t *>(m_device.mapMemory(block->memory, 0, VK_WHOLE_SIZE));
+    }
+
+    if (dedicated == false)
+    {
+        if (pool.isLinear) block->linear.emplace(size);
+        else block->buddy.emplace(size);
+    }
+
+    pool.blocks.push_back(std::move(block));
+    return pool.blocks.back().get();
+}
+
+void MemoryAllocator::destroyBlock(Pool &pool, MemoryBlock *block)
+{
+    if (block->mapped) m_device.unmapMemory(block->memory);
+    m_device.freeMemory(block->memory);
+
+    auto it = std::find_if(pool.blocks.begin(), pool.blocks.end(),
+        [block](const std::unique_ptr<MemoryBlock> &other) { return other.get() == block; });
+    assert(it != pool.blocks.end());
+    pool.blocks.erase(it);
+}
+
+MemoryStats MemoryAllocator::getStats() const
+{
+    MemoryStats stats{};
+    for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; i++)
+    {
+        stats += getStats(i);
+    }
+    return stats;
+}
+
+MemoryStats MemoryAllocator::getStats(uint32_t memoryTypeIndex) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    MemoryStats stats{};
+    for (int k = 0; k < 4; k++)
+    {
+        const Pool &pool = m_pools[4 * memoryTypeIndex + k];
+        for (const auto &block : pool.blocks)
+        {
+            if (block->dedicated) stats.dedicatedCount++;
+            else stats.blockCount++;
+
+            stats.allocationCount += block->allocationCount;
+            stats.reservedBytes += block->size;
+            stats.usedBytes += block->usedBytes;
+            stats.fragmentedBytes += block->reservedBytes - block->usedBytes;
+
+            if (pool.isLinear && block->dedicated == false)
+            {
+                // Freed ranges before the head are lost until the block is empty
+                stats.fragmentedBytes += block->linear->getHead() - block->reservedBytes;
+            }
+        }
+    }
+    return stats;
+}
@@ -0,0 +1,129 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#pragma once
+
+#include "ve_settings.hpp"
+
+#include <mutex>
+
+enum class AllocationLifetime
+{
+    /// Long lived resource, sub-allocated with a buddy allocator.
+    ePersistent,
+    /// Short lived resource such as a staging buffer, sub-allocated linearly.
+    /// The memory of a block is reused once all its allocations are freed.
+    eTransient,
+};
+
+class MemoryAllocator;
+struct MemoryBlock;
+
+/// @brief Range of device memory returned by the MemoryAllocator.
+struct MemoryAllocation
+{
+    vk::DeviceMemory memory;
+    vk::DeviceSize offset = 0;
+    /// Requested size.
+    vk::DeviceSize size = 0;
+    /// Host pointer to the first byte if the memory is host visible.
+    /// The blocks are mapped once for their whole lifetime.
+    void *mapped = nullptr;
+
+private:
+    friend class MemoryAllocator;
+    MemoryBlock *block = nullptr;
+    uint32_t poolIndex = 0;
+    /// Size actually reserved in the block, including the rounding.
+    vk::DeviceSize reservedSize = 0;
+};
+
+struct MemoryStats
+{
+    uint32_t blockCount = 0;
+    uint32_t dedicatedCount = 0;
+    uint32_t allocationCount = 0;
+    /// Device memory allocated from the driver.
+    vk::DeviceSize reservedBytes = 0;
+    /// Bytes requested by the live allocations.
+    vk::DeviceSize usedBytes = 0;
+    /// Bytes lost to alignment and size rounding, plus the freed bytes that
+    /// a linear block cannot reuse yet.
+    vk::DeviceSize fragmentedBytes = 0;
+
+    MemoryStats &operator+=(const MemoryStats &other);
+};
+
+/// @brief Carves buffers and images out of large device memory blocks.
+/// Each memory type has its own blocks, split between buffers and optimally
+/// tiled images so that bufferImageGranularity never applies. Persistent
+/// allocations use a buddy allocator, transient ones a linear allocator,
+/// and allocations larger than half a block get their own device memory.
+/// The allocator of a device is created by VulkanBase and found with
+/// MemoryAllocator::find() by the classes that only know the device.
+class MemoryAllocator
+{
+public:
+    /// Block size, must be a power of two.
+    static constexpr vk::DeviceSize DEFAULT_BLOCK_SIZE = 64ull << 20;
+
+    MemoryAllocator(
+        vk::Device device,
+        const vk::PhysicalDeviceMemoryProperties &memoryProperties,
+        const vk::PhysicalDeviceLimits &limits,
+        vk::DeviceSize blockSize = DEFAULT_BLOCK_SIZE);
+    ~MemoryAllocator();
+
+    MemoryAllocator(const MemoryAllocator &) = delete;
+    MemoryAllocator &operator=(const MemoryAllocator &) = delete;
+
+    /// @brief Allocator of the device, nullptr if none was created.
+    static MemoryAllocator *find(vk::Device device);
+
+    /// @param isOptimalImage true for images with optimal tiling.
+    MemoryAllocation allocate(
+        const vk::MemoryRequirements &requirements,
+        vk::MemoryPropertyFlags propertyFlags,
+        bool isOptimalImage,
+        AllocationLifetime lifetime = AllocationLifetime::ePersistent);
+
+    void free(MemoryAllocation &allocation);
+
+    /// @brief Makes the device writes to a range of a host visible
+    /// allocation visible to the host. Does nothing if the memory is host
+    /// coherent.
+    void invalidate(
+        const MemoryAllocation &allocation,
+        vk::DeviceSize offset = 0, vk::DeviceSize size = VK_WHOLE_SIZE) const;
+
+    MemoryStats getStats() const;
+    MemoryStats getStats(uint32_t memoryTypeIndex) const;
+
+    uint32_t getMemoryTypeCount() const { return m_memoryProperties.memoryTypeCount; }
+    vk::DeviceSize getBlockSize() const { return m_blockSize; }
+
+private:
+    struct Pool
+    {
+        uint32_t memoryTypeIndex = 0;
+        bool isLinear = false;
+        std::vector<std::unique_ptr<MemoryBlock>> blocks;
+    };
+
+    uint32_t getPoolIndex(uint32_t memoryTypeIndex, bool isOptimalImage, bool isLinear) const;
+
+    MemoryBlock *createBlock(Pool &pool, vk::DeviceSize size, bool dedicated);
+    void destroyBlock(Pool &pool, MemoryBlock *block);
+
+    vk::Device m_device;
+    vk::PhysicalDeviceMemoryProperties m_memoryProperties;
+    vk::DeviceSize m_nonCoherentAtomSize;
+    vk::DeviceSize m_blockSize;
+
+    std::vector<Pool> m_pools;
+
+    mutable std::mutex m_mutex;
+};
@@ -47,6 +47,91 @@ vk::PipelineLayout PipelineLayoutBuilder::build(vk::Device &device)
 }
 
 
+//==============================================================================
+// Specialization constants
+
+SpecializationConstants &SpecializationConstants::set(uint32_t constantID, uint32_t value)
+{
+    return setBits(constantID, value);
+}
+
+SpecializationConstants &SpecializationConstants::set(uint32_t constantID, int32_t value)
+{
+    uint32_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    return setBits(constantID, bits);
+}
+
+SpecializationConstants &SpecializationConstants::set(uint32_t constantID, float value)
+{
+    uint32_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    return setBits(constantID, bits);
+}
+
+SpecializationConstants &SpecializationConstants::set(uint32_t constantID, bool value)
+{
+    return setBits(constantID, value ? VK_TRUE : VK_FALSE);
+}
+
+SpecializationConstants &SpecializationConstants::setBits(uint32_t constantID, uint32_t bits)
+{
+    auto it = std::lower_bound(
+        m_entries.begin(), m_entries.end(), constantID,
+        [](const vk::SpecializationMapEntry &entry, uint32_t id) { return entry.constantID < id; });
+    size_t index = static_cast<size_t>(it - m_entries.begin());
+
+    if (it != m_entries.end() && it->constantID == constantID)
+    {
+        m_data[index] = bits;
+        return *this;
+    }
+
+    m_entries.insert(it, vk::SpecializationMapEntry(constantID, 0, sizeof(uint32_t)));
+    m_data.insert(m_data.begin() + index, bits);
+    for (size_t i = 0; i < m_entries.size(); i++)
+    {
+        m_entries[i].offset = static_cast<uint32_t>(i * sizeof(uint32_t));
+    }
+    return *this;
+}
+
+vk::SpecializationInfo SpecializationConstants::getInfo() const
+{
+    vk::SpecializationInfo specializationInfo{};
+    specializationInfo.mapEntryCount = static_cast<uint32_t>(m_entries.size());
+    specializationInfo.pMapEntries = m_entries.data();
+    specializationInfo.dataSize = m_data.size() * sizeof(uint32_t);
+    specializationInfo.pData = m_data.data();
+    return specializationInfo;
+}
+
+size_t SpecializationConstants::getHash() const
+{
+    // FNV-1a over the IDs and the values
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < m_entries.size(); i++)
+    {
+        const uint32_t words[2] = { m_entries[i].constantID, m_data[i] };
+        for (uint32_t word : words)
+        {
+            hash ^= word;
+            hash *= 0x100000001b3ULL;
+        }
+    }
+    return static_cast<size_t>(hash);
+}
+
+bool SpecializationConstants::operator==(const SpecializationConstants &other) const
+{
+    if (m_entries.size() != other.m_entries.size()) return false;
+    for (size_t i = 0; i < m_entries.size(); i++)
+    {
+        if (m_entries[i].constantID != other.m_entries[i].constantID) return false;
+    }
+    return m_data == other.m_data;
+}
+
 //==============================================================================
 // Pipeline
 
@@ -145,6 +230,13 @@ PipelineBuilder &PipelineBuilder::setTessellationPatchControlPoints(uint32_t pat
     return *this;
 }
 
+PipelineBuilder &PipelineBuilder::setSpecializationConstants(
+    const SpecializationConstants &constants)
+{
+    m_specializationConstants = constants;
+    return *this;
+}
+
 vk::Pipeline PipelineBuilder::build(vk::Device &device) const
 {
     vk::PipelineInputAssemblyStateCreateInfo inputAssemblyStateCI{};
@@ -232,8 +324,19 @@ vk::Pipeline PipelineBuilder::build(vk::Device &device) const
     pipelineCI.pViewportState = &viewportStateCI;
     pipelineCI.pDepthStencilState = &depthStencilStateCI;
     pipelineCI.pDynamicState = &dynamicStateCI;
-    pipelineCI.stageCount = static_cast<uint32_t>(m_shaderStages.size());
-    pipelineCI.pStages = m_shaderStages.data();
+    // The stages point to the constants of the builder
+    vk::SpecializationInfo specializationInfo = m_specializationConstants.getInfo();
+    std::vector<vk::PipelineShaderStageCreateInfo> shaderStages = m_shaderStages;
+    if (m_specializationConstants.empty() == false)
+    {
+        for (vk::PipelineShaderStageCreateInfo &shaderStage : shaderStages)
+        {
+            shaderStage.pSpecializationInfo = &specializationInfo;
+        }
+    }
+
+    pipelineCI.stageCount = static_cast<uint32_t>(shaderStages.size());
+    pipelineCI.pStages = shaderStages.data();
 
     if (m_patchControlPoints > 0)
         pipelineCI.pTessellationState = &pipelineTessellationStateCI;
@@ -241,3 +344,81 @@ vk::Pipeline PipelineBuilder::build(vk::Device &device) const
     auto [result, pipeline] = device.createGraphicsPipeline(m_pipelineCache, pipelineCI);
     return pipeline;
 }
+
+//==============================================================================
+// Compute Pipeline
+
+ComputePipelineBuilder::ComputePipelineBuilder(
+    vk::PipelineLayout pipelineLayout,
+    vk::PipelineCache pipelineCache)
+    : m_pipelineLayout{ pipelineLayout }
+    , m_pipelineCache{ pipelineCache }
+    , m_shaderStage{}
+    , m_specializationConstants{}
+{
+}
+
+ComputePipelineBuilder &ComputePipelineBuilder::setShaderStage(
+    vk::PipelineShaderStageCreateInfo &shaderStage)
+{
+    assert(
+        shaderStage.stage == vk::ShaderStageFlagBits::eCompute &&
+        "A compute pipeline requires a compute shader stage");
+    m_shaderStage = shaderStage;
+    return *this;
+}
+
+ComputePipelineBuilder &ComputePipelineBuilder::setPipelineCache(vk::PipelineCache pipelineCache)
+{
+    m_pipelineCache = pipelineCache;
+    return *this;
+}
+
+ComputePipelineBuilder &ComputePipelineBuilder::setSpecializationConstants(
+    const SpecializationConstants &constants)
+{
+    m_specializationConstants = constants;
+    return *this;
+}
+
+vk::Pipeline ComputePipelineBuilder::build(vk::Device &device) const
+{
+    assert(m_shaderStage.module != VK_NULL_HANDLE && "setShaderStage() must be called first");
+
+    vk::ComputePipelineCreateInfo pipelineCI{};
+    pipelineCI.layout = m_pipelineLayout;
+    pipelineCI.stage = m_shaderStage;
+
+    vk::SpecializationInfo specializationInfo = m_specializationConstants.getInfo();
+    if (m_specializationConstants.empty() == false)
+    {
+        pipelineCI.stage.pSpecializationInfo = &specializationInfo;
+    }
+
+    auto [result, pipeline] = device.createComputePipeline(m_pipelineCache, pipelineCI);
+    return pipeline;
+}
+
+//==============================================================================
+// Pipeline variants
+
+vk::Pipeline &PipelineVariantCache::get(const SpecializationConstants &constants)
+{
+    // The nodes of the map never move, the references stay valid
+    return m_variants.try_emplace(constants, vk::Pipeline{}).first->second;
+}
+
+vk::Pipeline PipelineVariantCache::find(const SpecializationConstants &constants) const
+{
+    auto it = m_variants.find(constants);
+    return (it != m_variants.end()) ? it->second : VK_NULL_HANDLE;
+}
+
+void PipelineVariantCache::destroy(vk::Device &device)
+{
+    for (auto &[constants, pipeline] : m_variants)
+    {
+        device.destroyPipeline(pipeline);
+    }
+    m_variants.clear();
+}
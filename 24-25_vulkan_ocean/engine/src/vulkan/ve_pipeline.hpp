@@ -35,6 +35,50 @@ private:
     std::vector<vk::PushConstantRange> m_pushConstantRanges{};
 };
 
+//==============================================================================
+// Specialization constants
+
+/// @brief Values of the specialization constants of a pipeline, given to
+/// every stage: a stage ignores the constants it does not declare.
+/// Each value takes 4 bytes, as the int, uint, float and bool constants of
+/// GLSL. The values are kept sorted by constant ID, so that two sets are
+/// equal whatever the order of the set() calls, and key the pipeline
+/// variants of a PipelineVariantCache.
+class SpecializationConstants
+{
+public:
+    SpecializationConstants() {}
+
+    SpecializationConstants &set(uint32_t constantID, uint32_t value);
+    SpecializationConstants &set(uint32_t constantID, int32_t value);
+    SpecializationConstants &set(uint32_t constantID, float value);
+    /// @brief Stored as a VkBool32.
+    SpecializationConstants &set(uint32_t constantID, bool value);
+
+    bool empty() const { return m_entries.empty(); }
+
+    /// @brief Points to this object, valid until it is modified or destroyed.
+    vk::SpecializationInfo getInfo() const;
+
+    size_t getHash() const;
+    bool operator==(const SpecializationConstants &other) const;
+    bool operator!=(const SpecializationConstants &other) const { return !(*this == other); }
+
+    struct Hash
+    {
+        size_t operator()(const SpecializationConstants &constants) const
+        {
+            return constants.getHash();
+        }
+    };
+
+private:
+    SpecializationConstants &setBits(uint32_t constantID, uint32_t bits);
+
+    std::vector<vk::SpecializationMapEntry> m_entries{};
+    std::vector<uint32_t> m_data{};
+};
+
 //==============================================================================
 // Pipeline
 
@@ -72,6 +116,8 @@ public:
     PipelineBuilder &setRasterizationSamples(vk::SampleCountFlagBits rasterizationSamples);
     PipelineBuilder &setPrimitiveTopology(vk::PrimitiveTopology primitiveTopology);
     PipelineBuilder &setTessellationPatchControlPoints(uint32_t patchControlPoints);
+    /// @brief The constants of every stage.
+    PipelineBuilder &setSpecializationConstants(const SpecializationConstants &constants);
 
     vk::Pipeline build(vk::Device &device) const;
 
@@ -83,6 +129,7 @@ private:
     std::vector<vk::VertexInputBindingDescription> m_vertexBindings{};
     std::vector<vk::VertexInputAttributeDescription> m_vertexAttributes{};
     std::vector<vk::PipelineShaderStageCreateInfo> m_shaderStages{};
+    SpecializationConstants m_specializationConstants{};
 
     vk::PolygonMode m_polygonMode;
     vk::CullModeFlags m_cullMode;
@@ -91,3 +138,57 @@ private:
     vk::PrimitiveTopology m_primitiveTopology;
     uint32_t m_patchControlPoints;
 };
+
+//==============================================================================
+// Compute Pipeline
+
+class ComputePipelineBuilder
+{
+public:
+    ComputePipelineBuilder(
+        vk::PipelineLayout pipelineLayout,
+        vk::PipelineCache pipelineCache = VK_NULL_HANDLE);
+
+    ComputePipelineBuilder &setShaderStage(
+        vk::PipelineShaderStageCreateInfo &shaderStage);
+
+    ComputePipelineBuilder &setPipelineCache(vk::PipelineCache pipelineCache);
+    ComputePipelineBuilder &setSpecializationConstants(const SpecializationConstants &constants);
+
+    vk::Pipeline build(vk::Device &device) const;
+
+private:
+    vk::PipelineLayout m_pipelineLayout;
+    vk::PipelineCache m_pipelineCache;
+    vk::PipelineShaderStageCreateInfo m_shaderStage;
+    SpecializationConstants m_specializationConstants;
+};
+
+//==============================================================================
+// Pipeline variants
+
+/// @brief Pipelines built from the same shaders with different
+/// specialization constants, keyed by the constant values. Each variant is
+/// optimized by the driver for its values, without the dynamic branches
+/// of a uniform.
+class PipelineVariantCache
+{
+public:
+    PipelineVariantCache() {}
+
+    /// @brief Handle of the variant, VK_NULL_HANDLE until it is built.
+    /// The reference stays valid until destroy(), so that a
+    /// PipelineBuildQueue can write the pipeline.
+    vk::Pipeline &get(const SpecializationConstants &constants);
+
+    /// @return VK_NULL_HANDLE if the variant was not built.
+    vk::Pipeline find(const SpecializationConstants &constants) const;
+
+    uint32_t getVariantCount() const { return static_cast<uint32_t>(m_variants.size()); }
+
+    /// @brief Destroys the pipeline of every variant.
+    void destroy(vk::Device &device);
+
+private:
+    std::unordered_map<SpecializationConstants, vk::Pipeline, SpecializationConstants::Hash> m_variants{};
+};
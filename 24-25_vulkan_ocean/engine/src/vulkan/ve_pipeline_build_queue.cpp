@@ -0,0 +1,226 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#include "vulkan/ve_pipeline_build_queue.hpp"
+#include "core/ve_cpu_trace.hpp"
+
+PipelineBuildQueue::PipelineBuildQueue(
+    vk::Device device,
+    vk::PipelineCache pipelineCache,
+    ThreadPool &threadPool)
+    : m_device{ device }
+    , m_pipelineCache{ pipelineCache }
+    , m_threadPool{ threadPool }
+    , m_jobs{}
+    , m_shaderModules{}
+    , m_workerCaches{}
+    , m_freeCaches{}
+    , m_workerCacheCount{ 0 }
+    , m_remainingCount{ 0 }
+    , m_error{}
+    , m_started{ false }
+    , m_buildTime{ 0.f }
+{
+}
+
+PipelineBuildQueue::~PipelineBuildQueue()
+{
+    if (m_started)
+    {
+        // The workers reference the jobs, never leave them running
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_doneCondition.wait(lock, [this] { return m_remainingCount == 0; });
+    }
+    for (vk::PipelineCache workerCache : m_workerCaches)
+    {
+        m_device.destroyPipelineCache(workerCache);
+    }
+    for (vk::ShaderModule shaderModule : m_shaderModules)
+    {
+        m_device.destroyShaderModule(shaderModule);
+    }
+}
+
+void PipelineBuildQueue::add(const PipelineBuilder &builder, vk::Pipeline *pipeline)
+{
+    assert(m_started == false && "Can't add a pipeline while building");
+    assert(pipeline != nullptr);
+
+    Job job{};
+    job.graphics = builder;
+    job.pipeline = pipeline;
+    m_jobs.push_back(std::move(job));
+}
+
+void PipelineBuildQueue::add(const ComputePipelineBuilder &builder, vk::Pipeline *pipeline)
+{
+    assert(m_started == false && "Can't add a pipeline while building");
+    assert(pipeline != nullptr);
+
+    Job job{};
+    job.compute = builder;
+    job.pipeline = pipeline;
+    m_jobs.push_back(std::move(job));
+}
+
+void PipelineBuildQueue::destroyAfterBuild(vk::ShaderModule shaderModule)
+{
+    if (shaderModule)
+    {
+        m_shaderModules.push_back(shaderModule);
+    }
+}
+
+void PipelineBuildQueue::start()
+{
+    assert(m_started == false && "The queue is already building");
+
+    m_startTime = std::chrono::steady_clock::now();
+    m_started = true;
+    m_error = nullptr;
+    m_remainingCount = static_cast<uint32_t>(m_jobs.size());
+    m_workerCacheCount = 0;
+
+    if (m_jobs.empty()) return;
+
+    // One cache per job that can run at the same time
+    uint32_t cacheCount = std::min(
+        m_threadPool.getThreadCount(), static_cast<uint32_t>(m_jobs.size()));
+
+    std::vector<uint8_t> initialData;
+    if (m_pipelineCache)
+    {
+        initialData = m_device.getPipelineCacheData(m_pipelineCache);
+    }
+
+    vk::PipelineCacheCreateInfo pipelineCacheCI{};
+    pipelineCacheCI.initialDataSize = initialData.size();
+    pipelineCacheCI.pInitialData = initialData.empty() ? nullptr : initialData.data();
+    if (m_pipelineCache)
+    {
+        for (uint32_t i = 0; i < cacheCount; i++)
+        {
+            m_workerCaches.push_back(m_device.createPipelineCache(pipelineCacheCI));
+        }
+    }
+    m_freeCaches = m_workerCaches;
+    m_workerCacheCount = static_cast<uint32_t>(m_workerCaches.size());
+
+    for (Job &job : m_jobs)
+    {
+        m_threadPool.enqueue([this, &job] { runJob(job); });
+    }
+}
+
+void PipelineBuildQueue::runJob(Job &job)
+{
+    VE_TRACE_SCOPE("Compile pipeline");
+
+    vk::PipelineCache workerCache = VK_NULL_HANDLE;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_freeCaches.empty() == false)
+        {
+            workerCache = m_freeCaches.back();
+            m_freeCaches.pop_back();
+        }
+    }
+
+    vk::Pipeline pipeline = VK_NULL_HANDLE;
+    std::exception_ptr error = nullptr;
+    try
+    {
+        if (job.graphics)
+        {
+            pipeline = job.graphics->setPipelineCache(workerCache).build(m_device);
+        }
+        else
+        {
+            pipeline = job.compute->setPipelineCache(workerCache).build(m_device);
+        }
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    job.result = pipeline;
+    if (workerCache)
+    {
+        m_freeCaches.push_back(workerCache);
+    }
+    if (error && m_error == nullptr)
+    {
+        m_error = error;
+    }
+    if (--m_remainingCount == 0)
+    {
+        m_doneCondition.notify_all();
+    }
+}
+
+bool PipelineBuildQueue::isFinished() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_remainingCount == 0;
+}
+
+void PipelineBuildQueue::wait()
+{
+    assert(m_started && "start() must be called first");
+
+    {
+        VE_TRACE_SCOPE("Wait for pipelines");
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_doneCondition.wait(lock, [this] { return m_remainingCount == 0; });
+    }
+    m_started = false;
+
+    // The merge keeps the entries of every worker cache
+    if (m_workerCaches.empty() == false)
+    {
+        VE_TRACE_SCOPE("Merge pipeline caches");
+        m_device.mergePipelineCaches(m_pipelineCache, m_workerCaches);
+    }
+    for (vk::PipelineCache workerCache : m_workerCaches)
+    {
+        m_device.destroyPipelineCache(workerCache);
+    }
+    m_workerCaches.clear();
+    m_freeCaches.clear();
+
+    for (vk::ShaderModule shaderModule : m_shaderModules)
+    {
+        m_device.destroyShaderModule(shaderModule);
+    }
+    m_shaderModules.clear();
+
+    std::vector<Job> jobs = std::move(m_jobs);
+    m_jobs.clear();
+
+    m_buildTime = std::chrono::duration<float, std::milli>(
+        std::chrono::steady_clock::now() - m_startTime).count();
+
+    if (m_error)
+    {
+        for (Job &job : jobs)
+        {
+            if (job.result) m_device.destroyPipeline(job.result);
+        }
+        std::rethrow_exception(m_error);
+    }
+    for (Job &job : jobs)
+    {
+        *job.pipeline = job.result;
+    }
+}
+
+void PipelineBuildQueue::build()
+{
+    start();
+    wait();
+}
@@ -0,0 +1,96 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#pragma once
+
+#include "ve_settings.hpp"
+#include "vulkan/ve_pipeline.hpp"
+#include "core/ve_thread_pool.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+/// @brief Compiles independent pipelines on the workers of a thread pool.
+/// Each worker compiles into its own pipeline cache, seeded with the data
+/// of the target cache so that a warm start still hits, and the worker
+/// caches are merged into the target cache once every pipeline is built.
+/// The driver never serializes the workers on a shared cache.
+/// Usage: add() the pipelines, start(), do other work on the calling
+/// thread, then wait(). The shader modules must stay alive until wait()
+/// returns, destroyAfterBuild() hands them to the queue.
+class PipelineBuildQueue
+{
+public:
+    /// @param pipelineCache target cache, VK_NULL_HANDLE to build without cache.
+    PipelineBuildQueue(
+        vk::Device device,
+        vk::PipelineCache pipelineCache,
+        ThreadPool &threadPool = ThreadPool::getShared());
+    ~PipelineBuildQueue();
+
+    PipelineBuildQueue(const PipelineBuildQueue &) = delete;
+    PipelineBuildQueue &operator=(const PipelineBuildQueue &) = delete;
+
+    /// @brief Queues a copy of the builder, its pipeline cache is replaced.
+    /// @param pipeline receives the pipeline in wait().
+    void add(const PipelineBuilder &builder, vk::Pipeline *pipeline);
+    void add(const ComputePipelineBuilder &builder, vk::Pipeline *pipeline);
+
+    /// @brief Destroys the shader module at the end of wait().
+    void destroyAfterBuild(vk::ShaderModule shaderModule);
+
+    /// @brief Starts the compilation of the queued pipelines, returns at once.
+    void start();
+
+    /// @brief True once every pipeline is compiled, wait() then returns at once.
+    bool isFinished() const;
+
+    /// @brief Waits for the compilation, merges the worker caches and
+    /// writes the pipelines. Rethrows the first compilation error.
+    void wait();
+
+    /// @brief start() then wait().
+    void build();
+
+    uint32_t getPipelineCount() const { return static_cast<uint32_t>(m_jobs.size()); }
+    /// @brief Number of worker caches used by the last build.
+    uint32_t getWorkerCacheCount() const { return m_workerCacheCount; }
+    /// @brief Time from start() to the end of wait(), in milliseconds.
+    float getBuildTime() const { return m_buildTime; }
+
+private:
+    struct Job
+    {
+        std::optional<PipelineBuilder> graphics;
+        std::optional<ComputePipelineBuilder> compute;
+        vk::Pipeline *pipeline;
+        vk::Pipeline result;
+    };
+
+    void runJob(Job &job);
+
+    vk::Device m_device;
+    vk::PipelineCache m_pipelineCache;
+    ThreadPool &m_threadPool;
+
+    std::vector<Job> m_jobs;
+    std::vector<vk::ShaderModule> m_shaderModules;
+
+    std::vector<vk::PipelineCache> m_workerCaches;
+    /// Worker caches not used by a job, guarded by m_mutex.
+    std::vector<vk::PipelineCache> m_freeCaches;
+    uint32_t m_workerCacheCount;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_doneCondition;
+    uint32_t m_remainingCount;
+    std::exception_ptr m_error;
+    bool m_started;
+
+    std::chrono::steady_clock::time_point m_startTime;
+    float m_buildTime;
+};
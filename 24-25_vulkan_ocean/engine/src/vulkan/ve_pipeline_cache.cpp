@@ -0,0 +1,167 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#include "vulkan/ve_pipeline_cache.hpp"
+#include "core/ve_mapped_file.hpp"
+#include "core/ve_file_io.hpp"
+
+#include <filesystem>
+
+namespace
+{
+    constexpr char PIPELINE_CACHE_MAGIC[4] = { 'V', 'E', 'P', 'C' };
+
+    /// Header written by the driver at the beginning of the cache data
+    /// (VK_PIPELINE_CACHE_HEADER_VERSION_ONE).
+    struct VulkanCacheHeader
+    {
+        uint32_t headerSize;
+        uint32_t headerVersion;
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint8_t uuid[VK_UUID_SIZE];
+    };
+    static_assert(sizeof(VulkanCacheHeader) == 16 + VK_UUID_SIZE);
+}
+
+PipelineCache::PipelineCache(
+    vk::Device device,
+    const vk::PhysicalDeviceProperties &properties,
+    const std::string &path)
+    : m_device{ device }
+    , m_properties{ properties }
+    , m_path{ path }
+    , m_pipelineCache{ VK_NULL_HANDLE }
+    , m_stats{}
+{
+    std::vector<uint8_t> data;
+    if (m_path.empty() == false)
+    {
+        data = readFile();
+    }
+
+    vk::PipelineCacheCreateInfo pipelineCacheCI{};
+    pipelineCacheCI.initialDataSize = data.size();
+    pipelineCacheCI.pInitialData = data.empty() ? nullptr : data.data();
+    m_pipelineCache = m_device.createPipelineCache(pipelineCacheCI);
+
+    m_stats.loaded = (data.empty() == false);
+    m_stats.loadedSize = data.size();
+
+    if (m_path.empty() == false)
+    {
+        std::cerr << "Pipeline cache " << m_path << ": ";
+        if (m_stats.loaded) std::cerr << "loaded " << m_stats.loadedSize / 1024 << " kB" << std::endl;
+        else std::cerr << m_stats.rejectReason << ", cold start" << std::endl;
+    }
+}
+
+PipelineCache::~PipelineCache()
+{
+    m_device.destroyPipelineCache(m_pipelineCache);
+}
+
+size_t PipelineCache::getDataSize() const
+{
+    size_t size = 0;
+    vk::Result result = m_device.getPipelineCacheData(m_pipelineCache, &size, nullptr);
+    return (result == vk::Result::eSuccess) ? size : 0;
+}
+
+std::vector<uint8_t> PipelineCache::readFile()
+{
+    std::error_code error;
+    if (std::filesystem::exists(m_path, error) == false)
+    {
+        m_stats.rejectReason = "no file";
+        return {};
+    }
+
+    MappedFile file(m_path);
+    if (file.getSize() < sizeof(PipelineCacheFileHeader))
+    {
+        m_stats.rejectReason = "truncated file";
+        return {};
+    }
+
+    PipelineCacheFileHeader header{};
+    memcpy(&header, file.getData(), sizeof(PipelineCacheFileHeader));
+
+    const uint8_t *data = file.getData() + sizeof(PipelineCacheFileHeader);
+    const size_t dataSize = file.getSize() - sizeof(PipelineCacheFileHeader);
+
+    if (memcmp(header.magic, PIPELINE_CACHE_MAGIC, sizeof(PIPELINE_CACHE_MAGIC)) != 0 ||
+        header.version != VERSION)
+    {
+        m_stats.rejectReason = "unknown file format";
+        return {};
+    }
+    if (header.dataSize != dataSize || header.dataHash != MappedFile::computeHash(data, dataSize))
+    {
+        m_stats.rejectReason = "corrupted file";
+        return {};
+    }
+    if (checkVulkanHeader(data, dataSize) == false)
+    {
+        return {};
+    }
+
+    return std::vector<uint8_t>(data, data + dataSize);
+}
+
+bool PipelineCache::checkVulkanHeader(const uint8_t *data, size_t size)
+{
+    if (size < sizeof(VulkanCacheHeader))
+    {
+        m_stats.rejectReason = "truncated cache data";
+        return false;
+    }
+
+    VulkanCacheHeader header{};
+    memcpy(&header, data, sizeof(VulkanCacheHeader));
+
+    if (header.headerSize < sizeof(VulkanCacheHeader) ||
+        header.headerVersion != static_cast<uint32_t>(vk::PipelineCacheHeaderVersion::eOne))
+    {
+        m_stats.rejectReason = "unknown cache header";
+        return false;
+    }
+    if (header.vendorID != m_properties.vendorID || header.deviceID != m_properties.deviceID)
+    {
+        m_stats.rejectReason = "written by another device";
+        return false;
+    }
+    if (memcmp(header.uuid, m_properties.pipelineCacheUUID.data(), VK_UUID_SIZE) != 0)
+    {
+        m_stats.rejectReason = "written by another driver version";
+        return false;
+    }
+    return true;
+}
+
+void PipelineCache::save() const
+{
+    if (m_path.empty()) return;
+
+    std::vector<uint8_t> data = m_device.getPipelineCacheData(m_pipelineCache);
+
+    PipelineCacheFileHeader header{};
+    memcpy(header.magic, PIPELINE_CACHE_MAGIC, sizeof(PIPELINE_CACHE_MAGIC));
+    header.version = VERSION;
+    header.dataSize = data.size();
+    header.dataHash = MappedFile::computeHash(data.data(), data.size());
+
+    try
+    {
+        writeFileAtomic(m_path, { { &header, sizeof(header) }, { data.data(), data.size() } });
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Failed to write the pipeline cache: " << e.what() << std::endl;
+        return;
+    }
+    std::cerr << "Pipeline cache " << m_path << ": saved " << data.size() / 1024 << " kB" << std::endl;
+}
@@ -0,0 +1,75 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#pragma once
+
+#include "ve_settings.hpp"
+
+struct PipelineCacheFileHeader
+{
+    char magic[4];
+    uint32_t version;
+    /// Size and hash of the Vulkan cache data that follows, detects the
+    /// truncated and corrupted files before the driver reads them.
+    uint64_t dataSize;
+    uint64_t dataHash;
+};
+
+/// @brief Result of the loading of a pipeline cache file.
+struct PipelineCacheStats
+{
+    /// True if the pipeline cache was created from the file.
+    bool loaded = false;
+    /// Size of the Vulkan cache data read from the file.
+    size_t loadedSize = 0;
+    /// Why the file was not used, empty if it was loaded.
+    std::string rejectReason;
+};
+
+/// @brief Pipeline cache of a device, created from a file written by a
+/// previous run and saved back by save().
+/// The file is a PipelineCacheFileHeader followed by the data returned by
+/// the driver. It is only used if the Vulkan header of the data matches the
+/// vendor, the device and the pipeline cache UUID of the physical device:
+/// a driver update changes the UUID and invalidates the file.
+/// Without a path, the cache only lives in memory.
+class PipelineCache
+{
+public:
+    /// Increase when the file layout changes.
+    static constexpr uint32_t VERSION = 1;
+
+    PipelineCache(
+        vk::Device device,
+        const vk::PhysicalDeviceProperties &properties,
+        const std::string &path = "");
+    ~PipelineCache();
+
+    PipelineCache(const PipelineCache &) = delete;
+    PipelineCache &operator=(const PipelineCache &) = delete;
+
+    vk::PipelineCache getHandle() const { return m_pipelineCache; }
+    const std::string &getPath() const { return m_path; }
+    const PipelineCacheStats &getStats() const { return m_stats; }
+
+    /// @brief Current size of the cache data, grows with each new pipeline.
+    size_t getDataSize() const;
+
+    /// @brief Writes the cache with writeFileAtomic().
+    /// Failures are reported but not fatal.
+    void save() const;
+
+private:
+    /// @return the Vulkan cache data of the file, empty if it is not valid.
+    std::vector<uint8_t> readFile();
+    bool checkVulkanHeader(const uint8_t *data, size_t size);
+
+    vk::Device m_device;
+    vk::PhysicalDeviceProperties m_properties;
+    std::string m_path;
+    vk::PipelineCache m_pipelineCache;
+    PipelineCacheStats m_stats;
+};
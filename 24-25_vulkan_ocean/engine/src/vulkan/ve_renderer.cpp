@@ -6,6 +6,28 @@
 
 #include "vulkan/ve_renderer.hpp"
 #include "vulkan/ve_tools.hpp"
+#include "core/ve_cpu_trace.hpp"
+
+namespace
+{
+    uint32_t getPixelSize(vk::Format format)
+    {
+        switch (format)
+        {
+        case vk::Format::eR8G8B8A8Unorm:
+        case vk::Format::eR8G8B8A8Srgb:
+        case vk::Format::eB8G8R8A8Unorm:
+        case vk::Format::eB8G8R8A8Srgb:
+            return 4;
+        case vk::Format::eR16G16B16A16Sfloat:
+            return 8;
+        case vk::Format::eR32G32B32A32Sfloat:
+            return 16;
+        default:
+            throw std::runtime_error("unsupported headless format " + vk::to_string(format));
+        }
+    }
+}
 
 Renderer::Renderer(
     vk::PhysicalDevice &physicalDevice,
@@ -14,13 +36,20 @@ Renderer::Renderer(
     vk::Extent2D windowExtent,
     uint32_t graphicsQueueFamilyIndex,
     uint32_t presentQueueFamilyIndex,
-    vk::CommandPool commandPool
+    vk::CommandPool commandPool,
+    uint32_t framesInFlight,
+    vk::Format headlessFormat
 )
     : m_physicalDevice{ physicalDevice }
     , m_device{ device }
     , m_surface{ surface }
     , m_presentQueueFamilyIndex{ presentQueueFamilyIndex }
     , m_graphicsQueueFamilyIndex{ graphicsQueueFamilyIndex }
+    , m_requestedPresentMode{ vk::PresentModeKHR::eFifo }
+    , m_presentMode{ vk::PresentModeKHR::eFifo }
+    , m_headlessFormat{ headlessFormat }
+    , m_frameNumber{ 0 }
+    , m_framesInFlight{ framesInFlight }
     , m_frameIndex{ 0 }
     , m_commandPool{ commandPool }
     , m_isFrameStarted{ false }
@@ -28,12 +57,19 @@ Renderer::Renderer(
     init(windowExtent);
 }
 
-Renderer::Renderer(VulkanBase &base, vk::Extent2D windowExtent)
+Renderer::Renderer(
+    VulkanBase &base, vk::Extent2D windowExtent,
+    uint32_t framesInFlight, vk::Format headlessFormat)
     : m_physicalDevice{ base.getPhysicalDevice() }
     , m_device{ base.getDevice() }
     , m_surface{ base.getSurface() }
     , m_presentQueueFamilyIndex{ base.getPresentQueueFamilyIndex() }
     , m_graphicsQueueFamilyIndex{ base.getGraphicsQueueFamilyIndex() }
+    , m_requestedPresentMode{ vk::PresentModeKHR::eFifo }
+    , m_presentMode{ vk::PresentModeKHR::eFifo }
+    , m_headlessFormat{ headlessFormat }
+    , m_frameNumber{ 0 }
+    , m_framesInFlight{ framesInFlight }
     , m_frameIndex{ 0 }
     , m_commandPool{ base.getCommandPool() }
     , m_isFrameStarted{ false }
@@ -43,13 +79,30 @@ Renderer::Renderer(VulkanBase &base, vk::Extent2D windowExtent)
 
 void Renderer::init(vk::Extent2D windowExtent)
 {
-    createSwapchain(windowExtent, VK_NULL_HANDLE);
+    if (m_framesInFlight < MIN_FRAMES_IN_FLIGHT || m_framesInFlight > MAX_FRAMES_IN_FLIGHT)
+    {
+        throw std::runtime_error("the number of frames in flight must be between 1 and 4");
+    }
+
+    if (isHeadless())
+    {
+        createOffscreenImages(windowExtent);
+    }
+    else
+    {
+        createSwapchain(windowExtent, VK_NULL_HANDLE);
+    }
+    m_pendingReadbacks.resize(m_framesInFlight);
+
     createImageViews();
     createDepthResources();
     createRenderPass();
     createFramebuffers();
     createSyncObjects();
     createCommandBuffers();
+
+    m_gpuProfiler = std::make_unique<GpuProfiler>(
+        m_physicalDevice, m_device, m_graphicsQueueFamilyIndex, m_framesInFlight);
 }
 
 Renderer::~Renderer()
@@ -58,7 +111,7 @@ Renderer::~Renderer()
     m_device.freeCommandBuffers(m_commandPool, m_commandBuffers);
     m_commandBuffers.clear();
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+    for (size_t i = 0; i < m_framesInFlight; i++) {
         m_device.destroySemaphore(m_renderFinishedSemaphores[i]);
         m_device.destroySemaphore(m_imageAvailableSemaphores[i]);
         m_device.destroyFence(m_inFlightFences[i]);
@@ -66,46 +119,66 @@ Renderer::~Renderer()
 
     m_device.destroyRenderPass(m_renderPass);
 
-    for (uint32_t i = 0; i < m_imageCount; i++)
+    destroyImages();
+
+    if (m_swapchain)
     {
-        m_device.destroyFramebuffer(m_framebuffers[i]);
-        m_device.destroyImageView(m_imageViews[i]);
-        m_device.destroyImageView(m_depthImageViews[i]);
-        m_device.destroyImage(m_depthImages[i]);
-        m_device.freeMemory(m_depthImageMemories[i]);
+        m_device.destroySwapchainKHR(m_swapchain);
     }
-    m_framebuffers.clear();
-    m_imageViews.clear();
-    m_images.clear();
-    m_depthImageViews.clear();
-    m_depthImages.clear();
-    m_depthImageMemories.clear();
-
-    m_device.destroySwapchainKHR(m_swapchain);
 }
 
-VkCommandBuffer Renderer::beginFrame()
+bool Renderer::waitForFrame(uint64_t timeout)
 {
-    assert(!m_isFrameStarted && "Can't call beginFrame while already in progress");
+    VE_TRACE_SCOPE("Wait for frame");
 
     vk::Result result = m_device.waitForFences(
-        1, &m_inFlightFences[m_frameIndex],
-        VK_TRUE, std::numeric_limits<uint64_t>::max());
+        1, &m_inFlightFences[m_frameIndex], VK_TRUE, timeout);
 
-    result = m_device.acquireNextImageKHR(
-        m_swapchain, std::numeric_limits<uint64_t>::max(),
-        m_imageAvailableSemaphores[m_frameIndex],
-        VK_NULL_HANDLE,
-        &m_imageIndex);
+    if (result == vk::Result::eTimeout)
+    {
+        return false;
+    }
+    else if (result != vk::Result::eSuccess)
+    {
+        throw std::runtime_error("failed to wait for the frame fence!");
+    }
+    return true;
+}
 
-    if (result == vk::Result::eErrorOutOfDateKHR)
+VkCommandBuffer Renderer::beginFrame()
+{
+    assert(!m_isFrameStarted && "Can't call beginFrame while already in progress");
+
+    // A finite timeout keeps the event loop alive when the GPU stalls
+    if (waitForFrame(FRAME_TIMEOUT) == false)
     {
         return nullptr;
     }
-    else if (result != vk::Result::eSuccess && result != vk::Result::eSuboptimalKHR)
+
+    if (isHeadless())
     {
-        throw std::runtime_error("failed to acquire swapchain image!");
-        return nullptr;
+        // The frame previously rendered in this slot is complete
+        deliverReadback(m_frameIndex);
+        m_imageIndex = m_frameIndex;
+    }
+    else
+    {
+        VE_TRACE_SCOPE("Acquire image");
+        vk::Result result = m_device.acquireNextImageKHR(
+            m_swapchain, std::numeric_limits<uint64_t>::max(),
+            m_imageAvailableSemaphores[m_frameIndex],
+            VK_NULL_HANDLE,
+            &m_imageIndex);
+
+        if (result == vk::Result::eErrorOutOfDateKHR)
+        {
+            return nullptr;
+        }
+        else if (result != vk::Result::eSuccess && result != vk::Result::eSuboptimalKHR)
+        {
+            throw std::runtime_error("failed to acquire swapchain image!");
+            return nullptr;
+        }
     }
 
     m_isFrameStarted = true;
@@ -116,6 +189,9 @@ VkCommandBuffer Renderer::beginFrame()
     vk::CommandBufferBeginInfo beginInfo{};
     commandBuffer.begin(beginInfo);
 
+    m_gpuProfiler->beginFrame(commandBuffer, m_frameIndex, m_frameNumber);
+    m_gpuProfiler->beginScope(commandBuffer, "Frame");
+
     return commandBuffer;
 }
 
@@ -124,6 +200,14 @@ void Renderer::endFrame()
     assert(m_isFrameStarted && "Can't call endFrame while frame is not in progress");
 
     vk::CommandBuffer commandBuffer = m_commandBuffers[m_frameIndex];
+    if (isHeadless())
+    {
+        m_gpuProfiler->beginScope(commandBuffer, "Readback");
+        recordReadback(commandBuffer);
+        m_gpuProfiler->endScope(commandBuffer);
+    }
+    m_gpuProfiler->endScope(commandBuffer);
+    m_gpuProfiler->endFrame();
     commandBuffer.end();
 
     vk::Queue graphicsQueue = m_device.getQueue(m_graphicsQueueFamilyIndex, 0);
@@ -144,8 +228,26 @@ void Renderer::endFrame()
     submitInfo.signalSemaphoreCount = 1;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
+    if (isHeadless())
+    {
+        // Nothing to wait for nor to present
+        submitInfo.waitSemaphoreCount = 0;
+        submitInfo.signalSemaphoreCount = 0;
+    }
+
     vk::Result result = m_device.resetFences(1, &m_inFlightFences[m_frameIndex]);
-    result = graphicsQueue.submit(1, &submitInfo, m_inFlightFences[m_frameIndex]);
+    {
+        VE_TRACE_SCOPE("Submit");
+        result = graphicsQueue.submit(1, &submitInfo, m_inFlightFences[m_frameIndex]);
+    }
+
+    if (isHeadless())
+    {
+        m_pendingReadbacks[m_frameIndex] = m_frameNumber++;
+        m_frameIndex = (m_frameIndex + 1) % m_framesInFlight;
+        m_isFrameStarted = false;
+        return;
+    }
 
     // Present
     vk::PresentInfoKHR presentInfo = {};
@@ -157,9 +259,13 @@ void Renderer::endFrame()
     presentInfo.pSwapchains = swapChains;
     presentInfo.pImageIndices = &m_imageIndex;
 
-    result = presentQueue.presentKHR(presentInfo);
+    {
+        VE_TRACE_SCOPE("Present");
+        result = presentQueue.presentKHR(presentInfo);
+    }
 
-    m_frameIndex = (m_frameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
+    m_frameNumber++;
+    m_frameIndex = (m_frameIndex + 1) % m_framesInFlight;
     m_isFrameStarted = false;
 }
 
@@ -184,6 +290,7 @@ void Renderer::beginRenderPass()
     renderPassBeginInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
     renderPassBeginInfo.pClearValues = clearValues.data();
 
+    m_gpuProfiler->beginScope(commandBuffer, "Render pass");
     commandBuffer.beginRenderPass(renderPassBeginInfo, vk::SubpassContents::eInline);
 
     vk::Viewport viewport{};
@@ -209,6 +316,7 @@ void Renderer::endRenderPass()
 
     vk::CommandBuffer commandBuffer = m_commandBuffers[m_frameIndex];
     commandBuffer.endRenderPass();
+    m_gpuProfiler->endScope(commandBuffer);
 }
 
 void Renderer::recreateSwapchain(vk::Extent2D extent)
@@ -219,25 +327,21 @@ void Renderer::recreateSwapchain(vk::Extent2D extent)
         << extent.width << ", "
         << extent.height << ")" << std::endl;
 
-    for (uint32_t i = 0; i < m_imageCount; i++)
+    if (isHeadless())
     {
-        m_device.destroyFramebuffer(m_framebuffers[i]);
-        m_device.destroyImageView(m_imageViews[i]);
-        m_device.destroyImageView(m_depthImageViews[i]);
-        m_device.destroyImage(m_depthImages[i]);
-        m_device.freeMemory(m_depthImageMemories[i]);
+        flushReadbacks();
+        destroyImages();
+        createOffscreenImages(extent);
     }
-    m_framebuffers.clear();
-    m_imageViews.clear();
-    m_images.clear();
-    m_depthImageViews.clear();
-    m_depthImages.clear();
-    m_depthImageMemories.clear();
+    else
+    {
+        destroyImages();
 
-    vk::SwapchainKHR oldSwapchain = m_swapchain;
-    createSwapchain(extent, m_swapchain);
+        vk::SwapchainKHR oldSwapchain = m_swapchain;
+        createSwapchain(extent, m_swapchain);
 
-    m_device.destroySwapchainKHR(oldSwapchain);
+        m_device.destroySwapchainKHR(oldSwapchain);
+    }
 
     createImageViews();
     createDepthResources();
@@ -248,10 +352,12 @@ void Renderer::createSwapchain(vk::Extent2D windowExtent, vk::SwapchainKHR oldSw
 {
     vk::SurfaceCapabilitiesKHR surfaceCapabilities = m_physicalDevice.getSurfaceCapabilitiesKHR(m_surface);
     vk::SurfaceFormatKHR surfaceFormat = chooseSurfaceFormat();
-    vk::PresentModeKHR presentMode = choosePresentMode();
+    m_presentMode = choosePresentMode();
     vk::Extent2D extent = chooseExtent(surfaceCapabilities, windowExtent);
 
-    uint32_t imageCount = surfaceCapabilities.minImageCount + 1;
+    // One image more than the frames in flight, so that acquiring an image
+    // never waits for a frame the CPU is allowed to record in the meantime
+    uint32_t imageCount = std::max(surfaceCapabilities.minImageCount + 1, m_framesInFlight + 1);
     if (surfaceCapabilities.maxImageCount > 0 && imageCount > surfaceCapabilities.maxImageCount)
     {
         imageCount = surfaceCapabilities.maxImageCount;
@@ -282,7 +388,7 @@ void Renderer::createSwapchain(vk::Extent2D windowExtent, vk::SwapchainKHR oldSw
 
     swapchainCI.preTransform = surfaceCapabilities.currentTransform;
     swapchainCI.compositeAlpha = vk::CompositeAlphaFlagBitsKHR::eOpaque;
-    swapchainCI.presentMode = presentMode;
+    swapchainCI.presentMode = m_presentMode;
     swapchainCI.clipped = vk::True;
     swapchainCI.oldSwapchain = oldSwapchain;
 
@@ -294,6 +400,216 @@ void Renderer::createSwapchain(vk::Extent2D windowExtent, vk::SwapchainKHR oldSw
     m_extent = extent;
 }
 
+void Renderer::createOffscreenImages(vk::Extent2D extent)
+{
+    MemoryAllocator *allocator = MemoryAllocator::find(m_device);
+
+    m_imageFormat = m_headlessFormat;
+    m_extent = extent;
+    m_imageCount = m_framesInFlight;
+
+    m_images.resize(m_imageCount);
+    m_offscreenImageAllocations.resize(m_imageCount);
+
+    for (uint32_t i = 0; i < m_imageCount; i++)
+    {
+        vk::ImageCreateInfo imageCI{};
+        imageCI.imageType = vk::ImageType::e2D;
+        imageCI.extent.width = m_extent.width;
+        imageCI.extent.height = m_extent.height;
+        imageCI.extent.depth = 1;
+        imageCI.mipLevels = 1;
+        imageCI.arrayLayers = 1;
+        imageCI.format = m_imageFormat;
+        imageCI.tiling = vk::ImageTiling::eOptimal;
+        imageCI.initialLayout = vk::ImageLayout::eUndefined;
+        imageCI.usage =
+            vk::ImageUsageFlagBits::eColorAttachment |
+            vk::ImageUsageFlagBits::eTransferSrc;
+        imageCI.samples = vk::SampleCountFlagBits::e1;
+        imageCI.sharingMode = vk::SharingMode::eExclusive;
+
+        m_images[i] = m_device.createImage(imageCI);
+
+        vk::MemoryRequirements memoryRequirements =
+            m_device.getImageMemoryRequirements(m_images[i]);
+        m_offscreenImageAllocations[i] = allocator->allocate(
+            memoryRequirements, vk::MemoryPropertyFlagBits::eDeviceLocal, true);
+        m_device.bindImageMemory(
+            m_images[i],
+            m_offscreenImageAllocations[i].memory,
+            m_offscreenImageAllocations[i].offset);
+    }
+
+    // One host visible slice per frame slot. Every frame is read by the
+    // CPU, so cached memory is preferred, invalidated when not coherent
+    vk::DeviceSize frameSize =
+        static_cast<vk::DeviceSize>(m_extent.width) * m_extent.height *
+        getPixelSize(m_imageFormat);
+
+    vk::PhysicalDeviceMemoryProperties memoryProperties = m_physicalDevice.getMemoryProperties();
+    vk::MemoryPropertyFlags readbackFlags =
+        vk::MemoryPropertyFlagBits::eHostVisible |
+        vk::MemoryPropertyFlagBits::eHostCached;
+    bool hasCachedMemory = false;
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+    {
+        if ((memoryProperties.memoryTypes[i].propertyFlags & readbackFlags) == readbackFlags)
+        {
+            hasCachedMemory = true;
+            break;
+        }
+    }
+    if (hasCachedMemory == false)
+    {
+        readbackFlags =
+            vk::MemoryPropertyFlagBits::eHostVisible |
+            vk::MemoryPropertyFlagBits::eHostCoherent;
+    }
+
+    m_readbackBuffer = std::make_unique<Buffer>(
+        m_device,
+        memoryProperties,
+        m_framesInFlight,
+        frameSize,
+        vk::BufferUsageFlagBits::eTransferDst,
+        readbackFlags,
+        16);
+    m_readbackBuffer->map();
+}
+
+void Renderer::destroyImages()
+{
+    MemoryAllocator *allocator = MemoryAllocator::find(m_device);
+
+    for (uint32_t i = 0; i < m_imageCount; i++)
+    {
+        m_device.destroyFramebuffer(m_framebuffers[i]);
+        m_device.destroyImageView(m_imageViews[i]);
+        m_device.destroyImageView(m_depthImageViews[i]);
+        m_device.destroyImage(m_depthImages[i]);
+        allocator->free(m_depthImageAllocations[i]);
+    }
+    if (isHeadless())
+    {
+        // The swapchain images are owned by the swapchain
+        for (uint32_t i = 0; i < m_imageCount; i++)
+        {
+            m_device.destroyImage(m_images[i]);
+            allocator->free(m_offscreenImageAllocations[i]);
+        }
+        m_offscreenImageAllocations.clear();
+        m_readbackBuffer.reset();
+    }
+    m_framebuffers.clear();
+    m_imageViews.clear();
+    m_images.clear();
+    m_depthImageViews.clear();
+    m_depthImages.clear();
+    m_depthImageAllocations.clear();
+}
+
+void Renderer::recordReadback(vk::CommandBuffer commandBuffer)
+{
+    vk::ImageSubresourceRange subresourceRange{};
+    subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+    subresourceRange.baseMipLevel = 0;
+    subresourceRange.levelCount = 1;
+    subresourceRange.baseArrayLayer = 0;
+    subresourceRange.layerCount = 1;
+
+    // The render pass leaves the image in eTransferSrcOptimal
+    vk::ImageMemoryBarrier imageBarrier{};
+    imageBarrier.srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+    imageBarrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
+    imageBarrier.oldLayout = vk::ImageLayout::eTransferSrcOptimal;
+    imageBarrier.newLayout = vk::ImageLayout::eTransferSrcOptimal;
+    imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.image = m_images[m_imageIndex];
+    imageBarrier.subresourceRange = subresourceRange;
+
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eColorAttachmentOutput,
+        vk::PipelineStageFlagBits::eTransfer,
+        {}, nullptr, nullptr, imageBarrier);
+
+    vk::DeviceSize offset = m_readbackBuffer->getAlignmentSize() * m_frameIndex;
+
+    vk::BufferImageCopy region{};
+    region.bufferOffset = offset;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = vk::Offset3D{ 0, 0, 0 };
+    region.imageExtent = vk::Extent3D{ m_extent.width, m_extent.height, 1 };
+
+    commandBuffer.copyImageToBuffer(
+        m_images[m_imageIndex], vk::ImageLayout::eTransferSrcOptimal,
+        m_readbackBuffer->getBuffer(), region);
+
+    // Visible to the host once the fence of the frame is signaled
+    vk::BufferMemoryBarrier bufferBarrier{};
+    bufferBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+    bufferBarrier.dstAccessMask = vk::AccessFlagBits::eHostRead;
+    bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.buffer = m_readbackBuffer->getBuffer();
+    bufferBarrier.offset = offset;
+    bufferBarrier.size = m_readbackBuffer->getElementSize();
+
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eHost,
+        {}, nullptr, bufferBarrier, nullptr);
+}
+
+void Renderer::deliverReadback(uint32_t frameSlot)
+{
+    VE_TRACE_SCOPE("Deliver readback");
+
+    std::optional<uint64_t> &frameNumber = m_pendingReadbacks[frameSlot];
+    if (frameNumber.has_value() == false) return;
+
+    if (m_readbackCallback)
+    {
+        const vk::DeviceSize offset = m_readbackBuffer->getAlignmentSize() * frameSlot;
+        m_readbackBuffer->invalidate(m_readbackBuffer->getElementSize(), offset);
+
+        const uint8_t *mapped = static_cast<const uint8_t *>(m_readbackBuffer->getMappedMemory());
+
+        FrameReadback readback{};
+        readback.frameNumber = frameNumber.value();
+        readback.width = m_extent.width;
+        readback.height = m_extent.height;
+        readback.format = m_imageFormat;
+        readback.data = mapped + offset;
+        readback.size = m_readbackBuffer->getElementSize();
+
+        m_readbackCallback(readback);
+    }
+    frameNumber.reset();
+}
+
+void Renderer::setReadbackCallback(std::function<void(const FrameReadback &)> callback)
+{
+    m_readbackCallback = std::move(callback);
+}
+
+void Renderer::flushReadbacks()
+{
+    m_device.waitIdle();
+
+    // The oldest frame is in the slot that will be reused first
+    for (uint32_t i = 0; i < m_framesInFlight; i++)
+    {
+        deliverReadback((m_frameIndex + i) % m_framesInFlight);
+    }
+}
+
 void Renderer::createImageViews()
 {
     m_imageViews.resize(m_imageCount);
@@ -319,7 +635,7 @@ void Renderer::createDepthResources()
     m_depthFormat = vk::Format::eD32Sfloat;
 
     m_depthImages.resize(m_imageCount);
-    m_depthImageMemories.resize(m_imageCount);
+    m_depthImageAllocations.resize(m_imageCount);
     m_depthImageViews.resize(m_imageCount);
 
     for (int i = 0; i < m_depthImages.size(); i++)
@@ -344,18 +660,12 @@ void Renderer::createDepthResources()
         // Create memory and bind it
         vk::MemoryRequirements memoryRequirements =
             m_device.getImageMemoryRequirements(m_depthImages[i]);
-        vk::PhysicalDeviceMemoryProperties memoryProperties =
-            m_physicalDevice.getMemoryProperties();
-
-        vk::MemoryAllocateInfo allocInfo{};
-        allocInfo.allocationSize = memoryRequirements.size;
-        allocInfo.memoryTypeIndex = tools::findMemoryTypeIndex(
-            memoryProperties,
-            memoryRequirements.memoryTypeBits,
-            vk::MemoryPropertyFlagBits::eDeviceLocal);
-
-        m_depthImageMemories[i] = m_device.allocateMemory(allocInfo);
-        m_device.bindImageMemory(m_depthImages[i], m_depthImageMemories[i], 0);
+        m_depthImageAllocations[i] = MemoryAllocator::find(m_device)->allocate(
+            memoryRequirements, vk::MemoryPropertyFlagBits::eDeviceLocal, true);
+        m_device.bindImageMemory(
+            m_depthImages[i],
+            m_depthImageAllocations[i].memory,
+            m_depthImageAllocations[i].offset);
 
         // Create image view
         vk::ImageViewCreateInfo imageViewCI{};
@@ -383,7 +693,9 @@ void Renderer::createRenderPass()
         .attachmentStencilLoadOp(vk::AttachmentLoadOp::eDontCare)
         .attachmentStencilStoreOp(vk::AttachmentStoreOp::eDontCare)
         .attachmentInitialLayout(vk::ImageLayout::eUndefined)
-        .attachmentFinalLayout(vk::ImageLayout::ePresentSrcKHR);
+        .attachmentFinalLayout(isHeadless()
+            ? vk::ImageLayout::eTransferSrcOptimal
+            : vk::ImageLayout::ePresentSrcKHR);
 
     // Depth attachement [1]
     renderPassBuilder.attachmentBegin(m_depthFormat)
@@ -438,16 +750,16 @@ void Renderer::createFramebuffers()
 
 void Renderer::createSyncObjects()
 {
-    m_imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    m_renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    m_inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+    m_imageAvailableSemaphores.resize(m_framesInFlight);
+    m_renderFinishedSemaphores.resize(m_framesInFlight);
+    m_inFlightFences.resize(m_framesInFlight);
 
     vk::SemaphoreCreateInfo semaphoreCI{};
 
     vk::FenceCreateInfo fenceCI{};
     fenceCI.flags = vk::FenceCreateFlagBits::eSignaled;
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         m_imageAvailableSemaphores[i] = m_device.createSemaphore(semaphoreCI);
         m_renderFinishedSemaphores[i] = m_device.createSemaphore(semaphoreCI);
@@ -460,7 +772,7 @@ void Renderer::createCommandBuffers()
     vk::CommandBufferAllocateInfo commandBufferAllocInfo{};
     commandBufferAllocInfo.level = vk::CommandBufferLevel::ePrimary;
     commandBufferAllocInfo.commandPool = m_commandPool;
-    commandBufferAllocInfo.commandBufferCount = MAX_FRAMES_IN_FLIGHT;
+    commandBufferAllocInfo.commandBufferCount = m_framesInFlight;
 
     m_commandBuffers = m_device.allocateCommandBuffers(commandBufferAllocInfo);
 }
@@ -483,19 +795,32 @@ vk::SurfaceFormatKHR Renderer::chooseSurfaceFormat()
 
 vk::PresentModeKHR Renderer::choosePresentMode()
 {
+    // FIFO is the only mode required by the specification
+    vk::PresentModeKHR presentMode = isPresentModeSupported(m_requestedPresentMode)
+        ? m_requestedPresentMode
+        : vk::PresentModeKHR::eFifo;
+
+    std::cout << "Present mode: " << vk::to_string(presentMode) << std::endl;
+    return presentMode;
+}
+
+bool Renderer::isPresentModeSupported(vk::PresentModeKHR presentMode) const
+{
+    if (isHeadless()) return false;
+
     std::vector<vk::PresentModeKHR> availablePresentModes = m_physicalDevice.getSurfacePresentModesKHR(m_surface);
-    for (const auto &availablePresentMode : availablePresentModes)
-    {
-        if (availablePresentMode == vk::PresentModeKHR::eFifo)
-        {
-            std::cout << "Present mode: " << vk::to_string(availablePresentMode) << std::endl;
+    return std::find(
+        availablePresentModes.begin(), availablePresentModes.end(),
+        presentMode) != availablePresentModes.end();
+}
 
-            return availablePresentMode;
-        }
+void Renderer::setPresentMode(vk::PresentModeKHR presentMode)
+{
+    m_requestedPresentMode = presentMode;
+    if (isHeadless() == false && presentMode != m_presentMode)
+    {
+        recreateSwapchain(m_extent);
     }
-
-    std::cout << "Present mode: " << vk::to_string(availablePresentModes[0]) << std::endl;
-    return availablePresentModes[0];
 }
 
 vk::Extent2D Renderer::chooseExtent(const vk::SurfaceCapabilitiesKHR &capabilities, vk::Extent2D windowExtent)
@@ -8,6 +8,10 @@
 
 #include "ve_settings.hpp"
 #include "ve_base.hpp"
+#include "vulkan/ve_buffer.hpp"
+#include "vulkan/ve_gpu_profiler.hpp"
+
+#include <functional>
 
 class RenderPassBuilder
 {
@@ -47,10 +51,41 @@ private:
     vk::AttachmentReference m_depthAttachmentReference;
 };
 
+/// @brief Frame read back from the offscreen image of a headless renderer.
+struct FrameReadback
+{
+    /// Index of the frame since the creation of the renderer.
+    uint64_t frameNumber = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    vk::Format format = vk::Format::eUndefined;
+    /// Tightly packed rows, only valid during the readback callback.
+    const void *data = nullptr;
+    vk::DeviceSize size = 0;
+};
+
+/// @brief Renders into the swapchain of a surface or, when there is no
+/// surface, into offscreen images that are read back to the host.
+/// Headless frames are copied into a host visible buffer of their frame
+/// slot and handed to the readback callback once the fence of the slot is
+/// signaled, so the readback never stalls the recording of the next frames.
+/// The frames and the render passes are measured by the GPU profiler of the
+/// renderer, the application adds its own scopes inside.
 class Renderer
 {
 public:
-    static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 2;
+    /// Bounds of the number of frames the CPU can record ahead of the GPU.
+    /// One frame in flight gives the lowest latency, more frames in flight
+    /// let the CPU and the GPU overlap for a better throughput.
+    static constexpr uint32_t MIN_FRAMES_IN_FLIGHT = 1;
+    static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+    static constexpr uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
+
+    /// Color format of the offscreen images of a headless renderer.
+    static constexpr vk::Format DEFAULT_HEADLESS_FORMAT = vk::Format::eR8G8B8A8Unorm;
+
+    /// Timeout of the fence wait in beginFrame(), in nanoseconds.
+    static constexpr uint64_t FRAME_TIMEOUT = 100'000'000;
 
     Renderer(
         vk::PhysicalDevice &physicalDevice,
@@ -59,9 +94,16 @@ public:
         vk::Extent2D windowExtent,
         uint32_t graphicsQueueFamilyIndex,
         uint32_t presentQueueFamilyIndex,
-        vk::CommandPool commandPool
+        vk::CommandPool commandPool,
+        uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT,
+        vk::Format headlessFormat = DEFAULT_HEADLESS_FORMAT
     );
-    Renderer(VulkanBase &base, vk::Extent2D windowExtent);
+    /// @param headlessFormat color format used when the base has no surface.
+    Renderer(
+        VulkanBase &base,
+        vk::Extent2D windowExtent,
+        uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT,
+        vk::Format headlessFormat = DEFAULT_HEADLESS_FORMAT);
 
     Renderer(const Renderer &) = delete;
     Renderer &operator=(const Renderer &) = delete;
@@ -73,8 +115,33 @@ public:
     float getAspectRatio() const;
 
     uint32_t getFrameIndex() const { return m_frameIndex; }
+    /// @brief Number of the next frame, counts the submitted frames.
+    uint64_t getFrameNumber() const { return m_frameNumber; }
+    /// @brief Number of frames in flight, every per frame resource is sized from it.
+    uint32_t getFramesInFlight() const { return m_framesInFlight; }
+    uint32_t getImageCount() const { return m_imageCount; }
+    vk::Format getImageFormat() const { return m_imageFormat; }
+
+    bool isHeadless() const { return !m_surface; }
+
+    /// @brief Receives the headless frames, in order, from the render thread.
+    void setReadbackCallback(std::function<void(const FrameReadback &)> callback);
+
+    /// @brief Waits for the GPU and hands the pending headless frames to the
+    /// readback callback.
+    void flushReadbacks();
     vk::RenderPass getRenderPass() const { return m_renderPass; }
 
+    GpuProfiler &getGpuProfiler() { return *m_gpuProfiler; }
+
+    /// @brief Waits until the GPU is done with the previous use of the
+    /// current frame, so its resources can be updated.
+    /// @return false if the timeout expired.
+    bool waitForFrame(uint64_t timeout = std::numeric_limits<uint64_t>::max());
+
+    /// @brief Starts recording the current frame.
+    /// @return nullptr if the frame must be skipped, when the swapchain is
+    /// out of date or the GPU did not finish the frame within FRAME_TIMEOUT.
     VkCommandBuffer beginFrame();
     void endFrame();
     void beginRenderPass();
@@ -82,9 +149,19 @@ public:
 
     void recreateSwapchain(vk::Extent2D extent);
 
+    /// @brief Selects the present mode, the swapchain is recreated.
+    /// Falls back to FIFO, always supported, if the mode is not.
+    void setPresentMode(vk::PresentModeKHR presentMode);
+    vk::PresentModeKHR getPresentMode() const { return m_presentMode; }
+    bool isPresentModeSupported(vk::PresentModeKHR presentMode) const;
+
 private:
     void init(vk::Extent2D windowExtent);
     void createSwapchain(vk::Extent2D windowExtent, vk::SwapchainKHR oldSwapchain);
+    void createOffscreenImages(vk::Extent2D extent);
+    void destroyImages();
+    void recordReadback(vk::CommandBuffer commandBuffer);
+    void deliverReadback(uint32_t frameSlot);
     void createImageViews();
     void createDepthResources();
     void createRenderPass();
@@ -105,15 +182,26 @@ private:
 
     vk::SwapchainKHR m_swapchain;
     vk::Extent2D m_extent;
+    vk::PresentModeKHR m_requestedPresentMode;
+    vk::PresentModeKHR m_presentMode;
 
     uint32_t m_imageCount;
     vk::Format m_imageFormat;
     std::vector<vk::Image> m_images;
     std::vector<vk::ImageView> m_imageViews;
 
+    // Headless rendering
+    vk::Format m_headlessFormat;
+    std::vector<MemoryAllocation> m_offscreenImageAllocations;
+    std::unique_ptr<Buffer> m_readbackBuffer;
+    /// Frame number waiting in the readback buffer of each slot.
+    std::vector<std::optional<uint64_t>> m_pendingReadbacks;
+    std::function<void(const FrameReadback &)> m_readbackCallback;
+    uint64_t m_frameNumber;
+
     vk::Format m_depthFormat;
     std::vector<vk::Image> m_depthImages;
-    std::vector<vk::DeviceMemory> m_depthImageMemories;
+    std::vector<MemoryAllocation> m_depthImageAllocations;
     std::vector<vk::ImageView> m_depthImageViews;
 
     vk::RenderPass m_renderPass;
@@ -123,10 +211,13 @@ private:
     std::vector<vk::Semaphore> m_renderFinishedSemaphores;
     std::vector<vk::Fence> m_inFlightFences;
 
+    uint32_t m_framesInFlight;
     uint32_t m_frameIndex;
     uint32_t m_imageIndex;
 
     std::vector<vk::CommandBuffer> m_commandBuffers;
 
+    std::unique_ptr<GpuProfiler> m_gpuProfiler;
+
     bool m_isFrameStarted;
 };
@@ -0,0 +1,223 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#include "vulkan/ve_staging.hpp"
+#include "vulkan/ve_base.hpp"
+#include "vulkan/ve_tools.hpp"
+
+StagingRing::StagingRing(VulkanBase &base, vk::DeviceSize capacity, uint32_t slotCount)
+    : m_base{ base }
+    , m_slotSize{ 0 }
+    , m_stagingBuffer{}
+    , m_slots{}
+    , m_slotIndex{ 0 }
+    , m_slotOffset{ 0 }
+    , m_submitCount{ 0 }
+{
+    assert(capacity > 0 && slotCount > 0);
+
+    vk::Device device = m_base.getDevice();
+
+    // Slots are aligned for the optimal copy offset alignment
+    const vk::DeviceSize alignment = std::max<vk::DeviceSize>(
+        m_base.getProperties().limits.optimalBufferCopyOffsetAlignment, 16);
+    m_slotSize = tools::alignedVkSize((capacity + slotCount - 1) / slotCount, alignment);
+
+    // The ring may live as long as the application, a transient allocation
+    // would keep its linear block from ever rewinding
+    m_stagingBuffer = std::make_unique<Buffer>(
+        device,
+        m_base.getMemoryProperties(),
+        slotCount,
+        m_slotSize,
+        vk::BufferUsageFlagBits::eTransferSrc,
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+        1,
+        AllocationLifetime::ePersistent);
+    m_stagingBuffer->map();
+
+    vk::CommandBufferAllocateInfo commandBufferAllocInfo{
+        m_base.getCommandPool(), vk::CommandBufferLevel::ePrimary, slotCount
+    };
+    std::vector<vk::CommandBuffer> commandBuffers =
+        device.allocateCommandBuffers(commandBufferAllocInfo);
+
+    m_slots.resize(slotCount);
+    for (uint32_t i = 0; i < slotCount; i++)
+    {
+        m_slots[i].commandBuffer = commandBuffers[i];
+        m_slots[i].fence = device.createFence(vk::FenceCreateInfo{});
+        m_slots[i].recording = false;
+        m_slots[i].pending = false;
+    }
+}
+
+StagingRing::~StagingRing()
+{
+    flush();
+
+    vk::Device device = m_base.getDevice();
+    for (Slot &slot : m_slots)
+    {
+        device.destroyFence(slot.fence);
+        device.freeCommandBuffers(m_base.getCommandPool(), slot.commandBuffer);
+    }
+}
+
+void StagingRing::upload(
+    vk::Buffer dstBuffer,
+    const void *data,
+    vk::DeviceSize size,
+    vk::DeviceSize dstOffset)
+{
+    const uint8_t *src = static_cast<const uint8_t *>(data);
+    uint8_t *mapped = static_cast<uint8_t *>(m_stagingBuffer->getMappedMemory());
+
+    while (size > 0)
+    {
+        if (m_slotOffset == m_slotSize)
+        {
+            submitSlot();
+        }
+        if (m_slots[m_slotIndex].recording == false)
+        {
+            beginSlot();
+        }
+
+        const vk::DeviceSize chunkSize = std::min(size, m_slotSize - m_slotOffset);
+        const vk::DeviceSize srcOffset = m_slotIndex * m_slotSize + m_slotOffset;
+
+        memcpy(mapped + srcOffset, src, chunkSize);
+        recordCopy(dstBuffer, srcOffset, dstOffset, chunkSize);
+
+        src += chunkSize;
+        dstOffset += chunkSize;
+        size -= chunkSize;
+    }
+}
+
+void StagingRing::upload(
+    vk::Buffer dstBuffer,
+    vk::DeviceSize elementSize,
+    uint32_t elementCount,
+    const WriteFunction &write,
+    vk::DeviceSize dstOffset)
+{
+    assert(elementSize > 0 && elementSize <= m_slotSize && "The elements must fit in a slot");
+
+    uint8_t *mapped = static_cast<uint8_t *>(m_stagingBuffer->getMappedMemory());
+    uint32_t first = 0;
+
+    while (first < elementCount)
+    {
+        if (m_slotSize - m_slotOffset < elementSize)
+        {
+            submitSlot();
+        }
+        if (m_slots[m_slotIndex].recording == false)
+        {
+            beginSlot();
+        }
+
+        const uint32_t chunkCount = static_cast<uint32_t>(std::min<vk::DeviceSize>(
+            elementCount - first, (m_slotSize - m_slotOffset) / elementSize));
+        const vk::DeviceSize chunkSize = chunkCount * elementSize;
+        const vk::DeviceSize srcOffset = m_slotIndex * m_slotSize + m_slotOffset;
+
+        write(mapped + srcOffset, first, chunkCount);
+        recordCopy(dstBuffer, srcOffset, dstOffset, chunkSize);
+
+        first += chunkCount;
+        dstOffset += chunkSize;
+    }
+}
+
+void StagingRing::flush()
+{
+    if (m_slots[m_slotIndex].recording)
+    {
+        submitSlot();
+    }
+
+    vk::Device device = m_base.getDevice();
+    for (Slot &slot : m_slots)
+    {
+        if (slot.pending == false) continue;
+
+        vk::Result result = device.waitForFences(
+            slot.fence, vk::True, std::numeric_limits<uint64_t>::max());
+        if (result != vk::Result::eSuccess)
+        {
+            throw std::runtime_error("Failed to wait for a staging upload");
+        }
+        device.resetFences(slot.fence);
+        slot.pending = false;
+    }
+}
+
+void StagingRing::beginSlot()
+{
+    vk::Device device = m_base.getDevice();
+    Slot &slot = m_slots[m_slotIndex];
+
+    // The slot memory is reused, wait for its previous copies
+    if (slot.pending)
+    {
+        vk::Result result = device.waitForFences(
+            slot.fence, vk::True, std::numeric_limits<uint64_t>::max());
+        if (result != vk::Result::eSuccess)
+        {
+            throw std::runtime_error("Failed to wait for a staging upload");
+        }
+        device.resetFences(slot.fence);
+        slot.pending = false;
+    }
+
+    vk::CommandBufferBeginInfo commandBufferBeginInfo{};
+    commandBufferBeginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+    slot.commandBuffer.begin(commandBufferBeginInfo);
+
+    slot.recording = true;
+    m_slotOffset = 0;
+}
+
+void StagingRing::recordCopy(
+    vk::Buffer dstBuffer,
+    vk::DeviceSize srcOffset,
+    vk::DeviceSize dstOffset,
+    vk::DeviceSize size)
+{
+    vk::BufferCopy copyRegion{};
+    copyRegion.srcOffset = srcOffset;
+    copyRegion.dstOffset = dstOffset;
+    copyRegion.size = size;
+    m_slots[m_slotIndex].commandBuffer.copyBuffer(
+        m_stagingBuffer->getBuffer(), dstBuffer, 1, &copyRegion);
+
+    // Keep the next copy aligned in the staging memory
+    m_slotOffset = std::min(
+        tools::alignedVkSize(m_slotOffset + size, 16), m_slotSize);
+}
+
+void StagingRing::submitSlot()
+{
+    Slot &slot = m_slots[m_slotIndex];
+    assert(slot.recording);
+
+    slot.commandBuffer.end();
+
+    vk::SubmitInfo submitInfo{};
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &slot.commandBuffer;
+    m_base.getGraphicsQueue().submit(submitInfo, slot.fence);
+
+    slot.recording = false;
+    slot.pending = true;
+    m_submitCount++;
+
+    m_slotIndex = (m_slotIndex + 1) % static_cast<uint32_t>(m_slots.size());
+    m_slotOffset = 0;
+}
@@ -0,0 +1,89 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#pragma once
+
+#include "ve_settings.hpp"
+#include "vulkan/ve_buffer.hpp"
+
+#include <functional>
+
+class VulkanBase;
+
+/// @brief Streams data to device local buffers through a fixed ring of
+/// staging memory.
+/// The staging buffer is split into slots, each with its own command buffer
+/// and fence. Copies are appended to the current slot, which is submitted
+/// when it is full, so uploads larger than the ring are streamed in chunks.
+/// The CPU only waits for a slot when it needs to reuse it.
+class StagingRing
+{
+public:
+    /// @param capacity total size of the staging memory.
+    /// @param slotCount number of chunks that can be in flight.
+    StagingRing(
+        VulkanBase &base,
+        vk::DeviceSize capacity = DEFAULT_CAPACITY,
+        uint32_t slotCount = 4);
+    ~StagingRing();
+
+    StagingRing(const StagingRing &) = delete;
+    StagingRing &operator=(const StagingRing &) = delete;
+
+    static constexpr vk::DeviceSize DEFAULT_CAPACITY = 64ull << 20;
+
+    /// Writes the elements [first, first + count) of the uploaded array to
+    /// dst, which points into the mapped staging memory.
+    using WriteFunction = std::function<void(void *dst, uint32_t first, uint32_t count)>;
+
+    /// @brief Records a copy of size bytes from data to dstBuffer.
+    /// The copy is not complete before flush() returns.
+    void upload(
+        vk::Buffer dstBuffer,
+        const void *data,
+        vk::DeviceSize size,
+        vk::DeviceSize dstOffset = 0);
+
+    /// @brief Records a copy of elementCount elements generated by write
+    /// directly in the staging memory, without intermediate array.
+    /// Chunks never split an element.
+    void upload(
+        vk::Buffer dstBuffer,
+        vk::DeviceSize elementSize,
+        uint32_t elementCount,
+        const WriteFunction &write,
+        vk::DeviceSize dstOffset = 0);
+
+    /// @brief Submits the pending copies and waits for all of them.
+    void flush();
+
+    vk::DeviceSize getSlotSize() const { return m_slotSize; }
+
+    /// Number of queue submissions since the creation.
+    uint32_t getSubmitCount() const { return m_submitCount; }
+
+private:
+    struct Slot
+    {
+        vk::CommandBuffer commandBuffer;
+        vk::Fence fence;
+        bool recording;
+        bool pending;
+    };
+
+    void beginSlot();
+    void submitSlot();
+    void recordCopy(vk::Buffer dstBuffer, vk::DeviceSize srcOffset, vk::DeviceSize dstOffset, vk::DeviceSize size);
+
+    VulkanBase &m_base;
+    vk::DeviceSize m_slotSize;
+    std::unique_ptr<Buffer> m_stagingBuffer;
+    std::vector<Slot> m_slots;
+
+    uint32_t m_slotIndex;
+    vk::DeviceSize m_slotOffset;
+    uint32_t m_submitCount;
+};
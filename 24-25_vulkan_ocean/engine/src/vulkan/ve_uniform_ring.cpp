@@ -0,0 +1,66 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#include "vulkan/ve_uniform_ring.hpp"
+#include "vulkan/ve_tools.hpp"
+
+UniformRing::UniformRing(VulkanBase &base, uint32_t frameCount, vk::DeviceSize frameCapacity)
+    : m_buffer{}
+    , m_mapped{ nullptr }
+    , m_alignment{ 1 }
+    , m_frameCapacity{ 0 }
+    , m_frameCount{ frameCount }
+    , m_frameBegin{ 0 }
+    , m_head{ 0 }
+{
+    assert(frameCount > 0 && frameCapacity > 0);
+
+    m_alignment = std::max<vk::DeviceSize>(
+        base.getProperties().limits.minUniformBufferOffsetAlignment, 16);
+    m_frameCapacity = tools::alignedVkSize(frameCapacity, m_alignment);
+
+    m_buffer = std::make_unique<Buffer>(
+        base.getDevice(),
+        base.getMemoryProperties(),
+        frameCount,
+        m_frameCapacity,
+        vk::BufferUsageFlagBits::eUniformBuffer,
+        vk::MemoryPropertyFlagBits::eHostVisible |
+        vk::MemoryPropertyFlagBits::eHostCoherent,
+        m_alignment);
+    m_buffer->map();
+    m_mapped = static_cast<uint8_t *>(m_buffer->getMappedMemory());
+}
+
+void UniformRing::beginFrame(uint32_t frameIndex)
+{
+    assert(frameIndex < m_frameCount);
+    m_frameBegin = frameIndex * m_frameCapacity;
+    m_head = m_frameBegin;
+}
+
+uint32_t UniformRing::allocate(vk::DeviceSize size, void **data)
+{
+    assert(data != nullptr);
+
+    vk::DeviceSize alignedSize = tools::alignedVkSize(size, m_alignment);
+    if (m_head + alignedSize > m_frameBegin + m_frameCapacity)
+    {
+        throw std::runtime_error("uniform ring overflow, increase the frame capacity");
+    }
+
+    vk::DeviceSize offset = m_head;
+    m_head += alignedSize;
+
+    *data = m_mapped + offset;
+    return static_cast<uint32_t>(offset);
+}
+
+vk::DescriptorBufferInfo UniformRing::getDescriptorInfo(vk::DeviceSize range) const
+{
+    assert(range <= m_frameCapacity);
+    return vk::DescriptorBufferInfo{ m_buffer->getBuffer(), 0, range };
+}
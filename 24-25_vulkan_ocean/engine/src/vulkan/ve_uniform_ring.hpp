@@ -0,0 +1,73 @@
+/*
+    Copyright (c) Arnaud BANNIER and Nicolas BODIN.
+    Licensed under the MIT License.
+    See LICENSE.md in the project root for license information.
+*/
+
+#pragma once
+
+#include "ve_settings.hpp"
+#include "vulkan/ve_base.hpp"
+#include "vulkan/ve_buffer.hpp"
+
+/// @brief Persistently mapped uniform buffer split in one region per frame
+/// in flight. Each frame, uniform data is bump allocated in the region of
+/// the frame and bound through dynamic uniform buffer descriptors, so a
+/// single descriptor set serves every frame and every allocation.
+/// The region of a frame is reused once the renderer has waited for the
+/// fence of that frame, before beginFrame() is called.
+class UniformRing
+{
+public:
+    static constexpr vk::DeviceSize DEFAULT_FRAME_CAPACITY = 64 * 1024;
+
+    UniformRing(
+        VulkanBase &base,
+        uint32_t frameCount,
+        vk::DeviceSize frameCapacity = DEFAULT_FRAME_CAPACITY);
+
+    UniformRing(const UniformRing &) = delete;
+    UniformRing &operator=(const UniformRing &) = delete;
+
+    /// @brief Starts the allocations of a frame, discards the ones made
+    /// the last time this frame index was used.
+    void beginFrame(uint32_t frameIndex);
+
+    /// @brief Allocates size bytes in the region of the current frame.
+    /// @param data receives the host pointer to the allocation.
+    /// @return the dynamic offset of the allocation.
+    uint32_t allocate(vk::DeviceSize size, void **data);
+
+    /// @brief Copies a value in the region of the current frame.
+    /// @return the dynamic offset of the copy.
+    template <class T>
+    uint32_t push(const T &value)
+    {
+        void *data = nullptr;
+        uint32_t offset = allocate(sizeof(T), &data);
+        memcpy(data, &value, sizeof(T));
+        return offset;
+    }
+
+    vk::Buffer getBuffer() const { return m_buffer->getBuffer(); }
+
+    /// @brief Descriptor of a dynamic uniform buffer binding reading range
+    /// bytes at the dynamic offset.
+    vk::DescriptorBufferInfo getDescriptorInfo(vk::DeviceSize range) const;
+
+    uint32_t getFrameCount() const { return m_frameCount; }
+    vk::DeviceSize getFrameCapacity() const { return m_frameCapacity; }
+    /// @brief Bytes allocated by the current frame.
+    vk::DeviceSize getFrameSize() const { return m_head - m_frameBegin; }
+
+private:
+    std::unique_ptr<Buffer> m_buffer;
+    uint8_t *m_mapped;
+
+    vk::DeviceSize m_alignment;
+    vk::DeviceSize m_frameCapacity;
+    uint32_t m_frameCount;
+
+    vk::DeviceSize m_frameBegin;
+    vk::DeviceSize m_head;
+};
@@ -1,4 +1,5 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
 
 layout(set = 0, binding = 0) uniform UniformBufferObject {
     mat4 view;
@@ -10,8 +11,16 @@ layout(set = 0, binding = 1) uniform ParamUniform
 {
     float time;
     float exposure;
+    float patchSize;
+    // 0 = FFT displacement, else number of Gerstner waves
+    uint waveCount;
 } param;
 
+#include "ocean_waves.glsl"
+
+// Specialized by the application, each count is a pipeline variant
+layout(constant_id = 0) const int LIGHT_COUNT = 3;
+
 struct Light
 {
     vec4 dirOrPos;
@@ -20,10 +29,14 @@ struct Light
 
 layout(set = 0, binding = 2) uniform LightsUniform
 {
+    // MAX_LIGHT_COUNT in the application
     Light lights[3];
     vec4 ambiantColor;
 } lightsUniform;
 
+// xyz = normal, computed by the ocean FFT passes
+layout(set = 0, binding = 4) uniform sampler2D normalMap;
+
 layout(push_constant) uniform constants
 {
 	mat4 model;
@@ -31,7 +44,7 @@ layout(push_constant) uniform constants
 
 // In
 layout(location = 0) in vec3 inWorldPos;
-layout(location = 1) in vec3 inNormal;
+layout(location = 1) in vec2 inOceanUV;
 
 // Out
 layout(location = 0) out vec4 outColor;
@@ -64,11 +77,15 @@ void main()
 {
     vec3 ambiant = lightsUniform.ambiantColor.rgb
         * lightsUniform.ambiantColor.a;
-    vec3 vecN = normalize(inNormal);
+    // The Gerstner normal is a function of the undisplaced grid position,
+    // given by the ocean UV, not of the displaced world position
+    vec3 vecN = (param.waveCount > 0)
+        ? gerstnerNormal(inOceanUV * param.patchSize, param.time, param.waveCount)
+        : normalize(texture(normalMap, inOceanUV).xyz);
     vec3 vecV = normalize(ubo.camPos - inWorldPos);
     
     vec3 color = vec3(0.0001,0.0001,0.1);
-    for (int i = 0; i < 3; i++)
+    for (int i = 0; i < LIGHT_COUNT; i++)
     {
         float lightIntensity = lightsUniform.lights[i].color.a;
         vec3 lightColor = lightsUniform.lights[i].color.rgb;
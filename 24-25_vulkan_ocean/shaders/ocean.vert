@@ -1,4 +1,5 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
 
 layout(set = 0, binding = 0) uniform UniformBufferObject
 {
@@ -11,79 +12,69 @@ layout(set = 0, binding = 1) uniform ParamUniform
 {
     float time;
     float exposure;
+    float patchSize;
+    // 0 = FFT displacement, else number of Gerstner waves
+    uint waveCount;
 } param;
 
+#include "ocean_waves.glsl"
+
+// xyz = displacement, computed by the ocean FFT passes
+layout(set = 0, binding = 3) uniform sampler2D displacementMap;
+
 // In
 layout(location = 0) in vec3 inPos;
 layout(location = 1) in vec2 inUV0;
 
 // Out
 layout(location = 0) out vec3 outWorldPos;
-layout(location = 1) out vec3 outNormal;
+layout(location = 1) out vec2 outOceanUV;
 
 layout(push_constant) uniform constants
 {
 	mat4 model;
+	// x = cells per side (0 = no morphing), y = morph start, z = morph end
+	vec4 grid;
 } pushConstants;
 
-// Fonction pour une vague de Gerstner
-vec3 gerstnerWave(vec2 position, vec2 direction, float steepness, float wavelength, float time, inout vec3 tangent, inout vec3 binormal) 
+// Moves the odd vertices of the clipmap levels onto the coarser grid near
+// the outer edge, so that neighbouring levels share the same vertices.
+vec3 morphVertex(vec3 gridPos)
 {
-    float k = 2.0 * 3.14159265359 / wavelength; // Nombre d'onde (frquence)
-    float c = sqrt(9.8 / k) * 0.5; // Vitesse rduite pour un mouvement naturel
-    vec2 d = normalize(direction); // Direction normalise
-    float f = k * (dot(d, position) - c * time); // Phase
-
-    float a = steepness / k; // Amplitude ajuste
-
-    // Dplacement du sommet
-    vec3 displacement = vec3(
-        d.x * (a * cos(f)), 
-        a * sin(f),
-        d.y * (a * cos(f))
-    );
-
-    // Mise  jour des tangentes pour la normale
-    tangent += vec3(
-        -d.x * d.x * (steepness * sin(f)),
-        d.x * (steepness * cos(f)),
-        -d.x * d.y * (steepness * sin(f))
-    );
-
-    binormal += vec3(
-        -d.x * d.y * (steepness * sin(f)),
-        d.y * (steepness * cos(f)),
-        -d.y * d.y * (steepness * sin(f))
-    );
-
-    return displacement;
+    float halfCount = 0.5 * pushConstants.grid.x;
+    vec2 fromCenter = abs(gridPos.xz - halfCount) / halfCount;
+    float dist = max(fromCenter.x, fromCenter.y);
+    float morph = clamp(
+        (dist - pushConstants.grid.y) / (pushConstants.grid.z - pushConstants.grid.y),
+        0.0, 1.0);
+
+    gridPos.xz -= fract(gridPos.xz * 0.5) * 2.0 * morph;
+    return gridPos;
 }
 
 void main()
 {
-    vec4 locPos = pushConstants.model * vec4(inPos, 1.0);
-    outWorldPos = locPos.xyz / locPos.w;
-
-    float time = param.time;
+    vec3 pos = inPos;
+    if (pushConstants.grid.x > 0.0)
+    {
+        pos = morphVertex(pos);
+    }
 
-    // Initialisation des tangentes pour la normale
-    vec3 tangent = vec3(1.0, 0.0, 0.0);
-    vec3 binormal = vec3(0.0, 0.0, 1.0);
-
-    // Initialisation du dplacement des vagues
-    vec3 waveDisplacement = vec3(0.0);
+    vec4 locPos = pushConstants.model * vec4(pos, 1.0);
+    outWorldPos = locPos.xyz / locPos.w;
 
-    // Ajout de plusieurs vagues avec vitesse ajuste
-    waveDisplacement += gerstnerWave(outWorldPos.xz, vec2(1.0, 0.5), 0.2, 2.0, time, tangent, binormal);
-    waveDisplacement += gerstnerWave(outWorldPos.xz, vec2(-0.7, 1.0), 0.15, 1.5, time, tangent, binormal);
-    waveDisplacement += gerstnerWave(outWorldPos.xz, vec2(0.3, -0.8), 0.1, 1.2, time, tangent, binormal);
-    waveDisplacement += gerstnerWave(outWorldPos.xz, vec2(-1.0, -0.2), 0.08, 1.0, time, tangent, binormal);
+    // The FFT patch is tiled over the whole surface
+    outOceanUV = outWorldPos.xz / param.patchSize;
 
     // Appliquer le dplacement
-    outWorldPos += waveDisplacement;
-
-    // Calcul de la normale finale
-    outNormal = normalize(cross(binormal, tangent));
+    if (param.waveCount > 0)
+    {
+        outWorldPos += gerstnerDisplacement(outWorldPos.xz, param.time, param.waveCount);
+    }
+    else
+    {
+        outWorldPos += textureLod(displacementMap, outOceanUV, 0.0).xyz;
+    }
 
     // Projection finale
     gl_Position = ubo.proj * ubo.view * vec4(outWorldPos, 1.0);
@@ -0,0 +1,58 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+    vec3 camPos;
+} ubo;
+
+layout(set = 0, binding = 1) uniform ParamUniform
+{
+    float time;
+    float exposure;
+    float patchSize;
+    // 0 = FFT displacement, else number of Gerstner waves
+    uint waveCount;
+} param;
+
+#include "ocean_waves.glsl"
+
+// xyz = displacement, computed by the ocean FFT passes
+layout(set = 0, binding = 3) uniform sampler2D displacementMap;
+
+// Out
+layout(location = 0) out vec3 outWorldPos;
+layout(location = 1) out vec2 outOceanUV;
+
+layout(push_constant) uniform constants
+{
+	mat4 model;
+	vec4 grid;
+} pushConstants;
+
+void main()
+{
+    // One triangle strip per row of cells, no vertex buffer:
+    // even vertices on the row j + 1, odd vertices on the row j,
+    // which keeps the winding of PlaneModel.
+    int i = gl_VertexIndex >> 1;
+    int j = gl_InstanceIndex + 1 - (gl_VertexIndex & 1);
+    vec3 pos = vec3(float(i), 0.0, float(j));
+
+    vec4 locPos = pushConstants.model * vec4(pos, 1.0);
+    outWorldPos = locPos.xyz / locPos.w;
+
+    // Same displacement as ocean.vert
+    outOceanUV = outWorldPos.xz / param.patchSize;
+    if (param.waveCount > 0)
+    {
+        outWorldPos += gerstnerDisplacement(outWorldPos.xz, param.time, param.waveCount);
+    }
+    else
+    {
+        outWorldPos += textureLod(displacementMap, outOceanUV, 0.0).xyz;
+    }
+
+    gl_Position = ubo.proj * ubo.view * vec4(outWorldPos, 1.0);
+}
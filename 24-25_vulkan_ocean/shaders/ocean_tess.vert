@@ -0,0 +1,21 @@
+#version 450
+
+// In
+layout(location = 0) in vec3 inPos;
+layout(location = 1) in vec2 inUV0;
+
+// Out
+layout(location = 0) out vec3 outWorldPos;
+
+layout(push_constant) uniform constants
+{
+	mat4 model;
+	vec4 grid;
+} pushConstants;
+
+void main()
+{
+    // The displacement is applied after the tessellation
+    vec4 locPos = pushConstants.model * vec4(inPos, 1.0);
+    outWorldPos = locPos.xyz / locPos.w;
+}
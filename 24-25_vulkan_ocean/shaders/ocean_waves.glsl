@@ -0,0 +1,54 @@
+// Sum of Gerstner waves, used instead of the FFT displacement when
+// param.waveCount is not 0. Same layout as GerstnerWave in ocean_waves.hpp.
+
+struct GerstnerWave
+{
+    vec2 direction;
+    // Wave number times amplitude
+    float steepness;
+    float wavelength;
+    float phase;
+};
+
+layout(std430, set = 0, binding = 5) readonly buffer WaveBuffer
+{
+    GerstnerWave waves[];
+} waveBuffer;
+
+const float GERSTNER_PI = 3.14159265359;
+const float GERSTNER_GRAVITY = 9.81;
+
+// Displacement of a point of the flat surface
+vec3 gerstnerDisplacement(vec2 position, float time, uint waveCount)
+{
+    vec3 displacement = vec3(0.0);
+    for (uint i = 0; i < waveCount; i++)
+    {
+        GerstnerWave wave = waveBuffer.waves[i];
+        float k = 2.0 * GERSTNER_PI / wave.wavelength;
+        float omega = sqrt(GERSTNER_GRAVITY * k);
+        float theta = k * dot(wave.direction, position) - omega * time + wave.phase;
+        float amplitude = wave.steepness / k;
+
+        displacement.xz += wave.direction * (amplitude * cos(theta));
+        displacement.y += amplitude * sin(theta);
+    }
+    return displacement;
+}
+
+// Normal of the displaced surface above a point of the flat surface
+vec3 gerstnerNormal(vec2 position, float time, uint waveCount)
+{
+    vec3 normal = vec3(0.0, 1.0, 0.0);
+    for (uint i = 0; i < waveCount; i++)
+    {
+        GerstnerWave wave = waveBuffer.waves[i];
+        float k = 2.0 * GERSTNER_PI / wave.wavelength;
+        float omega = sqrt(GERSTNER_GRAVITY * k);
+        float theta = k * dot(wave.direction, position) - omega * time + wave.phase;
+
+        normal.xz -= wave.direction * (wave.steepness * cos(theta));
+        normal.y -= wave.steepness * sin(theta);
+    }
+    return normalize(normal);
+}
@@ -0,0 +1,40 @@
+#include "test.hpp"
+
+#include <atomic>
+#include <cstdlib>
+
+namespace
+{
+    // The checks may run on the workers of a thread pool
+    std::atomic<int> g_failureCount{ 0 };
+}
+
+std::vector<test::TestCase> &test::getTestCases()
+{
+    static std::vector<TestCase> testCases;
+    return testCases;
+}
+
+void test::reportFailure(const char *file, int line, const std::string &message)
+{
+    printf("    %s(%d): check failed: %s\n", file, line, message.c_str());
+    g_failureCount++;
+}
+
+int main()
+{
+    int failedCount = 0;
+    for (const test::TestCase &testCase : test::getTestCases())
+    {
+        int failureCount = g_failureCount;
+        printf("[ RUN  ] %s\n", testCase.name);
+        testCase.function();
+
+        bool passed = g_failureCount == failureCount;
+        printf("[ %s ] %s\n", passed ? " OK " : "FAIL", testCase.name);
+        if (passed == false) failedCount++;
+    }
+
+    printf("%d of %zu tests failed\n", failedCount, test::getTestCases().size());
+    return failedCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+/// @brief Minimal test registry, the tests run on the CPU only.
+namespace test
+{
+    struct TestCase
+    {
+        const char *name;
+        std::function<void()> function;
+    };
+
+    std::vector<TestCase> &getTestCases();
+    void reportFailure(const char *file, int line, const std::string &message);
+
+    struct Registrar
+    {
+        Registrar(const char *name, std::function<void()> function)
+        {
+            getTestCases().push_back({ name, std::move(function) });
+        }
+    };
+}
+
+#define VE_TEST_CONCAT_IMPL(a, b) a##b
+#define VE_TEST_CONCAT(a, b) VE_TEST_CONCAT_IMPL(a, b)
+
+#define TEST_CASE(NAME)                                                       \
+    static void VE_TEST_CONCAT(testFunction_, __LINE__)();                    \
+    static test::Registrar VE_TEST_CONCAT(testRegistrar_, __LINE__)(          \
+        NAME, VE_TEST_CONCAT(testFunction_, __LINE__));                       \
+    static void VE_TEST_CONCAT(testFunction_, __LINE__)()
+
+#define CHECK(CONDITION)                                                      \
+    do {                                                                      \
+        if (!(CONDITION))                                                     \
+            test::reportFailure(__FILE__, __LINE__, #CONDITION);              \
+    } while (0)
+
+#define CHECK_NEAR(A, B, TOLERANCE)                                           \
+    do {                                                                      \
+        double testA = static_cast<double>(A);                                \
+        double testB = static_cast<double>(B);                                \
+        if (!(std::abs(testA - testB) <= static_cast<double>(TOLERANCE)))     \
+            test::reportFailure(__FILE__, __LINE__,                           \
+                std::string(#A " == " #B ", got ")                            \
+                + std::to_string(testA) + " and " + std::to_string(testB));   \
+    } while (0)
@@ -0,0 +1,123 @@
+#include "test.hpp"
+
+#include "core/ve_fft.hpp"
+
+#include <cmath>
+#include <random>
+
+namespace
+{
+    const double PI = 3.14159265358979323846;
+
+    std::vector<std::complex<float>> makeSequence(size_t count, uint32_t seed)
+    {
+        std::mt19937 generator(seed);
+        std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+
+        std::vector<std::complex<float>> data(count);
+        for (std::complex<float> &value : data)
+        {
+            value = { distribution(generator), distribution(generator) };
+        }
+        return data;
+    }
+
+    /// Naive O(n^2) DFT, same sign convention as fft::transform.
+    std::vector<std::complex<double>> naiveDFT(
+        const std::vector<std::complex<float>> &data, bool inverse)
+    {
+        const size_t n = data.size();
+        const double sign = inverse ? 1.0 : -1.0;
+
+        std::vector<std::complex<double>> result(n);
+        for (size_t k = 0; k < n; k++)
+        {
+            std::complex<double> sum = 0.0;
+            for (size_t j = 0; j < n; j++)
+            {
+                double angle = sign * 2.0 * PI * static_cast<double>((j * k) % n) / static_cast<double>(n);
+                sum += std::complex<double>(data[j]) * std::polar(1.0, angle);
+            }
+            result[k] = sum;
+        }
+        return result;
+    }
+
+    void checkAgainstDFT(uint32_t n, bool inverse)
+    {
+        std::vector<std::complex<float>> data = makeSequence(n, n);
+        std::vector<std::complex<double>> expected = naiveDFT(data, inverse);
+
+        fft::transform(data, inverse);
+
+        const double tolerance = 1e-5 * n;
+        for (uint32_t k = 0; k < n; k++)
+        {
+            CHECK_NEAR(data[k].real(), expected[k].real(), tolerance);
+            CHECK_NEAR(data[k].imag(), expected[k].imag(), tolerance);
+        }
+    }
+}
+
+TEST_CASE("fft::isPowerOfTwo")
+{
+    CHECK(fft::isPowerOfTwo(1));
+    CHECK(fft::isPowerOfTwo(2));
+    CHECK(fft::isPowerOfTwo(256));
+    CHECK(fft::isPowerOfTwo(0) == false);
+    CHECK(fft::isPowerOfTwo(3) == false);
+    CHECK(fft::isPowerOfTwo(384) == false);
+}
+
+TEST_CASE("fft::transform matches a naive DFT")
+{
+    for (uint32_t n : { 1u, 2u, 4u, 8u, 64u, 256u })
+    {
+        checkAgainstDFT(n, false);
+        checkAgainstDFT(n, true);
+    }
+}
+
+TEST_CASE("fft::transform inverse of forward scales by n")
+{
+    const uint32_t n = 128;
+    const std::vector<std::complex<float>> original = makeSequence(n, 7);
+
+    std::vector<std::complex<float>> data = original;
+    fft::transform(data, false);
+    fft::transform(data, true);
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        CHECK_NEAR(data[i].real() / n, original[i].real(), 1e-5);
+        CHECK_NEAR(data[i].imag() / n, original[i].imag(), 1e-5);
+    }
+}
+
+TEST_CASE("fft::transform2D matches a naive 2D DFT")
+{
+    const uint32_t n = 16;
+    const std::vector<std::complex<float>> original = makeSequence(n * n, 3);
+
+    std::vector<std::complex<float>> data = original;
+    fft::transform2D(data, n, true);
+
+    const double tolerance = 1e-5 * n * n;
+    for (uint32_t v = 0; v < n; v++)
+    {
+        for (uint32_t u = 0; u < n; u++)
+        {
+            std::complex<double> sum = 0.0;
+            for (uint32_t y = 0; y < n; y++)
+            {
+                for (uint32_t x = 0; x < n; x++)
+                {
+                    double angle = 2.0 * PI * static_cast<double>((u * x + v * y) % n) / n;
+                    sum += std::complex<double>(original[y * n + x]) * std::polar(1.0, angle);
+                }
+            }
+            CHECK_NEAR(data[v * n + u].real(), sum.real(), tolerance);
+            CHECK_NEAR(data[v * n + u].imag(), sum.imag(), tolerance);
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#include "test.hpp"
+
+#include "core/ve_file_io.hpp"
+
+#include <filesystem>
+#include <iterator>
+
+namespace
+{
+    std::string readFile(const std::string &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+}
+
+TEST_CASE("writeFileAtomic writes the chunks in order and replaces the file")
+{
+    const std::string path = "test_file_io.bin";
+    writeFileAtomic(path, "old contents", 12);
+    CHECK(readFile(path) == "old contents");
+
+    const uint32_t value = 0x64636261;
+    writeFileAtomic(path, { { "head", 4 }, { nullptr, 0 }, { &value, sizeof(value) } });
+    CHECK(readFile(path) == "headabcd");
+
+    std::error_code error;
+    CHECK(std::filesystem::exists(path + ".tmp", error) == false);
+    std::filesystem::remove(path, error);
+}
+
+TEST_CASE("writeFileAtomic throws and leaves no file on failure")
+{
+    const std::string path = "missing_directory/test_file_io.bin";
+
+    bool thrown = false;
+    try
+    {
+        writeFileAtomic(path, "data", 4);
+    }
+    catch (const std::runtime_error &)
+    {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    std::error_code error;
+    CHECK(std::filesystem::exists(path, error) == false);
+    CHECK(std::filesystem::exists(path + ".tmp", error) == false);
+}
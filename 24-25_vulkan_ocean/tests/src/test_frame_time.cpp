@@ -0,0 +1,214 @@
+#include "test.hpp"
+
+#include "core/ve_frame_pacer.hpp"
+#include "core/ve_frame_time_histogram.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+namespace
+{
+    uint64_t toNanoseconds(float milliseconds)
+    {
+        return static_cast<uint64_t>(static_cast<double>(milliseconds) * 1e6);
+    }
+
+    /// Hitch column of a CSV written by FrameTimeHistogram::writeCSV().
+    std::vector<int> readHitchColumn(const std::string &path)
+    {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+
+        std::vector<int> hitches;
+        while (std::getline(file, line))
+        {
+            hitches.push_back(line.back() - '0');
+        }
+        return hitches;
+    }
+}
+
+TEST_CASE("FrameTimeHistogram percentiles use the nearest rank")
+{
+    FrameTimeHistogram histogram(128);
+    for (int i = 100; i >= 1; i--)
+    {
+        histogram.addSample(toNanoseconds(static_cast<float>(i)));
+    }
+
+    const FrameTimePercentiles &percentiles = histogram.getPercentiles();
+    CHECK_NEAR(percentiles.p50, 50.f, 1e-4f);
+    CHECK_NEAR(percentiles.p95, 95.f, 1e-4f);
+    CHECK_NEAR(percentiles.p99, 99.f, 1e-4f);
+    CHECK_NEAR(percentiles.max, 100.f, 1e-4f);
+    CHECK_NEAR(histogram.getLastSample(), 1.f, 1e-4f);
+}
+
+TEST_CASE("FrameTimeHistogram percentiles only cover the window")
+{
+    FrameTimeHistogram histogram(4);
+    for (float frameTime : { 100.f, 100.f, 1.f, 2.f, 3.f, 4.f })
+    {
+        histogram.addSample(toNanoseconds(frameTime));
+    }
+
+    CHECK(histogram.getSampleCount() == 4);
+    CHECK(histogram.getFrameCount() == 6);
+    CHECK_NEAR(histogram.getPercentiles().p50, 2.f, 1e-4f);
+    CHECK_NEAR(histogram.getPercentiles().max, 4.f, 1e-4f);
+
+    // Refreshed by the next sample
+    histogram.addSample(toNanoseconds(10.f));
+    CHECK_NEAR(histogram.getPercentiles().max, 10.f, 1e-4f);
+}
+
+TEST_CASE("FrameTimeHistogram detects the hitches against the running median")
+{
+    FrameTimeHistogram histogram(64);
+    for (int i = 0; i < 20; i++)
+    {
+        histogram.addSample(toNanoseconds(10.f));
+    }
+    CHECK(histogram.getHitchCount() == 0);
+
+    // Slower, but less than twice the median
+    histogram.addSample(toNanoseconds(19.f));
+    CHECK(histogram.getHitchCount() == 0);
+
+    histogram.addSample(toNanoseconds(30.f));
+    CHECK(histogram.getHitchCount() == 1);
+    CHECK(histogram.getLastHitchFrame() == 21);
+    CHECK_NEAR(histogram.getLastHitchTime(), 30.f, 1e-4f);
+
+    histogram.clear();
+    CHECK(histogram.getHitchCount() == 0);
+    CHECK(histogram.getSampleCount() == 0);
+}
+
+TEST_CASE("FrameTimeHistogram ignores the jitter of short frames")
+{
+    FrameTimeHistogram histogram(64);
+    for (int i = 0; i < 20; i++)
+    {
+        histogram.addSample(toNanoseconds(0.2f));
+    }
+
+    // More than twice the median, but less than MIN_HITCH_TIME slower
+    histogram.addSample(toNanoseconds(0.9f));
+    CHECK(histogram.getHitchCount() == 0);
+
+    histogram.addSample(toNanoseconds(2.f));
+    CHECK(histogram.getHitchCount() == 1);
+}
+
+TEST_CASE("FrameTimeHistogram exports the hitches counted live")
+{
+    // The final median is high, the early hitch must still be exported
+    FrameTimeHistogram histogram(64);
+    std::vector<float> frameTimes(8, 5.f);
+    frameTimes.push_back(20.f);
+    frameTimes.insert(frameTimes.end(), 16, 40.f);
+    for (float frameTime : frameTimes)
+    {
+        histogram.addSample(toNanoseconds(frameTime));
+    }
+
+    const std::string path = "test_frame_times.csv";
+    histogram.writeCSV(path);
+    std::vector<int> hitches = readHitchColumn(path);
+    std::remove(path.c_str());
+
+    CHECK(hitches.size() == frameTimes.size());
+    int exportedCount = 0;
+    for (int hitch : hitches) exportedCount += hitch;
+    CHECK(exportedCount == static_cast<int>(histogram.getHitchCount()));
+    CHECK(hitches.size() > 8 && hitches[8] == 1);
+}
+
+TEST_CASE("FrameTimeHistogram writeCSV throws on an invalid path")
+{
+    FrameTimeHistogram histogram(4);
+    histogram.addSample(toNanoseconds(1.f));
+
+    bool thrown = false;
+    try
+    {
+        histogram.writeCSV("missing_directory/frame_times.csv");
+    }
+    catch (const std::runtime_error &)
+    {
+        thrown = true;
+    }
+    CHECK(thrown);
+}
+
+TEST_CASE("FramePacer spaces the frames to the target rate")
+{
+    // Loose bounds, the test must not depend on the load of the machine
+    const float frameRate = 200.f;
+    const int frameCount = 40;
+
+    FramePacer pacer(2);
+    pacer.setTargetFrameRate(frameRate);
+    CHECK_NEAR(pacer.getTargetFrameRate(), frameRate, 1e-4f);
+
+    FramePacer::Clock::time_point start = FramePacer::Clock::now();
+    for (int i = 0; i < frameCount; i++)
+    {
+        pacer.beginFrame(i % 2);
+        pacer.endFrame();
+    }
+    float seconds = std::chrono::duration<float>(FramePacer::Clock::now() - start).count();
+
+    // The first frame sets the deadline of the second one
+    float expected = (frameCount - 1) / frameRate;
+    CHECK(seconds > 0.9f * expected);
+    CHECK(seconds < 3.f * expected);
+    CHECK_NEAR(pacer.getStats().frameTime, 1.f / frameRate, 0.5f / frameRate);
+    CHECK(pacer.getStats().sleepTime > 0.f);
+}
+
+TEST_CASE("FramePacer does not sleep without a target rate")
+{
+    FramePacer pacer(2);
+    pacer.setTargetFrameRate(-10.f);
+    CHECK(pacer.getTargetFrameRate() == 0.f);
+
+    FramePacer::Clock::time_point start = FramePacer::Clock::now();
+    for (int i = 0; i < 100; i++)
+    {
+        pacer.beginFrame(i % 2);
+        pacer.endFrame();
+    }
+    float seconds = std::chrono::duration<float>(FramePacer::Clock::now() - start).count();
+    CHECK(seconds < 0.1f);
+    CHECK(pacer.getStats().missedCount == 0);
+}
+
+TEST_CASE("FramePacer counts the late frames and measures the latency")
+{
+    FramePacer pacer(1);
+    pacer.setTargetFrameRate(500.f);
+
+    pacer.beginFrame(0);
+    pacer.endFrame();
+    // 10 ms of work for a 2 ms period
+    pacer.beginFrame(0);
+    float latency = pacer.getStats().latency;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    pacer.endFrame();
+    CHECK(pacer.getStats().missedCount == 1);
+
+    // The slot was recorded 10 ms ago, its next use adds a smoothed sample
+    pacer.beginFrame(0);
+    CHECK(pacer.getStats().latency > latency + 0.1f * 0.009f);
+
+    // An aborted frame gives no latency sample
+    pacer.abortFrame();
+    latency = pacer.getStats().latency;
+    pacer.beginFrame(0);
+    CHECK(pacer.getStats().latency == latency);
+    pacer.endFrame();
+}
@@ -0,0 +1,133 @@
+#include "test.hpp"
+
+#include "core/ve_mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <random>
+
+namespace
+{
+    struct GridMesh
+    {
+        std::vector<float> positions;
+        std::vector<uint32_t> indices;
+        uint32_t vertexCount = 0;
+    };
+
+    /// Grid of quads with its triangles in a random order.
+    GridMesh makeShuffledGrid(uint32_t quadCount)
+    {
+        GridMesh mesh{};
+        const uint32_t side = quadCount + 1;
+        mesh.vertexCount = side * side;
+        for (uint32_t z = 0; z < side; z++)
+        {
+            for (uint32_t x = 0; x < side; x++)
+            {
+                mesh.positions.insert(mesh.positions.end(), {
+                    static_cast<float>(x), 0.f, static_cast<float>(z) });
+            }
+        }
+
+        std::vector<std::array<uint32_t, 3>> triangles;
+        for (uint32_t z = 0; z < quadCount; z++)
+        {
+            for (uint32_t x = 0; x < quadCount; x++)
+            {
+                uint32_t v = z * side + x;
+                triangles.push_back({ v, v + side, v + 1 });
+                triangles.push_back({ v + 1, v + side, v + side + 1 });
+            }
+        }
+        std::shuffle(triangles.begin(), triangles.end(), std::mt19937(42));
+
+        for (const std::array<uint32_t, 3> &triangle : triangles)
+        {
+            mesh.indices.insert(mesh.indices.end(), triangle.begin(), triangle.end());
+        }
+        return mesh;
+    }
+
+    /// Triangles as sorted vertex triples, sorted, to compare two index lists.
+    std::vector<std::array<uint32_t, 3>> getTriangleSet(const std::vector<uint32_t> &indices)
+    {
+        std::vector<std::array<uint32_t, 3>> triangles;
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            std::array<uint32_t, 3> triangle{ indices[i], indices[i + 1], indices[i + 2] };
+            std::sort(triangle.begin(), triangle.end());
+            triangles.push_back(triangle);
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+}
+
+TEST_CASE("meshopt::analyzeVertexCache counts the cache misses")
+{
+    // Two triangles sharing an edge: 4 transformed vertices
+    std::vector<uint32_t> indices = { 0, 1, 2, 2, 1, 3 };
+    meshopt::VertexCacheStats stats = meshopt::analyzeVertexCache(indices, 4);
+    CHECK(stats.transformedCount == 4);
+    CHECK_NEAR(stats.acmr, 2.f, 1e-6f);
+    CHECK_NEAR(stats.atvr, 1.f, 1e-6f);
+
+    // With a cache of 3 entries, vertex 0 is evicted before it comes back
+    indices = { 0, 1, 2, 3, 4, 5, 0, 4, 5 };
+    CHECK(meshopt::analyzeVertexCache(indices, 6, 3).transformedCount == 7);
+    CHECK(meshopt::analyzeVertexCache(indices, 6).transformedCount == 6);
+}
+
+TEST_CASE("meshopt::optimizeVertexCache lowers the ACMR of a grid")
+{
+    GridMesh mesh = makeShuffledGrid(64);
+    const std::vector<uint32_t> original = mesh.indices;
+
+    float acmrBefore = meshopt::analyzeVertexCache(mesh.indices, mesh.vertexCount).acmr;
+    meshopt::optimizeVertexCache(mesh.indices, mesh.vertexCount);
+    float acmrAfter = meshopt::analyzeVertexCache(mesh.indices, mesh.vertexCount).acmr;
+
+    CHECK(acmrBefore > 2.f);
+    CHECK(acmrAfter < 0.8f);
+    CHECK(mesh.indices.size() == original.size());
+    CHECK(getTriangleSet(mesh.indices) == getTriangleSet(original));
+}
+
+TEST_CASE("meshopt::optimizeOverdraw keeps the triangles and the cache efficiency")
+{
+    GridMesh mesh = makeShuffledGrid(32);
+    meshopt::optimizeVertexCache(mesh.indices, mesh.vertexCount);
+    const std::vector<uint32_t> optimized = mesh.indices;
+    float acmrBefore = meshopt::analyzeVertexCache(mesh.indices, mesh.vertexCount).acmr;
+
+    const float threshold = 1.05f;
+    meshopt::optimizeOverdraw(
+        mesh.indices, mesh.positions.data(), 3 * sizeof(float), mesh.vertexCount, threshold);
+    float acmrAfter = meshopt::analyzeVertexCache(mesh.indices, mesh.vertexCount).acmr;
+
+    CHECK(acmrAfter <= threshold * acmrBefore + 1e-6f);
+    CHECK(getTriangleSet(mesh.indices) == getTriangleSet(optimized));
+}
+
+TEST_CASE("meshopt::optimizeVertexFetch numbers the vertices in order of first use")
+{
+    GridMesh mesh = makeShuffledGrid(16);
+    meshopt::optimizeVertexCache(mesh.indices, mesh.vertexCount);
+
+    // Each vertex stores its original index
+    std::vector<uint32_t> vertices(mesh.vertexCount);
+    for (uint32_t i = 0; i < mesh.vertexCount; i++) vertices[i] = i;
+    std::vector<uint32_t> indices = mesh.indices;
+
+    meshopt::optimizeVertexFetch(vertices, indices);
+
+    uint32_t nextVertex = 0;
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        CHECK(vertices[indices[i]] == mesh.indices[i]);
+        CHECK(indices[i] <= nextVertex);
+        if (indices[i] == nextVertex) nextVertex++;
+    }
+    CHECK(nextVertex == mesh.vertexCount);
+}
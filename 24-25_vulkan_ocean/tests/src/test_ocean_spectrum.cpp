@@ -0,0 +1,177 @@
+#include "test.hpp"
+
+#include "ocean_spectrum.hpp"
+
+namespace
+{
+    OceanSpectrumParams getTestParams()
+    {
+        OceanSpectrumParams params{};
+        params.size = 64;
+        params.windSpeed = 10.f;
+        return params;
+    }
+
+    /// h(k, t) = h0(k) e^(i w t) + conj(h0(-k)) e^(-i w t), as in evaluate().
+    std::vector<std::complex<float>> getHeightSpectrum(const OceanSpectrum &spectrum, float time)
+    {
+        const uint32_t n = spectrum.getParams().size;
+        const std::vector<glm::vec4> &h0 = spectrum.getInitialSpectrum();
+
+        std::vector<std::complex<float>> h(n * n);
+        for (uint32_t m = 0; m < n; m++)
+        {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                const glm::vec4 &texel = h0[m * n + i];
+                float omega = sqrtf(9.81f * glm::length(spectrum.getWaveVector(i, m)));
+                std::complex<float> e = std::polar(1.f, omega * time);
+                h[m * n + i] =
+                    std::complex<float>(texel.x, texel.y) * e +
+                    std::complex<float>(texel.z, texel.w) * std::conj(e);
+            }
+        }
+        return h;
+    }
+}
+
+TEST_CASE("OceanSpectrum initial spectrum pairs k with -k")
+{
+    OceanSpectrum spectrum(getTestParams());
+    const uint32_t n = spectrum.getParams().size;
+    const std::vector<glm::vec4> &h0 = spectrum.getInitialSpectrum();
+
+    CHECK(h0.size() == n * n);
+    for (uint32_t m = 0; m < n; m++)
+    {
+        for (uint32_t i = 0; i < n; i++)
+        {
+            // zw = conj(h0(-k)), with -k stored at (N - n, N - m)
+            const glm::vec4 &texel = h0[m * n + i];
+            const glm::vec4 &opposite = h0[((n - m) % n) * n + (n - i) % n];
+            CHECK(texel.z == opposite.x);
+            CHECK(texel.w == -opposite.y);
+        }
+    }
+}
+
+TEST_CASE("OceanSpectrum height spectrum is Hermitian")
+{
+    OceanSpectrum spectrum(getTestParams());
+    const uint32_t n = spectrum.getParams().size;
+    const float time = 2.5f;
+
+    std::vector<std::complex<float>> h = getHeightSpectrum(spectrum, time);
+    float maxValue = 0.f;
+    for (uint32_t m = 0; m < n; m++)
+    {
+        for (uint32_t i = 0; i < n; i++)
+        {
+            std::complex<float> hk = h[m * n + i];
+            std::complex<float> hMinusK = h[((n - m) % n) * n + (n - i) % n];
+            CHECK_NEAR(hk.real(), hMinusK.real(), 1e-6f * std::abs(hk) + 1e-12f);
+            CHECK_NEAR(hk.imag(), -hMinusK.imag(), 1e-6f * std::abs(hk) + 1e-12f);
+            maxValue = std::max(maxValue, std::abs(hk));
+        }
+    }
+    CHECK(maxValue > 0.f);
+
+    // The height field is then real
+    fft::transform2D(h, n, true);
+    float maxReal = 0.f;
+    float maxImag = 0.f;
+    for (const std::complex<float> &value : h)
+    {
+        maxReal = std::max(maxReal, std::abs(value.real()));
+        maxImag = std::max(maxImag, std::abs(value.imag()));
+    }
+    CHECK(maxReal > 0.f);
+    CHECK(maxImag <= 1e-4f * maxReal);
+}
+
+TEST_CASE("OceanSpectrum evaluate is deterministic")
+{
+    OceanSpectrum spectrumA(getTestParams());
+    OceanSpectrum spectrumB(getTestParams());
+
+    std::vector<glm::vec4> displacementsA, normalsA;
+    std::vector<glm::vec4> displacementsB, normalsB;
+    std::vector<glm::vec4> displacementsC, normalsC;
+    spectrumA.evaluate(1.25f, displacementsA, normalsA);
+    spectrumA.evaluate(1.25f, displacementsB, normalsB);
+    spectrumB.evaluate(1.25f, displacementsC, normalsC);
+
+    const uint32_t n = spectrumA.getParams().size;
+    CHECK(displacementsA.size() == n * n);
+    CHECK(normalsA.size() == n * n);
+    CHECK(displacementsA == displacementsB);
+    CHECK(normalsA == normalsB);
+    CHECK(displacementsA == displacementsC);
+    CHECK(normalsA == normalsC);
+}
+
+TEST_CASE("OceanSpectrum evaluate gives a displaced surface")
+{
+    OceanSpectrum spectrum(getTestParams());
+
+    std::vector<glm::vec4> displacements, normals;
+    spectrum.evaluate(0.f, displacements, normals);
+
+    float maxHeight = 0.f;
+    for (size_t i = 0; i < displacements.size(); i++)
+    {
+        maxHeight = std::max(maxHeight, std::abs(displacements[i].y));
+        CHECK_NEAR(glm::length(glm::vec3(normals[i])), 1.f, 1e-4f);
+        CHECK(normals[i].y > 0.f);
+    }
+    CHECK(maxHeight > 0.f);
+
+    glm::vec2 bound = spectrum.estimateMaxDisplacement();
+    CHECK(bound.y >= maxHeight);
+}
+
+TEST_CASE("OceanSpectrum single wave matches the Gerstner displacement")
+{
+    OceanSpectrumParams params{};
+    params.size = 16;
+    params.patchSize = 16.f;
+    OceanSpectrum spectrum(params);
+
+    // One wave of amplitude A along +x, two periods over the patch:
+    // h(k) = A/2 and h(-k) = conj(h(k)) give a height of A cos(k.x + w t)
+    const uint32_t n = params.size;
+    const uint32_t waveN = n / 2 + 2;
+    const uint32_t waveM = n / 2;
+    const float amplitude = 0.5f;
+    std::vector<glm::vec4> h0(n * n, glm::vec4(0.f));
+    h0[waveM * n + waveN] = { 0.5f * amplitude, 0.f, 0.f, 0.f };
+    h0[((n - waveM) % n) * n + (n - waveN) % n] = { 0.f, 0.f, 0.5f * amplitude, 0.f };
+    spectrum.setInitialSpectrum(h0);
+
+    const glm::vec2 k = spectrum.getWaveVector(waveN, waveM);
+    const float omega = sqrtf(9.81f * glm::length(k));
+    const float choppiness = 1.5f;
+
+    for (float time : { 0.f, 0.7f, 3.1f })
+    {
+        std::vector<glm::vec4> displacements, normals;
+        spectrum.evaluate(time, displacements, normals, choppiness);
+
+        for (uint32_t m = 0; m < n; m++)
+        {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                // Gerstner: x = x0 - choppiness A k/|k| sin(theta), y = A cos(theta),
+                // the horizontal displacement moves the points towards the crests
+                glm::vec2 position = params.patchSize / n * glm::vec2(
+                    static_cast<float>(i), static_cast<float>(m));
+                float theta = glm::dot(k, position) + omega * time;
+
+                const glm::vec4 &d = displacements[m * n + i];
+                CHECK_NEAR(d.y, amplitude * cosf(theta), 1e-5f);
+                CHECK_NEAR(d.x, -choppiness * amplitude * sinf(theta), 1e-5f);
+                CHECK_NEAR(d.z, 0.f, 1e-5f);
+            }
+        }
+    }
+}
@@ -0,0 +1,158 @@
+#include "test.hpp"
+
+#include "core/ve_range_allocator.hpp"
+
+TEST_CASE("BuddyAllocator splits the block down to the requested order")
+{
+    BuddyAllocator allocator(4096);
+    CHECK(allocator.getSize() == 4096);
+    CHECK(allocator.getLargestFreeSize() == 4096);
+
+    uint64_t offset = 1, reservedSize = 0;
+    CHECK(allocator.allocate(256, offset, reservedSize));
+    CHECK(offset == 0);
+    CHECK(reservedSize == 256);
+
+    // 4096 = 256 (used) + 256 + 512 + 1024 + 2048 (free halves)
+    CHECK(allocator.getLargestFreeSize() == 2048);
+
+    // The free halves are used from the lowest offset, without new splits
+    CHECK(allocator.allocate(256, offset, reservedSize));
+    CHECK(offset == 256);
+    CHECK(allocator.allocate(512, offset, reservedSize));
+    CHECK(offset == 512);
+    CHECK(allocator.allocate(1024, offset, reservedSize));
+    CHECK(offset == 1024);
+    CHECK(allocator.allocate(2048, offset, reservedSize));
+    CHECK(offset == 2048);
+    CHECK(allocator.getLargestFreeSize() == 0);
+}
+
+TEST_CASE("BuddyAllocator merges the buddies after a free")
+{
+    BuddyAllocator allocator(4096);
+
+    uint64_t offsets[16]{};
+    uint64_t reservedSize = 0;
+    for (uint64_t &offset : offsets)
+    {
+        CHECK(allocator.allocate(256, offset, reservedSize));
+    }
+    CHECK(allocator.getLargestFreeSize() == 0);
+
+    // Every other node free, no buddies to merge
+    for (int i = 0; i < 16; i += 2)
+    {
+        allocator.free(offsets[i], 256);
+    }
+    CHECK(allocator.getLargestFreeSize() == 256);
+
+    uint64_t offset = 0;
+    CHECK(allocator.allocate(512, offset, reservedSize) == false);
+
+    // Each free merges with the free buddy, then up the tree
+    allocator.free(offsets[1], 256);
+    CHECK(allocator.getLargestFreeSize() == 512);
+    allocator.free(offsets[3], 256);
+    CHECK(allocator.getLargestFreeSize() == 1024);
+
+    for (int i = 5; i < 16; i += 2)
+    {
+        allocator.free(offsets[i], 256);
+    }
+    CHECK(allocator.getLargestFreeSize() == 4096);
+
+    CHECK(allocator.allocate(4096, offset, reservedSize));
+    CHECK(offset == 0);
+}
+
+TEST_CASE("BuddyAllocator rounds the sizes up to aligned powers of two")
+{
+    BuddyAllocator allocator(1 << 16);
+    uint64_t offset = 0, reservedSize = 0;
+
+    CHECK(allocator.allocate(1, offset, reservedSize));
+    CHECK(reservedSize == BuddyAllocator::MIN_NODE_SIZE);
+
+    CHECK(allocator.allocate(300, offset, reservedSize));
+    CHECK(reservedSize == 512);
+    CHECK(offset % 512 == 0);
+
+    // The MemoryAllocator requests max(size, alignment)
+    CHECK(allocator.allocate(4096, offset, reservedSize));
+    CHECK(reservedSize == 4096);
+    CHECK(offset % 4096 == 0);
+
+    CHECK(allocator.allocate(4097, offset, reservedSize));
+    CHECK(reservedSize == 8192);
+    CHECK(offset % 8192 == 0);
+
+    CHECK(BuddyAllocator::getOrder(256) == 0);
+    CHECK(BuddyAllocator::getOrder(257) == 1);
+    CHECK(BuddyAllocator::getOrder(1024) == 2);
+}
+
+TEST_CASE("BuddyAllocator returns false when out of memory")
+{
+    BuddyAllocator allocator(1024);
+    uint64_t offset = 7, reservedSize = 7;
+
+    CHECK(allocator.allocate(2048, offset, reservedSize) == false);
+    CHECK(offset == 7);
+    CHECK(reservedSize == 7);
+
+    CHECK(allocator.allocate(1024, offset, reservedSize));
+    CHECK(allocator.allocate(1, offset, reservedSize) == false);
+
+    allocator.free(0, 1024);
+    CHECK(allocator.allocate(512, offset, reservedSize));
+    CHECK(allocator.allocate(512, offset, reservedSize));
+    CHECK(allocator.allocate(256, offset, reservedSize) == false);
+}
+
+TEST_CASE("LinearAllocator pads the head up to the alignment")
+{
+    LinearAllocator allocator(1024);
+    uint64_t offset = 0, reservedSize = 0;
+
+    CHECK(allocator.allocate(10, 1, offset, reservedSize));
+    CHECK(offset == 0);
+    CHECK(reservedSize == 10);
+    CHECK(allocator.getHead() == 10);
+
+    CHECK(allocator.allocate(20, 16, offset, reservedSize));
+    CHECK(offset == 16);
+    CHECK(reservedSize == 6 + 20);
+    CHECK(allocator.getHead() == 36);
+
+    // Non coherent atoms are not always powers of two
+    CHECK(allocator.allocate(5, 24, offset, reservedSize));
+    CHECK(offset == 48);
+    CHECK(reservedSize == 12 + 5);
+
+    // Already aligned, no padding
+    CHECK(allocator.allocate(11, 53, offset, reservedSize));
+    CHECK(offset == 53);
+    CHECK(reservedSize == 11);
+}
+
+TEST_CASE("LinearAllocator returns false at the end of the block")
+{
+    LinearAllocator allocator(256);
+    uint64_t offset = 0, reservedSize = 0;
+
+    CHECK(allocator.allocate(200, 1, offset, reservedSize));
+    CHECK(allocator.allocate(56, 1, offset, reservedSize));
+    CHECK(allocator.getHead() == 256);
+    CHECK(allocator.allocate(1, 1, offset, reservedSize) == false);
+
+    // The padding alone may overflow the block
+    allocator.reset();
+    CHECK(allocator.allocate(129, 1, offset, reservedSize));
+    CHECK(allocator.allocate(120, 128, offset, reservedSize) == false);
+    CHECK(allocator.getHead() == 129);
+
+    allocator.reset();
+    CHECK(allocator.allocate(256, 128, offset, reservedSize));
+    CHECK(offset == 0);
+}
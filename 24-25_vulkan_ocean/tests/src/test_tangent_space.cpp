@@ -0,0 +1,136 @@
+#include "test.hpp"
+
+#include "core/ve_tangent_space.hpp"
+
+namespace
+{
+    struct TangentVertex
+    {
+        glm::vec3 position;
+        glm::vec3 normal;
+        glm::vec2 texCoord;
+    };
+
+    /// Unit quad in the XY plane facing +Z, texture U along +X and V along +Y.
+    std::vector<TangentVertex> makeQuad(bool mirrorU)
+    {
+        std::vector<TangentVertex> vertices;
+        for (glm::vec2 corner : { glm::vec2(0.f, 0.f), glm::vec2(1.f, 0.f), glm::vec2(1.f, 1.f), glm::vec2(0.f, 1.f) })
+        {
+            TangentVertex vertex{};
+            vertex.position = glm::vec3(corner.x, corner.y, 0.f);
+            vertex.normal = glm::vec3(0.f, 0.f, 1.f);
+            vertex.texCoord = glm::vec2(mirrorU ? 1.f - corner.x : corner.x, corner.y);
+            vertices.push_back(vertex);
+        }
+        return vertices;
+    }
+
+    std::vector<glm::vec4> generate(
+        const std::vector<TangentVertex> &vertices,
+        std::vector<uint32_t> &indices,
+        std::vector<uint32_t> &splitVertices)
+    {
+        meshopt::TangentSpaceInput input{};
+        input.positions = &vertices[0].position.x;
+        input.normals = &vertices[0].normal.x;
+        input.texCoords = &vertices[0].texCoord.x;
+        input.stride = sizeof(TangentVertex);
+        input.vertexCount = static_cast<uint32_t>(vertices.size());
+        return meshopt::generateTangents(input, indices, splitVertices);
+    }
+
+    void checkTangent(const glm::vec4 &tangent, const glm::vec3 &expected, float sign)
+    {
+        CHECK_NEAR(tangent.x, expected.x, 1e-5f);
+        CHECK_NEAR(tangent.y, expected.y, 1e-5f);
+        CHECK_NEAR(tangent.z, expected.z, 1e-5f);
+        CHECK(tangent.w == sign);
+    }
+}
+
+TEST_CASE("generateTangents on a quad")
+{
+    std::vector<TangentVertex> vertices = makeQuad(false);
+    std::vector<uint32_t> indices = { 0, 1, 2, 0, 2, 3 };
+    std::vector<uint32_t> splitVertices;
+
+    std::vector<glm::vec4> tangents = generate(vertices, indices, splitVertices);
+
+    CHECK(tangents.size() == 4);
+    CHECK(splitVertices.empty());
+    for (const glm::vec4 &tangent : tangents)
+    {
+        // Bitangent w cross(n, t) = +Y, the V axis
+        checkTangent(tangent, glm::vec3(1.f, 0.f, 0.f), 1.f);
+    }
+}
+
+TEST_CASE("generateTangents on a quad with a mirrored texture")
+{
+    std::vector<TangentVertex> vertices = makeQuad(true);
+    std::vector<uint32_t> indices = { 0, 1, 2, 0, 2, 3 };
+    std::vector<uint32_t> splitVertices;
+
+    std::vector<glm::vec4> tangents = generate(vertices, indices, splitVertices);
+
+    CHECK(tangents.size() == 4);
+    for (const glm::vec4 &tangent : tangents)
+    {
+        // U goes along -X, V is still +Y = -cross(n, t)
+        checkTangent(tangent, glm::vec3(-1.f, 0.f, 0.f), -1.f);
+    }
+}
+
+TEST_CASE("generateTangents on a clockwise quad")
+{
+    std::vector<TangentVertex> vertices = makeQuad(false);
+    std::vector<uint32_t> indices = { 0, 2, 1, 0, 3, 2 };
+    std::vector<uint32_t> splitVertices;
+
+    std::vector<glm::vec4> tangents = generate(vertices, indices, splitVertices);
+
+    // The winding does not change the frame given by the normals
+    CHECK(tangents.size() == 4);
+    CHECK(splitVertices.empty());
+    for (const glm::vec4 &tangent : tangents)
+    {
+        checkTangent(tangent, glm::vec3(1.f, 0.f, 0.f), 1.f);
+    }
+}
+
+TEST_CASE("generateTangents splits the vertices of a mirror seam")
+{
+    // Two quads sharing the edge x = 1, the texture is mirrored on the
+    // second one: U = 2 - x
+    std::vector<TangentVertex> vertices = makeQuad(false);
+    for (glm::vec2 corner : { glm::vec2(2.f, 0.f), glm::vec2(2.f, 1.f) })
+    {
+        TangentVertex vertex{};
+        vertex.position = glm::vec3(corner.x, corner.y, 0.f);
+        vertex.normal = glm::vec3(0.f, 0.f, 1.f);
+        vertex.texCoord = glm::vec2(0.f, corner.y);
+        vertices.push_back(vertex);
+    }
+    std::vector<uint32_t> indices = { 0, 1, 2, 0, 2, 3, 1, 4, 5, 1, 5, 2 };
+    std::vector<uint32_t> splitVertices;
+
+    std::vector<glm::vec4> tangents = generate(vertices, indices, splitVertices);
+
+    CHECK(splitVertices == std::vector<uint32_t>({ 1, 2 }));
+    CHECK(tangents.size() == 8);
+    for (uint32_t v : { 0u, 1u, 2u, 3u })
+    {
+        checkTangent(tangents[v], glm::vec3(1.f, 0.f, 0.f), 1.f);
+    }
+    for (uint32_t v : { 4u, 5u, 6u, 7u })
+    {
+        checkTangent(tangents[v], glm::vec3(-1.f, 0.f, 0.f), -1.f);
+    }
+
+    // The mirrored triangles use the copies of the seam vertices
+    for (uint32_t c = 6; c < 12; c++)
+    {
+        CHECK(indices[c] != 1 && indices[c] != 2);
+    }
+}
@@ -0,0 +1,20 @@
+#include "test.hpp"
+
+#include "core/ve_text_format.hpp"
+
+TEST_CASE("textformat::quoteCSV")
+{
+    CHECK(textformat::quoteCSV("Ocean") == "\"Ocean\"");
+    CHECK(textformat::quoteCSV("") == "\"\"");
+    CHECK(textformat::quoteCSV("Sky, sun") == "\"Sky, sun\"");
+    CHECK(textformat::quoteCSV("Pass \"A\"") == "\"Pass \"\"A\"\"\"");
+}
+
+TEST_CASE("textformat::escapeJSON")
+{
+    CHECK(textformat::escapeJSON("Ocean") == "Ocean");
+    CHECK(textformat::escapeJSON("Pass \"A\"") == "Pass \\\"A\\\"");
+    CHECK(textformat::escapeJSON("a\\b") == "a\\\\b");
+    CHECK(textformat::escapeJSON("a\nb\tc") == "a\\u000ab\\u0009c");
+    CHECK(textformat::escapeJSON(std::string("\x01\x1f", 2)) == "\\u0001\\u001f");
+}
@@ -0,0 +1,96 @@
+#include "test.hpp"
+
+#include "core/ve_thread_pool.hpp"
+
+#include <atomic>
+
+// Also meant to be run in a build configured with
+// -DCMAKE_CXX_FLAGS=-fsanitize=thread to check the pool for data races.
+
+TEST_CASE("ThreadPool parallelFor visits every index once")
+{
+    ThreadPool pool(4);
+    for (uint32_t count : { 0u, 1u, 3u, 5u, 64u, 1000u })
+    {
+        for (uint32_t minRangeSize : { 1u, 7u, 256u })
+        {
+            std::vector<std::atomic<uint32_t>> visits(count);
+            for (std::atomic<uint32_t> &visit : visits) visit = 0;
+
+            pool.parallelFor(count, [&visits](uint32_t begin, uint32_t end) {
+                CHECK(begin < end);
+                for (uint32_t i = begin; i < end; i++) visits[i]++;
+            }, minRangeSize);
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                CHECK(visits[i] == 1);
+            }
+        }
+    }
+}
+
+TEST_CASE("ThreadPool parallelFor respects the minimum range size")
+{
+    ThreadPool pool(8);
+    std::atomic<uint32_t> rangeCount{ 0 };
+    pool.parallelFor(100, [&rangeCount](uint32_t begin, uint32_t end) {
+        rangeCount++;
+        CHECK(end - begin >= 25 || end == 100);
+    }, 25);
+    CHECK(rangeCount <= 4);
+}
+
+TEST_CASE("ThreadPool wait covers the tasks enqueued by tasks")
+{
+    ThreadPool pool(3);
+    std::atomic<uint32_t> doneCount{ 0 };
+    for (int i = 0; i < 16; i++)
+    {
+        pool.enqueue([&pool, &doneCount] {
+            for (int j = 0; j < 4; j++)
+            {
+                pool.enqueue([&doneCount] { doneCount++; });
+            }
+            doneCount++;
+        });
+    }
+    pool.wait();
+    CHECK(doneCount == 16 * 5);
+}
+
+TEST_CASE("ThreadPool parallelFor rethrows after every range is done")
+{
+    ThreadPool pool(4);
+    const uint32_t count = 64;
+    std::vector<std::atomic<uint32_t>> visits(count);
+    for (std::atomic<uint32_t> &visit : visits) visit = 0;
+
+    bool thrown = false;
+    try
+    {
+        pool.parallelFor(count, [&visits](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) visits[i]++;
+            if (begin == 0 || end == count)
+            {
+                throw std::runtime_error("range failed");
+            }
+        }, 8);
+    }
+    catch (const std::runtime_error &e)
+    {
+        thrown = std::string(e.what()) == "range failed";
+    }
+    CHECK(thrown);
+
+    // Every range ran to its end before the call returned
+    for (uint32_t i = 0; i < count; i++)
+    {
+        CHECK(visits[i] == 1);
+    }
+
+    // The pool is still usable
+    std::atomic<uint32_t> sum{ 0 };
+    pool.parallelFor(10, [&sum](uint32_t begin, uint32_t end) { sum += end - begin; });
+    CHECK(sum == 10);
+}